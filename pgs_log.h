@@ -1,4 +1,4 @@
-/* PGS_LOG -v0.4.4 - Public Domain - https://github.com/Steinebeisser/pgs/blob/master/pgs_log_h.h
+/* PGS_LOG -v0.29.0 - Public Domain - https://github.com/Steinebeisser/pgs/blob/master/pgs_log_h.h
 
     simple/fast logging library
 
@@ -14,19 +14,245 @@
         Set minimum log level:
             pgs_log_minimal_log_level
 
+        Per module log levels (v0.8.0+, see `PGS_LOG_MODULES` below):
+            pgs_log_set_module_level("net", PGS_LOG_DEBUG)     // also applies to net.tls etc.
+            pgs_log_reset_module_level("net")                  // back to inheriting
+
+        Rate limited / sampled logging (v0.9.0+):
+            PGS_LOG_WARN_RATELIMITED(n_per_sec, fmt, ...)
+            PGS_LOG_WARN_SAMPLED(one_in_n, fmt, ...)
+            (same for every level)
+            expressions like PGS_LOG_WARN(), a suppressed call returns PGS_LOG_OK without evaluating its arguments
+            every callsite keeps its own static state, compilers without GNU statement expressions look it up in a
+            table of `PGS_LOG_MAX_RATELIMIT_SITES`, callsites past a full table share one state (warned about once)
+            the "suppressed N messages from file:line" summary is written once the window of the callsite is over,
+            with its next entry, from pgs_log_flush_if_due() (checked once a second) or on pgs_log_flush()
+            it is logged at the level and module of its callsite,
+            so it is dropped together with its messages when that level is filtered (backlog/flight recorder still
+            get it)
+
+        io_uring writes (v0.10.0+, needs `PGS_LOG_ENABLE_IO_URING`, linux only):
+            full buffers of file outputs are submitted as io_uring writes and the logger continues in the next of
+            `PGS_LOG_OUTPUT_BUFFERS`, falls back to write() if io_uring is not available
+            pgs_log_io_uring_active()
+
+        Background flush thread (v0.12.0+, needs `PGS_LOG_ENABLE_FLUSH_THREAD`, not on windows):
+            full buffers are handed to a flusher thread and the logger continues in the next of
+            `PGS_LOG_OUTPUT_BUFFERS`, only stalls if all of them are still being written
+            falls back to write() on the caller if the thread can not be started
+            once it runs, SIGINT wakes a helper thread that cleans up and exits with 130 right away, without it the
+            handler does that itself
+            pgs_log_flush_thread_active()
+
+        Event loop mode (v0.26.0+, needs `PGS_LOG_ENABLE_EVENT_LOOP`, linux only):
+            log calls never write fd outputs, full buffers are queued and the eventfd gets signalled, so do entries
+            >= pgs_log_flush_level and pgs_log_flush_if_due() once something is due, terminal entries get queued
+            right away, FATAL entries are still flushed by the log call
+            fd outputs are switched to `O_NONBLOCK`, remove/cleanup restore their flags
+            the application polls the eventfd in its own loop and calls pgs_log_service(budget) when it is readable,
+            that writes at most `budget` bytes (0 = no limit) and leaves the eventfd readable if work is left
+            a log call only writes itself if all `PGS_LOG_OUTPUT_BUFFERS` of an output are still queued
+            pgs_log_flush(), pgs_log_sync() and pgs_log_cleanup() still write everything right away
+            int fd = pgs_log_event_fd()                         // EPOLLIN once the loop should call service
+            pgs_log_service(64 * 1024)
+            pgs_log_service_pending()                           // queued buffers or a flush is due
+
+        mmap file outputs (v0.11.0+, needs `PGS_LOG_ENABLE_MMAP_OUTPUT`, not on windows):
+            entries are stored straight into a mapped window of the file, no write() per flush
+            the file grows in `PGS_LOG_MMAP_GROW_SIZE` steps (at least two windows) and is only cut to its real
+            length when the output is removed/cleaned up, until then readers see a zero filled tail
+            appending after a crash drops that tail and continues at the last entry
+            pgs_log_add_mmap_output("path.log", append)
+            `PGS_LOG_FILE_MMAP` uses it for the default log file
+
+        O_DIRECT file outputs (v0.13.0+, needs `PGS_LOG_ENABLE_DIRECT_OUTPUT`, linux only):
+            entries bypass the page cache, written in aligned `PGS_LOG_DIRECT_BUFFER_SIZE` blocks
+            the last partial block is written zero padded on flush and rewritten as it fills up, the file is only cut
+            to its real length on remove/cleanup (readers see trailing NULs until then, appending drops them)
+            falls back to posix_fadvise(DONTNEED) after each write if the filesystem rejects O_DIRECT, without
+            `_GNU_SOURCE` the flag is only known on x86 and arm linux, elsewhere the fallback is always used
+            pgs_log_add_direct_output("path.log", append)
+            pgs_log_direct_output_is_direct("path.log")
+            `PGS_LOG_FILE_DIRECT` uses it for the default log file
+
+        Flush policy (v0.14.0+):
+            entries >= pgs_log_flush_level (`PGS_LOG_FLUSH_LEVEL`, FATAL by default) flush all outputs right away,
+            with `PGS_LOG_FLUSH_SYNC` they are also fdatasync'ed
+            `PGS_LOG_MAX_BUFFER_AGE_MS` flushes once the oldest buffered entry is that old, checked on every log call,
+            call pgs_log_flush_if_due() from a timer if the process can go quiet
+            pgs_log_sync()                                      // flush + fdatasync all outputs
+
+        Durability (v0.15.0+):
+            every entry written to the outputs gets a sequence number, a flush hands everything up to the latest one
+            to the kernel and pgs_log_durability (`PGS_LOG_DURABILITY`) decides when it gets fdatasync'ed:
+                PGS_LOG_DURABILITY_NONE             only on pgs_log_sync()
+                PGS_LOG_DURABILITY_PERIODIC         on flush/log calls once `PGS_LOG_DURABILITY_INTERVAL_MS` passed
+                PGS_LOG_DURABILITY_GROUP_COMMIT     on every flush, callers syncing at the same time share one fdatasync
+            pgs_log_last_sequence()                             // sequence of the last entry logged by this thread
+            pgs_log_durable_sequence()                          // every entry up to this one survives a crash
+            pgs_log_wait_durable(seq)                           // thread safe, joins/starts the shared fdatasync
+                                                                // for entries a flush already handed to the kernel
+
+        Reopen the log file, e.g. after logrotate renamed it (v0.18.0+, stdio log file only):
+            pgs_log_reopen()                                    // buffered entries still go to the old file
+            pgs_log_install_reopen_signal(SIGHUP)               // handler only sets a flag, the next log call
+                                                                // or flush reopens
+
+        Date rollover (v0.17.0+, `PGS_LOG_DATE_ROLLOVER`, on by default):
+            `PGS_LOG_PATH` is formatted again whenever the cached timestamp moves to the next second, once the name
+            changes the next log call continues in the new file (append/override/numbered like at startup)
+            stdio log file only, off for `PGS_LOG_FILE_MMAP`/`PGS_LOG_FILE_DIRECT`/`PGS_LOG_FILE_SEGMENTS`
+
+        Log rotation (v0.16.0+):
+            `PGS_LOG_ROTATE_SIZE` bytes and/or `PGS_LOG_ROTATE_INTERVAL_S` seconds per file, continues in the next free
+            `name(N).ext` of the current `PGS_LOG_PATH`, `PGS_LOG_ROTATE_KEEP` files are kept (0 keeps all)
+            N wraps around at `PGS_LOG_MAX_FILENAME_NUMBER`, once every number is taken the oldest file is reused
+            the size counts what the log file gets, entries below its pgs_log_set_output_level() do not count and
+            pgs_log_set_output_format() counts at the length of its format
+            if the next file can not be opened the current one keeps growing, log/flush calls still write everything
+            and report the error
+            the next file is opened ahead of time (the first one with the log file), the entry crossing the limit
+            only hands the current buffer off to the old file like a full one and swaps the output's fd, queued
+            buffers keep theirs, closing the old file once nothing is queued for it, opening the next standby and
+            deleting old files happens in pgs_log_flush()
+
+        Circular segment files (v0.19.0+, needs `PGS_LOG_ENABLE_SEGMENTS`, not on windows):
+            `PGS_LOG_SEGMENT_COUNT` files `path.0`.. of `PGS_LOG_SEGMENT_SIZE` bytes are preallocated once and reused
+            oldest first, disk usage stays constant and no file gets created/unlinked/grown while running
+            every segment starts with a 64 byte text header `PGSSEG v1 gen <n> len <bytes>`, highest gen is the newest
+            a segment gets fdatasync'ed once when it is finished, durability waits only sync the current one
+            pgs_log_add_segment_output("path.log")
+            pgs_log_segments_dump("path.log", "out.log")        // valid bytes of all segments, oldest first
+            `PGS_LOG_FILE_SEGMENTS` uses it for the default log file
+
+        Syslog/journald output (v0.21.0+, needs `PGS_LOG_ENABLE_SYSLOG_OUTPUT`, not on windows):
+            every entry becomes one datagram on a unix socket, framed from the unformatted message as RFC 5424 or
+            journald native fields, levels map to syslog severities, facility `PGS_LOG_SYSLOG_FACILITY`
+            datagrams are collected and sent with one sendmmsg() per `PGS_LOG_SYSLOG_BATCH` on flush (send() per
+            datagram off linux or with `PGS_LOG_SYSLOG_SENDMMSG false`), a failed send reconnects once, whatever still fails is counted as dropped, so is
+            the entry that wanted the room of a failed batch
+            pgs_log_add_syslog_output(PGS_LOG_SYSLOG_DEV_LOG, PGS_LOG_SYSLOG_RFC5424, "app")
+            pgs_log_add_syslog_output(PGS_LOG_JOURNALD_SOCKET, PGS_LOG_SYSLOG_JOURNALD, "app")
+
+        Sinks (v0.20.0+):
+            every output writes through a `Pgs_Log_Sink` (write/flush/close, flush and close may be NULL), write gets
+            whole buffered batches
+            pgs_log_add_fd_output(FILE *)                       // written with write() on its fd, closed on remove
+            pgs_log_add_raw_fd_output(fd, owned)                // closed on remove only if `owned`
+            pgs_log_add_callback_output(write, ctx)             // just a write callback
+            pgs_log_add_memory_output(&memory_sink)             // see pgs_log_memory_sink_init()
+            pgs_log_add_sink_output(sink, ctx)                  // own transport
+            io_uring/the flush thread only apply to fd and FILE outputs, other sinks get called by the logging thread
+            `unbuffered` sinks get every entry right away and buffer themselves (mmap, direct, segment, pipe and
+            syslog outputs are such sinks and take one of the `PGS_LOG_MAX_FD` output slots each)
+            group commit waits fdatasync the fd `sync_fd` returns, fd and FILE outputs use their own fd
+
+        Compressed file outputs (v0.27.0+, needs `PGS_LOG_ENABLE_COMPRESSION`, not on windows):
+            pgs_log_add_compressed_output("path.log.pgz", append)
+            every buffer written to it becomes one independent frame, so the file is readable up to the last flush
+            frame: "PGZF", codec (0 stored, 1 built-in LZ, 2 zlib), 3 zero bytes, raw length, compressed length
+            (both 32 bit little endian), then the compressed bytes
+            `path.idx` gets a 16 byte entry per frame (file offset, uncompressed offset, 64 bit little endian) to seek
+            with `PGS_LOG_COMPRESS_ZLIB` frames use zlib (link with -lz), otherwise a small built-in LZ4 style codec
+            appending scans the existing frames and cuts a torn last frame
+            pgs_log_compressed_dump("path.log.pgz", from, "out.log")    // text from uncompressed offset `from` on
+
+        Zero copy pipe output (v0.23.0+, needs `PGS_LOG_ENABLE_VMSPLICE`, linux only):
+            pgs_log_add_pipe_output(fd, owned)                  // fails if fstat() does not say pipe
+            entries go into page aligned `PGS_LOG_VMSPLICE_BUFFER_SIZE` buffers that are handed to the pipe with
+            vmsplice(SPLICE_F_GIFT) once full, the gifted pages are replaced by fresh ones so they are never written
+            again, flushes below `PGS_LOG_VMSPLICE_MIN_GIFT` bytes are copied with write() instead
+            with `PGS_LOG_STDOUT_VMSPLICE` (default with `PGS_LOG_ENABLE_VMSPLICE`) stdout uses it if it is a pipe
+
+        Non-blocking outputs (v0.22.0+, needs `PGS_LOG_ENABLE_NONBLOCKING`, not on windows):
+            pgs_log_set_output_nonblocking(STDOUT_FILENO, PGS_LOG_OVERFLOW_DROP_NEWEST)  // fd of a FILE or raw fd output
+            the output writes through its own `O_NONBLOCK` description (linux reopens ttys and pipes through
+            /proc/self/fd, so the shell sharing stdout is not affected), other fds (sockets, other systems) get
+            `O_NONBLOCK` on the shared description until it is restored, a killed process cannot restore it
+            on EAGAIN the unwritten tail is kept (up to `PGS_LOG_NONBLOCK_PENDING_SIZE`, allocated only for
+            non-blocking outputs) and retried by the next write/flush or pgs_log_poll_outputs(timeout_ms), once full
+            whole entries get dropped (newest or oldest) or PGS_LOG_OVERFLOW_BLOCK waits, pgs_log_get_output_stats()
+            has the counters
+            pgs_log_set_output_blocking(fd) restores the fd flags, remove/cleanup do too
+
+        Per output level and format (v0.25.0+, needs `PGS_LOG_ENABLE_OUTPUT_FORMATS`):
+            pgs_log_set_output_level(fileno(stderr), PGS_LOG_WARN)            // entries below are skipped for it
+            pgs_log_set_output_format(fileno(stderr), "%C%L%R %M")           // NULL goes back to PGS_LOG_FORMAT
+            the module/minimal level still decides if an entry is logged at all, outputs can only narrow it down
+            every distinct format is rendered at most once per entry and only if an output using it takes the
+            level, up to `PGS_LOG_MAX_OUTPUT_FORMATS` formats besides `PGS_LOG_FORMAT`
+            mmap/direct/segment/pipe/syslog outputs and the flight recorder always get `PGS_LOG_FORMAT`
+
+        Runtime sized output buffers (v0.28.0+, `PGS_LOG_ENABLE_DYNAMIC_BUFFERS`, on by default):
+            the outputs and their buffers are no static arrays anymore, the outputs get allocated with the first one
+            and each buffer on the first entry it takes, remove/cleanup give the memory back
+            a program that never logs holds no buffers, an output that only ever needs one holds one
+            `#define PGS_LOG_ENABLE_DYNAMIC_BUFFERS false` goes back to static arrays for builds that must not allocate
+            pgs_log_set_allocator(&(Pgs_Log_Allocator){ my_alloc, my_free, ctx })  // NULL goes back to malloc/free
+            pgs_log_use_arena(memory, size)                  // bump allocator on caller memory, reset by cleanup
+            pgs_log_set_max_outputs(2)                       // up to `PGS_LOG_MAX_FD`
+            pgs_log_set_buffer_size(4096)                    // for outputs added afterwards, `PGS_LOG_MAX_OUTPUT_BUFFER_SIZE` by default
+            pgs_log_set_output_buffer_size(fd, 4 << 20)      // writes out what it has and switches on the next entry
+            allocator, arena and output count can only change before the first output (the log file is added on the
+            first log call) or after pgs_log_cleanup(), if a buffer can not be allocated entries go out unbuffered
+            pgs_log_allocated_bytes()                        // what the library holds right now
+
+        Large entries (v0.29.0+):
+            entries are formatted into `PGS_LOG_MAX_ENTRY_LEN` on the stack, a longer message gets cut there and
+            pgs_log_truncated_count() counts those entries
+            with `PGS_LOG_ENABLE_LARGE_ENTRIES` such an entry is formatted again at full length on the heap, PGS_LOG_FORMAT
+            split around %M, and one larger than an output buffer goes out in a single write after what is buffered
+            the full entry comes from the pgs_log_set_allocator() hooks (malloc without dynamic buffers), if that
+            fails the entry is cut as without the flag
+            outputs with their own format, syslog and the flight recorder still get the cut entry, segment and pipe
+            outputs reject entries larger than a segment/`PGS_LOG_VMSPLICE_BUFFER_SIZE`
+
+        Adaptive terminal writes (v0.24.0+, needs `PGS_LOG_TERMINAL_COALESCE_US` > 0 and buffering):
+            instead of one write() per entry stdout/stderr entries are buffered for up to `PGS_LOG_TERMINAL_COALESCE_US`
+            or `PGS_LOG_TERMINAL_COALESCE_ENTRIES` entries, the first entry after a quiet period (no entry for a whole
+            budget) and entries >= `PGS_LOG_TERMINAL_IMMEDIATE_LEVEL` (ERROR by default) are written right away
+            checked on every log call, a timer thread writes terminals whose oldest entry used up the budget when no
+            log call comes (in event loop mode it signals the eventfd instead and pgs_log_service() writes them),
+            on windows only pgs_log_flush_if_due() does
+            pgs_log_flush_terminals()                           // write what the terminals have buffered now
+
         Toggle logging on/off at runtime:
             pgs_log_toggle(bool enabled)
 
         Check last error (v0.2.0+):
-            Pgs_Log_Error_Detail err = pgs_log_get_last_error();
+            Pgs_Log_Error_Detail err = pgs_log_get_last_error();                // per thread since v0.15.0
             pgs_log_print_error_detail();
 
+        Deferred debug backlog (v0.5.0+, needs `PGS_LOG_ENABLE_BACKLOG`):
+            entries below pgs_log_minimal_log_level are kept unformatted in a per thread ring
+            of `PGS_LOG_BACKLOG_ENTRIES` and only rendered once an entry >= `PGS_LOG_BACKLOG_TRIGGER_LEVEL` is logged
+            pgs_log_backlog_flush()
+            pgs_log_backlog_clear()
+
+        Flight recorder (v0.6.0+, needs `PGS_LOG_ENABLE_FLIGHT_RECORDER`):
+            in memory ring of `PGS_LOG_FLIGHT_RECORDER_SIZE` bytes, never does any io until dumped
+            gets every entry >= pgs_log_flight_recorder_level, even if below pgs_log_minimal_log_level
+            pgs_log_flight_recorder_init(NULL | "path/to/mmap/file")     // an existing recorder file keeps its ring,
+                                                                            // other files get moved to `path.prev`
+            pgs_log_flight_recorder_dump("out.log")
+            pgs_log_flight_recorder_read("path/to/mmap/file", "out.log")    // recover after a crash
+            pgs_log_flight_recorder_install_signal(SIGUSR2)                 // dumps to `PGS_LOG_FLIGHT_RECORDER_DUMP_PATH`
+            pgs_log_flight_recorder_install_crash_handler()
+
+        USDT probes (v0.7.0+, needs `PGS_LOG_ENABLE_USDT`, linux x86_64 only, otherwise compiled out):
+            pgs_log:callsite(int level, char *file, int line, char *fmt)   at every macro callsite, costs a nop
+            pgs_log:message(int level, char *file, int line, char *msg)    formatted message, also for entries below
+                                                                            pgs_log_minimal_log_level while a tracer is attached
+            e.g. bpftrace -e 'usdt:./app:pgs_log:message { printf("%s\\n", str(arg3)); }'
+
     Placeholder formatting (for custom PGS_LOG_FORMAT):
         %L = LOG LEVEL
         %T = TIMESTAMP
         %F = FILE
         %l = LINE
         %M = MESSAGE
+        %C = ANSI colour of the LOG LEVEL
+        %R = ANSI colour reset
 */
 
 #ifndef PGS_LOG_H
@@ -42,6 +268,8 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include <signal.h>
+#include <stdint.h>
+#include <stddef.h>
 
 #ifdef _WIN32
 #   include <direct.h>
@@ -49,9 +277,7 @@
 
 
 /*
- * TODO:    - log colors
- *          - rotating log files (time & size)
- *          - thread safety
+ * TODO:    - thread safety
  *          - stuff like NOB_DEPRECATED warning
  *          - embedded mode also specialized for different micro controllers (less sizes, and less includes, no printf, no file etc)
 */
@@ -65,6 +291,9 @@
 #ifndef PGS_LOG_MAX_ENTRY_LEN
 #   define PGS_LOG_MAX_ENTRY_LEN 2048
 #endif
+#ifndef PGS_LOG_ENABLE_LARGE_ENTRIES
+#   define PGS_LOG_ENABLE_LARGE_ENTRIES false           // entries past `PGS_LOG_MAX_ENTRY_LEN` go out whole instead of cut
+#endif
 #ifndef PGS_LOG_MAX_PATH_LEN
 #   define PGS_LOG_MAX_PATH_LEN 512
 #endif
@@ -77,6 +306,9 @@
 #ifndef PGS_LOG_MAX_TEMP_BUFFER_LEN
 #   define PGS_LOG_MAX_TEMP_BUFFER_LEN 1024
 #endif
+#ifndef PGS_LOG_MAX_RATELIMIT_SITES
+#   define PGS_LOG_MAX_RATELIMIT_SITES 256
+#endif
 #ifndef PGS_LOG_PATH
 #   define PGS_LOG_PATH "logs/%d-%m-%Y.log"
 #endif
@@ -107,8 +339,21 @@
 #ifndef PGS_LOG_MAX_FILENAME_NUMBER
 #   define PGS_LOG_MAX_FILENAME_NUMBER 99
 #endif
+#ifndef PGS_LOG_ROTATE_SIZE
+#   define PGS_LOG_ROTATE_SIZE 0
+#endif
+#ifndef PGS_LOG_ROTATE_INTERVAL_S
+#   define PGS_LOG_ROTATE_INTERVAL_S 0
+#endif
+#ifndef PGS_LOG_ROTATE_KEEP
+#   define PGS_LOG_ROTATE_KEEP 0
+#endif
+#define PGS_LOG_ENABLE_ROTATION (PGS_LOG_ROTATE_SIZE > 0 || PGS_LOG_ROTATE_INTERVAL_S > 0)
 #ifndef PGS_LOG_MAX_OUTPUT_BUFFER_SIZE
-#   define PGS_LOG_MAX_OUTPUT_BUFFER_SIZE 65536
+#   define PGS_LOG_MAX_OUTPUT_BUFFER_SIZE 65536         // with dynamic buffers only the default for new outputs
+#endif
+#ifndef PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+#   define PGS_LOG_ENABLE_DYNAMIC_BUFFERS true
 #endif
 #ifndef PGS_LOG_ENABLE_BUFFERING
 #   define PGS_LOG_ENABLE_BUFFERING true
@@ -116,9 +361,284 @@
 #ifndef PGS_LOG_BUFFER_INSTA_WRITE_IF_TOO_LARGE
 #   define PGS_LOG_BUFFER_INSTA_WRITE_IF_TOO_LARGE false
 #endif
+#ifndef PGS_LOG_FLUSH_LEVEL
+#   define PGS_LOG_FLUSH_LEVEL PGS_LOG_FATAL
+#endif
+#ifndef PGS_LOG_FLUSH_SYNC
+#   define PGS_LOG_FLUSH_SYNC false
+#endif
+#ifndef PGS_LOG_MAX_BUFFER_AGE_MS
+#   define PGS_LOG_MAX_BUFFER_AGE_MS 0
+#endif
+#ifndef PGS_LOG_DURABILITY
+#   define PGS_LOG_DURABILITY PGS_LOG_DURABILITY_NONE
+#endif
+#ifndef PGS_LOG_DURABILITY_INTERVAL_MS
+#   define PGS_LOG_DURABILITY_INTERVAL_MS 1000
+#endif
 #ifndef PGS_LOG_BUFFER_INSTA_WRITE_TERMINAL
 #   define PGS_LOG_BUFFER_INSTA_WRITE_TERMINAL true
 #endif
+#ifndef PGS_LOG_TERMINAL_COALESCE_US
+#   define PGS_LOG_TERMINAL_COALESCE_US 0               // > 0 coalesces terminal writes for up to that long
+#endif
+#ifndef PGS_LOG_TERMINAL_COALESCE_ENTRIES
+#   define PGS_LOG_TERMINAL_COALESCE_ENTRIES 64
+#endif
+#ifndef PGS_LOG_TERMINAL_IMMEDIATE_LEVEL
+#   define PGS_LOG_TERMINAL_IMMEDIATE_LEVEL PGS_LOG_ERROR
+#endif
+#define PGS_LOG_TERMINAL_COALESCE (PGS_LOG_ENABLE_BUFFERING && PGS_LOG_BUFFER_INSTA_WRITE_TERMINAL && PGS_LOG_TERMINAL_COALESCE_US > 0)
+#if PGS_LOG_TERMINAL_COALESCE && !defined(_WIN32)
+#   define PGS_LOG_TERMINAL_TIMER true                  // a thread enforces the budget when no log call comes
+#else
+#   define PGS_LOG_TERMINAL_TIMER false
+#endif
+#ifndef PGS_LOG_ENABLE_BACKLOG
+#   define PGS_LOG_ENABLE_BACKLOG false
+#endif
+#ifndef PGS_LOG_BACKLOG_ENTRIES
+#   define PGS_LOG_BACKLOG_ENTRIES 64
+#endif
+#ifndef PGS_LOG_BACKLOG_ARG_BYTES
+#   define PGS_LOG_BACKLOG_ARG_BYTES 256
+#endif
+#ifndef PGS_LOG_BACKLOG_TRIGGER_LEVEL
+#   define PGS_LOG_BACKLOG_TRIGGER_LEVEL PGS_LOG_ERROR
+#endif
+#ifndef PGS_LOG_ENABLE_FLIGHT_RECORDER
+#   define PGS_LOG_ENABLE_FLIGHT_RECORDER false
+#endif
+#ifndef PGS_LOG_FLIGHT_RECORDER_SIZE
+#   define PGS_LOG_FLIGHT_RECORDER_SIZE (1024 * 1024)
+#endif
+#ifndef PGS_LOG_FLIGHT_RECORDER_DUMP_PATH
+#   define PGS_LOG_FLIGHT_RECORDER_DUMP_PATH "logs/flight_recorder.log"
+#endif
+#ifndef PGS_LOG_ENABLE_USDT
+#   define PGS_LOG_ENABLE_USDT false
+#endif
+#ifndef PGS_LOG_ENABLE_IO_URING
+#   define PGS_LOG_ENABLE_IO_URING false
+#endif
+#if PGS_LOG_ENABLE_IO_URING && (!defined(__linux__) || !PGS_LOG_ENABLE_BUFFERING)
+#   undef PGS_LOG_ENABLE_IO_URING
+#   define PGS_LOG_ENABLE_IO_URING false
+#endif
+#ifndef PGS_LOG_IO_URING_ENTRIES
+#   define PGS_LOG_IO_URING_ENTRIES 16
+#endif
+#ifndef PGS_LOG_ENABLE_FLUSH_THREAD
+#   define PGS_LOG_ENABLE_FLUSH_THREAD false
+#endif
+#if PGS_LOG_ENABLE_FLUSH_THREAD && (defined(_WIN32) || !PGS_LOG_ENABLE_BUFFERING)
+#   undef PGS_LOG_ENABLE_FLUSH_THREAD
+#   define PGS_LOG_ENABLE_FLUSH_THREAD false
+#endif
+#if PGS_LOG_ENABLE_FLUSH_THREAD && PGS_LOG_ENABLE_IO_URING
+#   error "PGS_LOG_ENABLE_FLUSH_THREAD and PGS_LOG_ENABLE_IO_URING both write full buffers in the background, pick one"
+#endif
+#ifndef PGS_LOG_ENABLE_EVENT_LOOP
+#   define PGS_LOG_ENABLE_EVENT_LOOP false
+#endif
+#if PGS_LOG_ENABLE_EVENT_LOOP && (!defined(__linux__) || !PGS_LOG_ENABLE_BUFFERING)
+#   undef PGS_LOG_ENABLE_EVENT_LOOP
+#   define PGS_LOG_ENABLE_EVENT_LOOP false
+#endif
+#if PGS_LOG_ENABLE_EVENT_LOOP && (PGS_LOG_ENABLE_FLUSH_THREAD || PGS_LOG_ENABLE_IO_URING)
+#   error "PGS_LOG_ENABLE_EVENT_LOOP writes full buffers from the application's loop, it does not mix with PGS_LOG_ENABLE_FLUSH_THREAD or PGS_LOG_ENABLE_IO_URING"
+#endif
+#ifndef PGS_LOG_ENABLE_MMAP_OUTPUT
+#   define PGS_LOG_ENABLE_MMAP_OUTPUT false
+#endif
+#if PGS_LOG_ENABLE_MMAP_OUTPUT && defined(_WIN32)
+#   undef PGS_LOG_ENABLE_MMAP_OUTPUT
+#   define PGS_LOG_ENABLE_MMAP_OUTPUT false
+#endif
+#ifndef PGS_LOG_FILE_MMAP
+#   define PGS_LOG_FILE_MMAP false
+#endif
+#if PGS_LOG_FILE_MMAP && !PGS_LOG_ENABLE_MMAP_OUTPUT
+#   error "PGS_LOG_FILE_MMAP needs PGS_LOG_ENABLE_MMAP_OUTPUT (not available on windows)"
+#endif
+#ifndef PGS_LOG_ENABLE_DIRECT_OUTPUT
+#   define PGS_LOG_ENABLE_DIRECT_OUTPUT false
+#endif
+#if PGS_LOG_ENABLE_DIRECT_OUTPUT && !defined(__linux__)
+#   undef PGS_LOG_ENABLE_DIRECT_OUTPUT
+#   define PGS_LOG_ENABLE_DIRECT_OUTPUT false
+#endif
+#ifndef PGS_LOG_FILE_DIRECT
+#   define PGS_LOG_FILE_DIRECT false
+#endif
+#if PGS_LOG_FILE_DIRECT && !PGS_LOG_ENABLE_DIRECT_OUTPUT
+#   error "PGS_LOG_FILE_DIRECT needs PGS_LOG_ENABLE_DIRECT_OUTPUT (linux only)"
+#endif
+#ifndef PGS_LOG_ENABLE_SEGMENTS
+#   define PGS_LOG_ENABLE_SEGMENTS false
+#endif
+#if PGS_LOG_ENABLE_SEGMENTS && defined(_WIN32)
+#   undef PGS_LOG_ENABLE_SEGMENTS
+#   define PGS_LOG_ENABLE_SEGMENTS false
+#endif
+#ifndef PGS_LOG_FILE_SEGMENTS
+#   define PGS_LOG_FILE_SEGMENTS false
+#endif
+#if PGS_LOG_FILE_SEGMENTS && !PGS_LOG_ENABLE_SEGMENTS
+#   error "PGS_LOG_FILE_SEGMENTS needs PGS_LOG_ENABLE_SEGMENTS (not available on windows)"
+#endif
+#ifndef PGS_LOG_SEGMENT_COUNT
+#   define PGS_LOG_SEGMENT_COUNT 8
+#endif
+#ifndef PGS_LOG_SEGMENT_SIZE
+#   define PGS_LOG_SEGMENT_SIZE (4 * 1024 * 1024)
+#endif
+#ifndef PGS_LOG_SEGMENT_BUFFER_SIZE
+#   define PGS_LOG_SEGMENT_BUFFER_SIZE 65536
+#endif
+#ifndef PGS_LOG_MAX_SEGMENT_OUTPUTS
+#   define PGS_LOG_MAX_SEGMENT_OUTPUTS 2
+#endif
+#define PGS_LOG_SEGMENT_HEADER_SIZE 64
+#ifndef PGS_LOG_ENABLE_SYSLOG_OUTPUT
+#   define PGS_LOG_ENABLE_SYSLOG_OUTPUT false
+#endif
+#if PGS_LOG_ENABLE_SYSLOG_OUTPUT && defined(_WIN32)
+#   undef PGS_LOG_ENABLE_SYSLOG_OUTPUT
+#   define PGS_LOG_ENABLE_SYSLOG_OUTPUT false
+#endif
+#ifndef PGS_LOG_SYSLOG_BATCH
+#   define PGS_LOG_SYSLOG_BATCH 64                           // datagrams per sendmmsg
+#endif
+#ifndef PGS_LOG_SYSLOG_SENDMMSG
+#   define PGS_LOG_SYSLOG_SENDMMSG true                      // false sends every datagram on its own
+#endif
+#ifndef PGS_LOG_SYSLOG_BUFFER_SIZE
+#   define PGS_LOG_SYSLOG_BUFFER_SIZE 65536
+#endif
+#ifndef PGS_LOG_SYSLOG_FACILITY
+#   define PGS_LOG_SYSLOG_FACILITY 1                         // user
+#endif
+#ifndef PGS_LOG_MAX_SYSLOG_OUTPUTS
+#   define PGS_LOG_MAX_SYSLOG_OUTPUTS 2
+#endif
+#define PGS_LOG_SYSLOG_DEV_LOG "/dev/log"
+#define PGS_LOG_JOURNALD_SOCKET "/run/systemd/journal/socket"
+#ifndef PGS_LOG_ENABLE_NONBLOCKING
+#   define PGS_LOG_ENABLE_NONBLOCKING false
+#endif
+#if PGS_LOG_ENABLE_NONBLOCKING && defined(_WIN32)
+#   undef PGS_LOG_ENABLE_NONBLOCKING
+#   define PGS_LOG_ENABLE_NONBLOCKING false
+#endif
+#ifndef PGS_LOG_NONBLOCK_PENDING_SIZE
+#   define PGS_LOG_NONBLOCK_PENDING_SIZE (256 * 1024)       // per output, unwritten tail kept on EAGAIN
+#endif
+#if PGS_LOG_ENABLE_NONBLOCKING && PGS_LOG_NONBLOCK_PENDING_SIZE < 2 * PGS_LOG_MAX_ENTRY_LEN
+#   error "PGS_LOG_NONBLOCK_PENDING_SIZE needs room for at least two entries"
+#endif
+#ifndef PGS_LOG_ENABLE_VMSPLICE
+#   define PGS_LOG_ENABLE_VMSPLICE false
+#endif
+#if PGS_LOG_ENABLE_VMSPLICE && !defined(__linux__)
+#   undef PGS_LOG_ENABLE_VMSPLICE
+#   define PGS_LOG_ENABLE_VMSPLICE false
+#endif
+#ifndef PGS_LOG_VMSPLICE_BUFFER_SIZE
+#   define PGS_LOG_VMSPLICE_BUFFER_SIZE (1024 * 1024)       // whole pages, gifted to the pipe once full
+#endif
+#if PGS_LOG_ENABLE_VMSPLICE && PGS_LOG_VMSPLICE_BUFFER_SIZE % 4096 != 0
+#   error "PGS_LOG_VMSPLICE_BUFFER_SIZE has to be a multiple of the page size"
+#endif
+#ifndef PGS_LOG_VMSPLICE_MIN_GIFT
+#   define PGS_LOG_VMSPLICE_MIN_GIFT (64 * 1024)            // smaller flushes are copied with write()
+#endif
+#ifndef PGS_LOG_MAX_PIPE_OUTPUTS
+#   define PGS_LOG_MAX_PIPE_OUTPUTS 2
+#endif
+#ifndef PGS_LOG_STDOUT_VMSPLICE
+#   define PGS_LOG_STDOUT_VMSPLICE PGS_LOG_ENABLE_VMSPLICE
+#endif
+#ifndef PGS_LOG_ENABLE_COMPRESSION
+#   define PGS_LOG_ENABLE_COMPRESSION false
+#endif
+#if PGS_LOG_ENABLE_COMPRESSION && defined(_WIN32)
+#   undef PGS_LOG_ENABLE_COMPRESSION
+#   define PGS_LOG_ENABLE_COMPRESSION false
+#endif
+#ifndef PGS_LOG_COMPRESS_ZLIB
+#   define PGS_LOG_COMPRESS_ZLIB false                  // needs zlib.h and -lz, otherwise the built-in LZ codec is used
+#endif
+#ifndef PGS_LOG_COMPRESS_FRAME_SIZE
+#   define PGS_LOG_COMPRESS_FRAME_SIZE (64 * 1024)      // larger writes are split into frames of this size
+#endif
+#ifndef PGS_LOG_MAX_COMPRESSED_OUTPUTS
+#   define PGS_LOG_MAX_COMPRESSED_OUTPUTS 2
+#endif
+#ifndef PGS_LOG_ENABLE_OUTPUT_FORMATS
+#   define PGS_LOG_ENABLE_OUTPUT_FORMATS false
+#endif
+#ifndef PGS_LOG_MAX_OUTPUT_FORMATS
+#   define PGS_LOG_MAX_OUTPUT_FORMATS 4                 // distinct formats besides `PGS_LOG_FORMAT`
+#endif
+#ifndef PGS_LOG_MAX_FORMAT_LEN
+#   define PGS_LOG_MAX_FORMAT_LEN 128
+#endif
+#ifndef PGS_LOG_NONBLOCK_CLOSE_TIMEOUT_MS
+#   define PGS_LOG_NONBLOCK_CLOSE_TIMEOUT_MS 100            // how long remove/cleanup wait for a pending tail
+#endif
+#if PGS_LOG_FILE_MMAP + PGS_LOG_FILE_DIRECT + PGS_LOG_FILE_SEGMENTS > 1
+#   error "PGS_LOG_FILE_MMAP, PGS_LOG_FILE_DIRECT and PGS_LOG_FILE_SEGMENTS all replace the default log file output, pick one"
+#endif
+#define PGS_LOG_FILE_STDIO (!PGS_LOG_FILE_MMAP && !PGS_LOG_FILE_DIRECT && !PGS_LOG_FILE_SEGMENTS)
+#if PGS_LOG_ENABLE_ROTATION && !PGS_LOG_FILE_STDIO
+#   error "PGS_LOG_ROTATE_SIZE/PGS_LOG_ROTATE_INTERVAL_S only rotate the stdio log file"
+#endif
+#ifndef PGS_LOG_DATE_ROLLOVER
+#   define PGS_LOG_DATE_ROLLOVER true
+#endif
+#if PGS_LOG_DATE_ROLLOVER && (!PGS_LOG_ENABLE_FILE || !PGS_LOG_FILE_STDIO)
+#   undef PGS_LOG_DATE_ROLLOVER
+#   define PGS_LOG_DATE_ROLLOVER false
+#endif
+#define PGS_LOG_SWITCHES_LOG_FILE (PGS_LOG_ENABLE_FILE && PGS_LOG_FILE_STDIO)
+#ifndef PGS_LOG_DIRECT_ALIGNMENT
+#   define PGS_LOG_DIRECT_ALIGNMENT 4096
+#endif
+#ifndef PGS_LOG_DIRECT_BUFFER_SIZE
+#   define PGS_LOG_DIRECT_BUFFER_SIZE (256 * 1024)
+#endif
+#if PGS_LOG_DIRECT_BUFFER_SIZE % PGS_LOG_DIRECT_ALIGNMENT != 0
+#   error "PGS_LOG_DIRECT_BUFFER_SIZE has to be a multiple of PGS_LOG_DIRECT_ALIGNMENT"
+#endif
+#ifndef PGS_LOG_MAX_DIRECT_OUTPUTS
+#   define PGS_LOG_MAX_DIRECT_OUTPUTS 4
+#endif
+#ifndef PGS_LOG_MMAP_WINDOW_SIZE
+#   define PGS_LOG_MMAP_WINDOW_SIZE (4 * 1024 * 1024)
+#endif
+#ifndef PGS_LOG_MMAP_GROW_SIZE
+#   define PGS_LOG_MMAP_GROW_SIZE (64 * 1024 * 1024)
+#endif
+#ifndef PGS_LOG_MAX_MMAP_OUTPUTS
+#   define PGS_LOG_MAX_MMAP_OUTPUTS 4
+#endif
+#ifndef PGS_LOG_OUTPUT_BUFFERS
+#   if PGS_LOG_ENABLE_IO_URING || PGS_LOG_ENABLE_FLUSH_THREAD || PGS_LOG_ENABLE_EVENT_LOOP
+#       define PGS_LOG_OUTPUT_BUFFERS 2
+#   else
+#       define PGS_LOG_OUTPUT_BUFFERS 1
+#   endif
+#endif
+#if PGS_LOG_ENABLE_IO_URING && PGS_LOG_OUTPUT_BUFFERS < 2
+#   error "PGS_LOG_ENABLE_IO_URING needs PGS_LOG_OUTPUT_BUFFERS >= 2"
+#endif
+#if PGS_LOG_ENABLE_FLUSH_THREAD && PGS_LOG_OUTPUT_BUFFERS < 2
+#   error "PGS_LOG_ENABLE_FLUSH_THREAD needs PGS_LOG_OUTPUT_BUFFERS >= 2"
+#endif
+#if PGS_LOG_ENABLE_EVENT_LOOP && PGS_LOG_OUTPUT_BUFFERS < 2
+#   error "PGS_LOG_ENABLE_EVENT_LOOP needs PGS_LOG_OUTPUT_BUFFERS >= 2"
+#endif
 
 typedef enum {
     PGS_LOG_DEBUG,
@@ -128,6 +648,33 @@ typedef enum {
     PGS_LOG_FATAL,
 } Pgs_Log_Level;
 
+/*
+ * Modules, define before including, every module gets its own level (inherits from its parent, `net` for `net.tls`):
+ *     #define PGS_LOG_MODULES(X) X(NET, "net") X(NET_TLS, "net.tls") X(DB, "db")
+ * and select the module of a translation unit with (root module if not defined):
+ *     #define PGS_LOG_MODULE PGS_LOG_MODULE_NET_TLS
+ */
+#ifndef PGS_LOG_MODULES
+#   define PGS_LOG_MODULES(X)
+#endif
+#ifndef PGS_LOG_MODULE
+#   define PGS_LOG_MODULE PGS_LOG_MODULE_ROOT
+#endif
+
+#define PGS_LOG_MODULE_ENUM_(id, name) PGS_LOG_MODULE_##id,
+
+typedef enum {
+    PGS_LOG_MODULE_ROOT,
+    PGS_LOG_MODULES(PGS_LOG_MODULE_ENUM_)
+    PGS_LOG_MODULE_COUNT,
+} Pgs_Log_Module;
+
+typedef enum {
+    PGS_LOG_DURABILITY_NONE,                        // only pgs_log_sync() makes entries durable
+    PGS_LOG_DURABILITY_PERIODIC,                    // a flush fdatasyncs once `PGS_LOG_DURABILITY_INTERVAL_MS` passed
+    PGS_LOG_DURABILITY_GROUP_COMMIT,                // every flush fdatasyncs, concurrent callers share one fdatasync
+} Pgs_Log_Durability;
+
 typedef enum {
     PGS_LOG_OK = 0,
     PGS_LOG_ERR,
@@ -146,32 +693,175 @@ typedef struct {
 } Pgs_Log_Error_Detail;
 #endif
 
+typedef Pgs_Log_Error (*Pgs_Log_Sink_Write)(void *ctx, const char *data, size_t len);
+
+typedef struct {
+    Pgs_Log_Sink_Write write;
+    Pgs_Log_Error (*flush)(void *ctx);              // pgs_log_flush() and remove, NULL if writes do not get held back
+    void (*close)(void *ctx);                       // on remove/cleanup, NULL if the sink does not own anything
+    int (*sync_fd)(void *ctx);                      // fd durability waits fdatasync, NULL for none
+    bool unbuffered;                                // write gets every entry right away, the sink buffers itself
+} Pgs_Log_Sink;
+
+#if PGS_LOG_ENABLE_NONBLOCKING
+typedef enum {
+    PGS_LOG_OVERFLOW_DROP_NEWEST,                   // entries that do not fit anymore are dropped
+    PGS_LOG_OVERFLOW_DROP_OLDEST,                   // the oldest pending entries make room
+    PGS_LOG_OVERFLOW_BLOCK,                         // wait for the fd like a blocking output would
+} Pgs_Log_Overflow_Policy;
+
+typedef struct {
+    size_t pending;                                 // bytes waiting for the fd
+    uint64_t dropped_entries;
+    uint64_t dropped_bytes;
+    uint64_t stalls;                                // writes the fd did not take completely
+} Pgs_Log_Output_Stats;
+#endif
+
+// fills a caller owned buffer, kept NUL terminated, whole entries that do not fit anymore get counted and dropped
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+    size_t dropped;                                 // bytes of the entries that did not fit
+} Pgs_Log_Memory_Sink;
+
 typedef struct {
-    FILE *fd;
+    Pgs_Log_Sink sink;
+    void *ctx;
+    int fd;                                         // fd behind the sink or -1, io_uring/flush thread/fdatasync use it
+    FILE *file;                                     // outputs added with pgs_log_add_fd_output()
+    bool terminal;                                  // stdout/stderr
+#if PGS_LOG_ENABLE_OUTPUT_FORMATS
+    Pgs_Log_Level min_level;
+    int format;                                     // 0 for `PGS_LOG_FORMAT`, otherwise 1 + index into the formats
+#endif
+#if PGS_LOG_ENABLE_NONBLOCKING
+    bool nonblocking;
+    Pgs_Log_Overflow_Policy overflow;
+    int fd_flags;                                   // before `O_NONBLOCK`, restored when the output goes away
+    int write_fd;                                   // own open file description of `fd` if it could be reopened
+    bool mid_entry;                                 // the fd got part of an entry, the rest is pending
+    char *pending;                                  // unwritten tail, oldest first at `pending_off`, allocated on
+                                                    // pgs_log_set_output_nonblocking()
+    size_t pending_off;
+    size_t pending_len;
+    uint64_t dropped_entries;
+    uint64_t dropped_bytes;
+    uint64_t stalls;
+#endif
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    int loop_fd_flags;                              // before the loop set `O_NONBLOCK`, -1 if it was already set
+#endif
 #if PGS_LOG_ENABLE_BUFFERING
-    char buffer[PGS_LOG_MAX_OUTPUT_BUFFER_SIZE];
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+    char *buffers[PGS_LOG_OUTPUT_BUFFERS];          // allocated on first use, NULL until then
+    size_t buf_size;
+#else
+    char buffers[PGS_LOG_OUTPUT_BUFFERS][PGS_LOG_MAX_OUTPUT_BUFFER_SIZE];
+#endif
+    int buf_index;                                  // buffer new entries get appended to
     size_t buf_pos;
+#if PGS_LOG_OUTPUT_BUFFERS > 1
+    // full buffers handed off to be written in the background, oldest first, following each other in ring order
+    size_t queued_lens[PGS_LOG_OUTPUT_BUFFERS];
+    int queued_fds[PGS_LOG_OUTPUT_BUFFERS];         // fd each one goes to, the log file can switch while they wait
+    int queue_head;
+    int queued;
+    size_t queued_done;                             // bytes of the oldest queued buffer already written
+    bool in_flight;
+#endif
 #endif
 } Pgs_Log_Output;
 
+#define PGS_LOG_OUTPUT_BUFFER(o) ((o)->buffers[(o)->buf_index])
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+#   define PGS_LOG_OUTPUT_BUFFER_SIZE(o) ((o)->buf_size)
+#else
+#   define PGS_LOG_OUTPUT_BUFFER_SIZE(o) PGS_LOG_MAX_OUTPUT_BUFFER_SIZE
+#endif
+
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+typedef struct {
+    void *(*alloc)(void *ctx, size_t size);
+    void (*free)(void *ctx, void *ptr, size_t size);
+    void *ctx;
+} Pgs_Log_Allocator;
+#endif
+
 extern Pgs_Log_Level pgs_log_minimal_log_level;
+extern Pgs_Log_Level pgs_log_flush_level;
+extern Pgs_Log_Durability pgs_log_durability;
 
 Pgs_Log_Error_Detail pgs_log_get_last_error(void);
 Pgs_Log_Error pgs_log_set_last_error(Pgs_Log_Error type, const char *message, int errn);
 
 Pgs_Log_Error pgs_log(Pgs_Log_Level level, const char *file, size_t file_len, const char *line, size_t line_len, const char *fmt, ...);
+Pgs_Log_Error pgs_log_module(Pgs_Log_Module module, Pgs_Log_Level level, const char *file, size_t file_len, const char *line, size_t line_len, const char *fmt, ...);
+Pgs_Log_Error pgs_log_modulev(Pgs_Log_Module module, Pgs_Log_Level level, const char *file, size_t file_len, const char *line, size_t line_len, const char *fmt, va_list ap);
+
+typedef struct Pgs_Log_Ratelimit {
+    Pgs_Log_Module module;
+    Pgs_Log_Level level;
+    const char *file;
+    const char *line;
+    uint64_t window;                // second the current window started << 32 | entries let through in it
+    unsigned int sampled;           // calls seen by a sampled callsite
+    unsigned int suppressed;        // suppressed since the last summary
+    int registered;
+    struct Pgs_Log_Ratelimit *next;
+    const char *site;               // "file:line" literal, only for the table of compilers without statement expressions
+} Pgs_Log_Ratelimit;
+
+Pgs_Log_Ratelimit *pgs_log_ratelimit_site(const char *site, Pgs_Log_Module module, Pgs_Log_Level level, const char *file, const char *line);
+bool pgs_log_ratelimit_allow(Pgs_Log_Ratelimit *rl, unsigned int n_per_sec);
+bool pgs_log_sample_allow(Pgs_Log_Ratelimit *rl, unsigned int one_in_n);
+Pgs_Log_Error pgs_log_ratelimit_report(void);
+
+Pgs_Log_Error pgs_log_set_module_level(const char *name, Pgs_Log_Level level);
+Pgs_Log_Error pgs_log_reset_module_level(const char *name);
+Pgs_Log_Level pgs_log_get_module_level(Pgs_Log_Module module);
+const char *pgs_log_module_name(Pgs_Log_Module module);
 
 const char *pgs_log_level_to_string(Pgs_Log_Level level);
 const char *pgs_log_timestamp_string(void);
 
 Pgs_Log_Error pgs_log_add_fd_output(FILE *file);
 Pgs_Log_Error pgs_log_remove_fd_output(FILE *file);
+Pgs_Log_Error pgs_log_add_raw_fd_output(int fd, bool owned);
+Pgs_Log_Error pgs_log_remove_raw_fd_output(int fd);
+Pgs_Log_Error pgs_log_add_sink_output(Pgs_Log_Sink sink, void *ctx);
+Pgs_Log_Error pgs_log_add_callback_output(Pgs_Log_Sink_Write write, void *ctx);
+Pgs_Log_Error pgs_log_remove_sink_output(void *ctx);
+void pgs_log_memory_sink_init(Pgs_Log_Memory_Sink *memory, char *buffer, size_t cap);
+Pgs_Log_Error pgs_log_add_memory_output(Pgs_Log_Memory_Sink *memory);
+#if PGS_LOG_ENABLE_NONBLOCKING
+Pgs_Log_Error pgs_log_set_output_nonblocking(int fd, Pgs_Log_Overflow_Policy policy);
+Pgs_Log_Error pgs_log_set_output_blocking(int fd);
+Pgs_Log_Error pgs_log_poll_outputs(int timeout_ms);
+Pgs_Log_Error pgs_log_get_output_stats(int fd, Pgs_Log_Output_Stats *stats);
+#endif
+#if PGS_LOG_ENABLE_OUTPUT_FORMATS
+Pgs_Log_Error pgs_log_set_output_level(int fd, Pgs_Log_Level level);
+Pgs_Log_Error pgs_log_set_output_format(int fd, const char *format);
+#endif
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+Pgs_Log_Error pgs_log_set_allocator(const Pgs_Log_Allocator *allocator);
+Pgs_Log_Error pgs_log_use_arena(void *memory, size_t size);
+Pgs_Log_Error pgs_log_set_max_outputs(int count);
+size_t pgs_log_allocated_bytes(void);
+#if PGS_LOG_ENABLE_BUFFERING
+Pgs_Log_Error pgs_log_set_buffer_size(size_t size);
+Pgs_Log_Error pgs_log_set_output_buffer_size(int fd, size_t size);
+#endif
+#endif
 
 Pgs_Log_Error pgs_log_mkdir_if_not_exists(const char *path);
 Pgs_Log_Error pgs_log_create_dirs_for_path(const char *fullpath);
 
 bool pgs_log_file_exists(const char *file_path);
 int pgs_log_get_last_occurence_of(const char ch, const char *string);
+void pgs_log_numbered_filename(char *out, const char *name, int number);
 
 void pgs_log_cleanup(void);
 
@@ -183,378 +873,5293 @@ char *pgs_log_temp_sprintf(const char *format, ...);
 
 Pgs_Log_Error pgs_log_write_output(const char *str, size_t len);
 Pgs_Log_Error pgs_log_flush(void);
+Pgs_Log_Error pgs_log_sync(void);
+Pgs_Log_Error pgs_log_flush_if_due(void);
+#if PGS_LOG_TERMINAL_COALESCE
+Pgs_Log_Error pgs_log_flush_terminals(void);
+#endif
+Pgs_Log_Error pgs_log_reopen(void);
+Pgs_Log_Error pgs_log_install_reopen_signal(int signo);
+uint64_t pgs_log_last_sequence(void);
+uint64_t pgs_log_durable_sequence(void);
+uint64_t pgs_log_truncated_count(void);
+Pgs_Log_Error pgs_log_wait_durable(uint64_t sequence);
+
+#if PGS_LOG_ENABLE_IO_URING
+bool pgs_log_io_uring_active(void);
+#endif
+
+#if PGS_LOG_ENABLE_FLUSH_THREAD
+bool pgs_log_flush_thread_active(void);
+#endif
+
+#if PGS_LOG_ENABLE_EVENT_LOOP
+int pgs_log_event_fd(void);
+Pgs_Log_Error pgs_log_service(size_t budget);
+bool pgs_log_service_pending(void);
+#endif
+
+#if PGS_LOG_ENABLE_MMAP_OUTPUT
+typedef struct {
+    bool in_use;
+    int fd;
+    char path[PGS_LOG_MAX_PATH_LEN];
+    char *window;                   // `PGS_LOG_MMAP_WINDOW_SIZE` bytes of the file mapped at `window_off`
+    size_t window_off;
+    size_t pos;                     // write position inside the window, file length is window_off + pos
+    size_t allocated;               // file size reserved so far, always past the mapped window until close
+} Pgs_Log_Mmap_Output;
+
+Pgs_Log_Error pgs_log_add_mmap_output(const char *path, bool append);
+Pgs_Log_Error pgs_log_remove_mmap_output(const char *path);
+#endif
+
+#if PGS_LOG_ENABLE_DIRECT_OUTPUT
+typedef struct {
+    bool in_use;
+    int fd;
+    char path[PGS_LOG_MAX_PATH_LEN];
+    char *buffer;                   // `PGS_LOG_DIRECT_BUFFER_SIZE` bytes, aligned to `PGS_LOG_DIRECT_ALIGNMENT`
+    size_t pos;
+    off_t file_off;                 // file offset of buffer[0], always aligned
+    bool direct;                    // false if the filesystem rejected O_DIRECT, writes are dropped from the page cache instead
+} Pgs_Log_Direct_Output;
+
+Pgs_Log_Error pgs_log_add_direct_output(const char *path, bool append);
+Pgs_Log_Error pgs_log_remove_direct_output(const char *path);
+bool pgs_log_direct_output_is_direct(const char *path);
+#endif
+
+#if PGS_LOG_ENABLE_SEGMENTS
+typedef struct {
+    bool in_use;
+    int fds[PGS_LOG_SEGMENT_COUNT];
+    char path[PGS_LOG_MAX_PATH_LEN];
+    int current;                    // segment entries get appended to
+    uint64_t generation;            // of the current segment, every started segment gets the next one
+    size_t used;                    // bytes of the current segment already written behind its header
+    char buffer[PGS_LOG_SEGMENT_BUFFER_SIZE];
+    size_t buf_pos;
+} Pgs_Log_Segment_Output;
+
+Pgs_Log_Error pgs_log_add_segment_output(const char *path);
+Pgs_Log_Error pgs_log_remove_segment_output(const char *path);
+Pgs_Log_Error pgs_log_segments_dump(const char *path, const char *out_path);
+#endif
+
+#if PGS_LOG_ENABLE_COMPRESSION
+#define PGS_LOG_COMPRESS_MAGIC "PGZF"
+#define PGS_LOG_COMPRESS_HEADER_SIZE 16
+
+typedef enum {
+    PGS_LOG_CODEC_STORED,
+    PGS_LOG_CODEC_LZ,
+    PGS_LOG_CODEC_ZLIB,
+} Pgs_Log_Codec;
+
+typedef struct {
+    bool used;
+    int fd;
+    int index_fd;                                   // `path.idx`
+    char path[PGS_LOG_MAX_PATH_LEN];
+    uint64_t file_offset;                           // compressed bytes in the file
+    uint64_t raw_offset;                            // uncompressed bytes in the file
+} Pgs_Log_Compressed_Output;
+
+Pgs_Log_Error pgs_log_add_compressed_output(const char *path, bool append);
+Pgs_Log_Error pgs_log_remove_compressed_output(const char *path);
+Pgs_Log_Error pgs_log_compressed_dump(const char *path, uint64_t from, const char *out_path);
+#endif
+
+#if PGS_LOG_ENABLE_VMSPLICE
+typedef struct {
+    bool in_use;
+    int fd;
+    bool owned;                                     // closed on remove/cleanup
+    bool spliced;                                   // false once vmsplice failed, write() from then on
+    char *buffer;                                   // page aligned mapping, replaced by fresh pages once gifted
+    size_t pos;
+} Pgs_Log_Pipe_Output;
+
+Pgs_Log_Error pgs_log_add_pipe_output(int fd, bool owned);
+Pgs_Log_Error pgs_log_remove_pipe_output(int fd);
+bool pgs_log_pipe_output_is_spliced(int fd);
+#endif
+
+#if PGS_LOG_ENABLE_SYSLOG_OUTPUT
+typedef enum {
+    PGS_LOG_SYSLOG_RFC5424,
+    PGS_LOG_SYSLOG_JOURNALD,
+} Pgs_Log_Syslog_Format;
+
+typedef struct {
+    bool in_use;
+    int fd;                                         // -1 while disconnected, the next send reconnects
+    char path[PGS_LOG_MAX_PATH_LEN];
+    Pgs_Log_Syslog_Format format;
+    char ident[64];
+    char hostname[64];
+    int pid;
+    char buffer[PGS_LOG_SYSLOG_BUFFER_SIZE];        // framed datagrams back to back
+    size_t buf_pos;
+    size_t lens[PGS_LOG_SYSLOG_BATCH];
+    int count;
+    uint64_t dropped;                               // datagrams that could not be delivered
+} Pgs_Log_Syslog_Output;
+
+Pgs_Log_Error pgs_log_add_syslog_output(const char *socket_path, Pgs_Log_Syslog_Format format, const char *ident);
+Pgs_Log_Error pgs_log_remove_syslog_output(const char *socket_path);
+#endif
+
+#if PGS_LOG_ENABLE_BACKLOG
+Pgs_Log_Error pgs_log_backlog_flush(void);
+void pgs_log_backlog_clear(void);
+#endif
+
+#if PGS_LOG_ENABLE_FLIGHT_RECORDER
+#define PGS_LOG_FLIGHT_RECORDER_MAGIC "PGSFLREC"
+
+typedef struct {
+    char magic[8];
+    unsigned long long size;        // capacity of the data area following the header
+    unsigned long long written;     // total bytes ever written, write position is `written % size`
+} Pgs_Log_Flight_Recorder_Header;
+
+extern Pgs_Log_Level pgs_log_flight_recorder_level;
+
+Pgs_Log_Error pgs_log_flight_recorder_init(const char *mmap_path);
+Pgs_Log_Error pgs_log_flight_recorder_write(const char *str, size_t len);
+Pgs_Log_Error pgs_log_flight_recorder_dump(const char *path);
+Pgs_Log_Error pgs_log_flight_recorder_read(const char *recorder_path, const char *out_path);
+Pgs_Log_Error pgs_log_flight_recorder_install_signal(int signo);
+Pgs_Log_Error pgs_log_flight_recorder_install_crash_handler(void);
+#endif
+
+#if PGS_LOG_ENABLE_USDT && defined(__x86_64__) && defined(__linux__) && defined(__GNUC__)
+#define PGS_LOG_USDT_ACTIVE 1
+
+/*
+ * Minimal SystemTap SDT v3 note emitter (same layout as <sys/sdt.h>), so there is no dependency on systemtap headers.
+ * Every expansion places a nop and describes it in `.note.stapsdt`, tools like bpftrace/perf patch the nop when attaching.
+ */
+#define PGS_LOG_USDT_PROBE4(name, semaphore, v1, v2, v3, v4)                                    \
+    __asm__ __volatile__ (                                                                      \
+        "990: nop\n"                                                                            \
+        ".pushsection .note.stapsdt,\"?\",\"note\"\n"                                           \
+        ".balign 4\n"                                                                           \
+        ".4byte 992f-991f, 994f-993f, 3\n"                                                      \
+        "991: .asciz \"stapsdt\"\n"                                                             \
+        "992: .balign 4\n"                                                                      \
+        "993: .8byte 990b\n"                                                                    \
+        ".8byte _.stapsdt.base\n"                                                               \
+        ".8byte " semaphore "\n"                                                                \
+        ".asciz \"pgs_log\"\n"                                                                  \
+        ".asciz \"" name "\"\n"                                                                 \
+        ".asciz \"-4@%[a1] 8@%[a2] -4@%[a3] 8@%[a4]\"\n"                                        \
+        "994: .balign 4\n"                                                                      \
+        ".popsection\n"                                                                         \
+        ".ifndef _.stapsdt.base\n"                                                              \
+        ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"                 \
+        ".weak _.stapsdt.base\n"                                                                \
+        ".hidden _.stapsdt.base\n"                                                              \
+        "_.stapsdt.base: .space 1\n"                                                            \
+        ".size _.stapsdt.base, 1\n"                                                             \
+        ".popsection\n"                                                                         \
+        ".endif\n"                                                                              \
+        :: [a1] "nor" ((int)(v1)), [a2] "nor" ((const void *)(v2)),                             \
+           [a3] "nor" ((int)(v3)), [a4] "nor" ((const void *)(v4)))
+
+// set by the tracer while something is attached to pgs_log:message
+extern volatile unsigned short pgs_log_usdt_message_semaphore;
+#define PGS_LOG_USDT_MESSAGE_ENABLED() (pgs_log_usdt_message_semaphore != 0)
+
+static inline __attribute__((always_inline)) void pgs_log_usdt_callsite(int level, const char *file, int line, const char *fmt) {
+    PGS_LOG_USDT_PROBE4("callsite", "0", level, file, line, fmt);
+}
+
+#define PGS_LOG_USDT_CALLSITE(level, fmt) pgs_log_usdt_callsite((level), __FILE__, __LINE__, (fmt)),
+#else
+#define PGS_LOG_USDT_ACTIVE 0
+#define PGS_LOG_USDT_CALLSITE(level, fmt)
+#endif
 
 #define STRINGIFY_(x) #x
 #define STRINGIFY(x) STRINGIFY_(x)
 
 #define PGS_LOG_DEBUG(fmt, ...)                                                                 \
-    do {                                                                                        \
-        pgs_log(PGS_LOG_DEBUG, __FILE__, (size_t)(sizeof(__FILE__) - 1),                        \
-        STRINGIFY(__LINE__), (size_t)(sizeof(STRINGIFY(__LINE__)) - 1), fmt, ##__VA_ARGS__);    \
-    } while(0)
+    (PGS_LOG_USDT_CALLSITE(PGS_LOG_DEBUG, fmt)                                                  \
+    pgs_log_module(PGS_LOG_MODULE, PGS_LOG_DEBUG, __FILE__, (size_t)(sizeof(__FILE__) - 1),     \
+        STRINGIFY(__LINE__), (size_t)(sizeof(STRINGIFY(__LINE__)) - 1), fmt, ##__VA_ARGS__))
 
 #define PGS_LOG_INFO(fmt, ...)                                                                  \
-    do {                                                                                        \
-        pgs_log(PGS_LOG_INFO, __FILE__, (size_t)(sizeof(__FILE__) - 1),                         \
-        STRINGIFY(__LINE__), (size_t)(sizeof(STRINGIFY(__LINE__)) - 1), fmt, ##__VA_ARGS__);    \
-    } while(0)
+    (PGS_LOG_USDT_CALLSITE(PGS_LOG_INFO, fmt)                                                   \
+    pgs_log_module(PGS_LOG_MODULE, PGS_LOG_INFO, __FILE__, (size_t)(sizeof(__FILE__) - 1),      \
+        STRINGIFY(__LINE__), (size_t)(sizeof(STRINGIFY(__LINE__)) - 1), fmt, ##__VA_ARGS__))
+
+#define PGS_LOG_WARN(fmt, ...)                                                                  \
+    (PGS_LOG_USDT_CALLSITE(PGS_LOG_WARN, fmt)                                                   \
+    pgs_log_module(PGS_LOG_MODULE, PGS_LOG_WARN, __FILE__, (size_t)(sizeof(__FILE__) - 1),      \
+        STRINGIFY(__LINE__), (size_t)(sizeof(STRINGIFY(__LINE__)) - 1), fmt, ##__VA_ARGS__))
+
+#define PGS_LOG_ERROR(fmt, ...)                                                                 \
+    (PGS_LOG_USDT_CALLSITE(PGS_LOG_ERROR, fmt)                                                  \
+    pgs_log_module(PGS_LOG_MODULE, PGS_LOG_ERROR, __FILE__, (size_t)(sizeof(__FILE__) - 1),     \
+        STRINGIFY(__LINE__), (size_t)(sizeof(STRINGIFY(__LINE__)) - 1), fmt, ##__VA_ARGS__))
+
+#define PGS_LOG_FATAL(fmt, ...)                                                                 \
+    (PGS_LOG_USDT_CALLSITE(PGS_LOG_FATAL, fmt)                                                  \
+    pgs_log_module(PGS_LOG_MODULE, PGS_LOG_FATAL, __FILE__, (size_t)(sizeof(__FILE__) - 1),     \
+        STRINGIFY(__LINE__), (size_t)(sizeof(STRINGIFY(__LINE__)) - 1), fmt, ##__VA_ARGS__))
+
+/*
+ * Rate limited / sampled variants, expressions like the plain ones, suppressed calls return PGS_LOG_OK before any argument
+ * is evaluated. Every callsite has its own static state, compilers without statement expressions look it up in a table
+ * of `PGS_LOG_MAX_RATELIMIT_SITES` by the address of its "file:line" literal.
+ * A "suppressed N messages from file:line" summary is written once the window of the callsite is over, with its next
+ * entry, from pgs_log_flush_if_due() or on pgs_log_flush().
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define PGS_LOG_RATELIMIT_SITE_(site_level)                                                     \
+    __extension__ ({                                                                            \
+        static Pgs_Log_Ratelimit pgs_log_rl_ = {                                                \
+            .module = PGS_LOG_MODULE, .level = (site_level), .file = __FILE__, .line = STRINGIFY(__LINE__) }; \
+        &pgs_log_rl_;                                                                           \
+    })
+#else
+#define PGS_LOG_RATELIMIT_SITE_(level)                                                          \
+    pgs_log_ratelimit_site(__FILE__ ":" STRINGIFY(__LINE__), PGS_LOG_MODULE, level, __FILE__, STRINGIFY(__LINE__))
+#endif
+
+#define PGS_LOG_RATELIMITED_(level, n_per_sec, fmt, ...)                                        \
+    (pgs_log_ratelimit_allow(PGS_LOG_RATELIMIT_SITE_(level), (n_per_sec))                      \
+        ? (PGS_LOG_USDT_CALLSITE(level, fmt)                                                    \
+            pgs_log_module(PGS_LOG_MODULE, level, __FILE__, (size_t)(sizeof(__FILE__) - 1),     \
+                STRINGIFY(__LINE__), (size_t)(sizeof(STRINGIFY(__LINE__)) - 1), fmt, ##__VA_ARGS__)) \
+        : pgs_log_set_last_error(PGS_LOG_OK, "Rate limited", 0))
+
+#define PGS_LOG_SAMPLED_(level, one_in_n, fmt, ...)                                             \
+    (pgs_log_sample_allow(PGS_LOG_RATELIMIT_SITE_(level), (one_in_n))                          \
+        ? (PGS_LOG_USDT_CALLSITE(level, fmt)                                                    \
+            pgs_log_module(PGS_LOG_MODULE, level, __FILE__, (size_t)(sizeof(__FILE__) - 1),     \
+                STRINGIFY(__LINE__), (size_t)(sizeof(STRINGIFY(__LINE__)) - 1), fmt, ##__VA_ARGS__)) \
+        : pgs_log_set_last_error(PGS_LOG_OK, "Sampled out", 0))
+
+#define PGS_LOG_DEBUG_RATELIMITED(n_per_sec, fmt, ...) PGS_LOG_RATELIMITED_(PGS_LOG_DEBUG, n_per_sec, fmt, ##__VA_ARGS__)
+#define PGS_LOG_INFO_RATELIMITED(n_per_sec, fmt, ...)  PGS_LOG_RATELIMITED_(PGS_LOG_INFO, n_per_sec, fmt, ##__VA_ARGS__)
+#define PGS_LOG_WARN_RATELIMITED(n_per_sec, fmt, ...)  PGS_LOG_RATELIMITED_(PGS_LOG_WARN, n_per_sec, fmt, ##__VA_ARGS__)
+#define PGS_LOG_ERROR_RATELIMITED(n_per_sec, fmt, ...) PGS_LOG_RATELIMITED_(PGS_LOG_ERROR, n_per_sec, fmt, ##__VA_ARGS__)
+#define PGS_LOG_FATAL_RATELIMITED(n_per_sec, fmt, ...) PGS_LOG_RATELIMITED_(PGS_LOG_FATAL, n_per_sec, fmt, ##__VA_ARGS__)
+
+#define PGS_LOG_DEBUG_SAMPLED(one_in_n, fmt, ...) PGS_LOG_SAMPLED_(PGS_LOG_DEBUG, one_in_n, fmt, ##__VA_ARGS__)
+#define PGS_LOG_INFO_SAMPLED(one_in_n, fmt, ...)  PGS_LOG_SAMPLED_(PGS_LOG_INFO, one_in_n, fmt, ##__VA_ARGS__)
+#define PGS_LOG_WARN_SAMPLED(one_in_n, fmt, ...)  PGS_LOG_SAMPLED_(PGS_LOG_WARN, one_in_n, fmt, ##__VA_ARGS__)
+#define PGS_LOG_ERROR_SAMPLED(one_in_n, fmt, ...) PGS_LOG_SAMPLED_(PGS_LOG_ERROR, one_in_n, fmt, ##__VA_ARGS__)
+#define PGS_LOG_FATAL_SAMPLED(one_in_n, fmt, ...) PGS_LOG_SAMPLED_(PGS_LOG_FATAL, one_in_n, fmt, ##__VA_ARGS__)
+
+
+
+#endif // PGS_LOG_H
+
+#ifdef PGS_LOG_IMPLEMENTATION
+
+#if defined(_WIN32)
+    #include <io.h>
+    #define pgs_write _write
+    #define pgs_close _close
+#else
+    #include <unistd.h>
+    #include <pthread.h>
+    #define pgs_write write
+    #define pgs_close close
+#endif
+
+#if defined(_MSC_VER)
+#   define PGS_LOG_THREAD_LOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#   define PGS_LOG_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#   define PGS_LOG_THREAD_LOCAL __thread
+#else
+#   define PGS_LOG_THREAD_LOCAL
+#endif
+
+#if PGS_LOG_ENABLE_FLUSH_THREAD
+// while the flush thread runs, cleanup would take its lock from signal context, the handler wakes a helper
+// thread through this pipe instead that cleans up and exits, a second Ctrl-C terminates right away
+static int pgs_log_interrupt_pipe[2] = { -1, -1 };
+#endif
+
+void sigint_handler(int signo) {
+#if PGS_LOG_ENABLE_FLUSH_THREAD
+    if (pgs_log_interrupt_pipe[1] >= 0) {
+        int saved = errno;
+        char c = 1;
+        signal(signo, SIG_DFL);
+        if (write(pgs_log_interrupt_pipe[1], &c, 1) == 1) {
+            errno = saved;
+            return;
+        }
+        errno = saved;
+    }
+#endif
+    pgs_log_cleanup();
+    (void)signo;
+    exit(130);
+}
+
+Pgs_Log_Level pgs_log_minimal_log_level = PGS_LOG_DEBUG;
+Pgs_Log_Level pgs_log_flush_level = PGS_LOG_FLUSH_LEVEL;
+Pgs_Log_Durability pgs_log_durability = PGS_LOG_DURABILITY;
+
+#if PGS_LOG_USDT_ACTIVE
+__attribute__((section(".probes"), used)) volatile unsigned short pgs_log_usdt_message_semaphore = 0;
+#endif
+
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+static Pgs_Log_Output *pgs_outputs = NULL;         // allocated with the first output, freed by cleanup
+static int pgs_output_capacity = PGS_LOG_MAX_FD;
+#else
+static Pgs_Log_Output pgs_outputs[PGS_LOG_MAX_FD];
+#endif
+static int pgs_output_count = 0;
+static bool pgs_log_initialized = false;
+static bool pgs_log_is_enabled = PGS_LOG_ENABLED;
+
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+static void *pgs_log_malloc(void *ctx, size_t size) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void pgs_log_free(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    (void)size;
+    free(ptr);
+}
+
+static struct {
+    char *base;
+    size_t size;
+    size_t used;
+} pgs_log_arena;
+
+static void *pgs_log_arena_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    size_t start = (pgs_log_arena.used + 63) & ~(size_t)63;
+    if (start > pgs_log_arena.size || size > pgs_log_arena.size - start) return NULL;
+    pgs_log_arena.used = start + size;
+    return pgs_log_arena.base + start;
+}
+
+static void pgs_log_arena_free(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    // only the newest allocation can be given back, everything else is reused after pgs_log_cleanup()
+    if ((char *)ptr + size == pgs_log_arena.base + pgs_log_arena.used)
+        pgs_log_arena.used = (size_t)((char *)ptr - pgs_log_arena.base);
+}
+
+static Pgs_Log_Allocator pgs_log_allocator = { .alloc = pgs_log_malloc, .free = pgs_log_free };
+static size_t pgs_log_allocated = 0;
+#if PGS_LOG_ENABLE_BUFFERING
+static size_t pgs_log_buffer_size = PGS_LOG_MAX_OUTPUT_BUFFER_SIZE;
+#endif
+
+static void *pgs_log_mem_alloc(size_t size) {
+    void *ptr = pgs_log_allocator.alloc(pgs_log_allocator.ctx, size);
+    if (ptr) pgs_log_allocated += size;
+    return ptr;
+}
+
+static void pgs_log_mem_free(void *ptr, size_t size) {
+    if (!ptr) return;
+    pgs_log_allocator.free(pgs_log_allocator.ctx, ptr, size);
+    pgs_log_allocated -= size;
+}
+
+#if PGS_LOG_ENABLE_BUFFERING
+static bool pgs_log_output_buffer_alloc(Pgs_Log_Output *o) {
+    o->buffers[o->buf_index] = pgs_log_mem_alloc(o->buf_size);
+    return o->buffers[o->buf_index] != NULL;
+}
+
+static void pgs_log_output_buffers_free(Pgs_Log_Output *o) {
+    for (int i = 0; i < PGS_LOG_OUTPUT_BUFFERS; ++i) {
+        pgs_log_mem_free(o->buffers[i], o->buf_size);
+        o->buffers[i] = NULL;
+    }
+}
+#endif
+#endif // PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+
+static volatile sig_atomic_t pgs_log_reopen_requested = 0;
+static uint64_t pgs_log_sequence = 0;
+static PGS_LOG_THREAD_LOCAL uint64_t pgs_log_thread_sequence = 0;
+static uint64_t pgs_log_truncated = 0;              // entries that went to the outputs cut at `PGS_LOG_MAX_ENTRY_LEN`
+
+#if PGS_LOG_MAX_BUFFER_AGE_MS > 0
+static uint64_t pgs_log_buffered_since_ms = 0;     // 0 while nothing is waiting for a flush
+#endif
+
+static uint64_t pgs_log_now_ms(void) {
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC_COARSE)
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#elif defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+#if PGS_LOG_ENABLE_EVENT_LOOP
+
+#include <sys/eventfd.h>
+
+static struct {
+    int fd;                     // eventfd, created on first use
+    bool signalled;             // written since the last pgs_log_service(), saves a syscall per log call
+    bool due;                   // a flush was requested, current buffers get queued too
+    int next;                   // output serviced first, keeps one busy output from starving the others
+} pgs_log_loop = { .fd = -1 };
+
+static void pgs_log_loop_signal(void) {
+    if (pgs_log_loop.signalled || pgs_log_event_fd() < 0) return;
+
+    uint64_t one = 1;
+    if (write(pgs_log_loop.fd, &one, sizeof(one)) == sizeof(one))
+        pgs_log_loop.signalled = true;
+}
+
+static void pgs_log_loop_request(void) {
+    pgs_log_loop.due = true;
+    pgs_log_loop_signal();
+}
+
+int pgs_log_event_fd(void) {
+    if (pgs_log_loop.fd < 0)
+        pgs_log_loop.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return pgs_log_loop.fd;
+}
+
+#endif // PGS_LOG_ENABLE_EVENT_LOOP
+
+#if PGS_LOG_TERMINAL_COALESCE
+static int pgs_log_terminal_pending = 0;            // entries buffered for the terminals since their last write
+static uint64_t pgs_log_terminal_since_us = 0;      // when the oldest of them was logged
+static uint64_t pgs_log_terminal_last_us = 0;       // when the last entry was logged
+
+// the coarse clock ticks in milliseconds, too slow for a budget of about one
+static uint64_t pgs_log_now_us(void) {
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+#if PGS_LOG_TERMINAL_TIMER
+// the timer thread writes terminal entries whose budget ran out while no log call came. `lock` covers the terminal
+// outputs (their buffers and the output table) and the pending state above, nothing else is touched by the thread
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_t thread;
+    int state;                  // 0 not started, 1 running, -1 failed to start
+    bool stop;
+    uint64_t woken_since_us;    // event loop mode, `since` of the entries the loop was already woken for
+    Pgs_Log_Error error;        // of the last write from the thread, reported by the next log call
+} pgs_log_terminal_timer = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work = PTHREAD_COND_INITIALIZER,
+};
+
+#   define PGS_LOG_TERMINAL_LOCK()          pthread_mutex_lock(&pgs_log_terminal_timer.lock)
+#   define PGS_LOG_TERMINAL_UNLOCK()        pthread_mutex_unlock(&pgs_log_terminal_timer.lock)
+#   define PGS_LOG_TERMINAL_LOCK_OUTPUT(o)  do { if ((o)->terminal) PGS_LOG_TERMINAL_LOCK(); } while (0)
+#   define PGS_LOG_TERMINAL_UNLOCK_OUTPUT(o) do { if ((o)->terminal) PGS_LOG_TERMINAL_UNLOCK(); } while (0)
+#if !PGS_LOG_ENABLE_EVENT_LOOP
+// the timer thread hands off terminals itself, io_uring submissions and the flusher queue are the caller's
+#   define PGS_LOG_TERMINAL_QUEUES(o) (!(o)->terminal)
+#endif
+#endif // PGS_LOG_TERMINAL_TIMER
+#endif // PGS_LOG_TERMINAL_COALESCE
+
+#ifndef PGS_LOG_TERMINAL_LOCK
+#   define PGS_LOG_TERMINAL_LOCK()
+#   define PGS_LOG_TERMINAL_UNLOCK()
+#   define PGS_LOG_TERMINAL_LOCK_OUTPUT(o)
+#   define PGS_LOG_TERMINAL_UNLOCK_OUTPUT(o)
+#endif
+#ifndef PGS_LOG_TERMINAL_QUEUES
+#   define PGS_LOG_TERMINAL_QUEUES(o) true
+#endif
+
+#if PGS_LOG_TERMINAL_COALESCE
+#if PGS_LOG_TERMINAL_TIMER
+static void *pgs_log_terminal_timer_main(void *arg) {
+    (void)arg;
+
+    PGS_LOG_TERMINAL_LOCK();
+    while (!pgs_log_terminal_timer.stop) {
+        uint64_t since = pgs_log_terminal_since_us;
+        if (pgs_log_terminal_pending == 0 || pgs_log_terminal_timer.woken_since_us == since) {
+            pthread_cond_wait(&pgs_log_terminal_timer.work, &pgs_log_terminal_timer.lock);
+            continue;
+        }
+
+        uint64_t now = pgs_log_now_us();
+        if (now - since < PGS_LOG_TERMINAL_COALESCE_US) {
+            uint64_t wait_us = PGS_LOG_TERMINAL_COALESCE_US - (now - since);
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_sec += (time_t)(wait_us / 1000000);
+            until.tv_nsec += (long)(wait_us % 1000000) * 1000;
+            if (until.tv_nsec >= 1000000000L) {
+                until.tv_sec++;
+                until.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&pgs_log_terminal_timer.work, &pgs_log_terminal_timer.lock, &until);
+            continue;
+        }
+
+#if PGS_LOG_ENABLE_EVENT_LOOP
+        // terminals are written by the loop, it only gets woken, pgs_log_service() sees the budget ran out
+        pgs_log_terminal_timer.woken_since_us = since;
+        uint64_t one = 1;
+        if (pgs_log_loop.fd >= 0 && write(pgs_log_loop.fd, &one, sizeof(one)) < 0) {}
+#else
+        PGS_LOG_TERMINAL_UNLOCK();
+        Pgs_Log_Error err = pgs_log_flush_terminals();
+        PGS_LOG_TERMINAL_LOCK();
+        if (err != PGS_LOG_OK) pgs_log_terminal_timer.error = err;
+#endif
+    }
+    PGS_LOG_TERMINAL_UNLOCK();
+
+    return NULL;
+}
+
+static void pgs_log_terminal_timer_stop(void) {
+    if (pgs_log_terminal_timer.state <= 0) return;
+
+    PGS_LOG_TERMINAL_LOCK();
+    pgs_log_terminal_timer.stop = true;
+    pthread_cond_signal(&pgs_log_terminal_timer.work);
+    PGS_LOG_TERMINAL_UNLOCK();
+
+    pthread_join(pgs_log_terminal_timer.thread, NULL);
+    pgs_log_terminal_timer.state = 0;
+    pgs_log_terminal_timer.stop = false;
+}
+#endif // PGS_LOG_TERMINAL_TIMER
+
+static Pgs_Log_Error pgs_log_terminal_write_if_due(Pgs_Log_Level level) {
+    PGS_LOG_TERMINAL_LOCK();
+    uint64_t now = pgs_log_now_us();
+    bool idle = now - pgs_log_terminal_last_us >= PGS_LOG_TERMINAL_COALESCE_US;
+    pgs_log_terminal_last_us = now;
+    if (pgs_log_terminal_pending++ == 0)
+        pgs_log_terminal_since_us = now;
+
+    bool hold = level < PGS_LOG_TERMINAL_IMMEDIATE_LEVEL && !idle
+        && pgs_log_terminal_pending < PGS_LOG_TERMINAL_COALESCE_ENTRIES
+        && now - pgs_log_terminal_since_us < PGS_LOG_TERMINAL_COALESCE_US;
+#if PGS_LOG_TERMINAL_TIMER
+    if (hold) {
+        // the budget holds even if this was the last entry for a while
+        if (pgs_log_terminal_timer.state == 0)
+            pgs_log_terminal_timer.state = pthread_create(&pgs_log_terminal_timer.thread, NULL, pgs_log_terminal_timer_main, NULL) == 0 ? 1 : -1;
+        if (pgs_log_terminal_pending == 1)
+            pthread_cond_signal(&pgs_log_terminal_timer.work);
+    }
+    Pgs_Log_Error timer_err = pgs_log_terminal_timer.error;
+    pgs_log_terminal_timer.error = PGS_LOG_OK;
+#endif
+    PGS_LOG_TERMINAL_UNLOCK();
+
+#if PGS_LOG_TERMINAL_TIMER
+    if (timer_err != PGS_LOG_OK)
+        return pgs_log_set_last_error(timer_err, "Writing due terminal entries from the timer failed", 0);
+#endif
+    if (hold)
+        return pgs_log_set_last_error(PGS_LOG_OK, "Coalescing terminal output", 0);
+    return pgs_log_flush_terminals();
+}
+
+// the oldest coalesced terminal entry used up its budget
+static bool pgs_log_terminal_due(void) {
+    PGS_LOG_TERMINAL_LOCK();
+    bool due = pgs_log_terminal_pending > 0 && pgs_log_now_us() - pgs_log_terminal_since_us >= PGS_LOG_TERMINAL_COALESCE_US;
+    PGS_LOG_TERMINAL_UNLOCK();
+    return due;
+}
+#endif // PGS_LOG_TERMINAL_COALESCE
+
+static char pgs_log_cached_timestamp[PGS_LOG_MAX_TIMESTAMP_LEN];
+static time_t pgs_log_last_timestamp = 0;
+
+#if PGS_LOG_USE_DETAIL_ERROR
+static PGS_LOG_THREAD_LOCAL Pgs_Log_Error_Detail pgs_log_last_error = { .type = PGS_LOG_OK, .message = {0}, .errno_value = 0, };
+#else
+static PGS_LOG_THREAD_LOCAL Pgs_Log_Error_Detail pgs_log_last_error = { };
+#endif
+
+
+Pgs_Log_Error_Detail pgs_log_get_last_error(void) {
+    return pgs_log_last_error;
+}
+
+Pgs_Log_Error pgs_log_set_last_error(Pgs_Log_Error type, const char *msg, int errn) {
+#if PGS_LOG_USE_DETAIL_ERROR
+    pgs_log_last_error.type = type;
+    pgs_log_last_error.errno_value = errn;
+    if (errn != 0) {
+        snprintf(pgs_log_last_error.message, PGS_LOG_ERROR_MESSAGE_SIZE, "%s: %s", msg, strerror(errn));
+    } else {
+        strncpy(pgs_log_last_error.message, msg, PGS_LOG_ERROR_MESSAGE_SIZE - 1);
+        pgs_log_last_error.message[PGS_LOG_ERROR_MESSAGE_SIZE - 1] = '\0';
+    }
+#endif
+    (void)msg;
+    (void)errn;
+    return type;
+}
+
+#if PGS_LOG_ENABLE_FILE
+// formats `PGS_LOG_PATH` for `t` and picks append/override/numbered file, `mode` is the fopen mode to use
+// `name(number).ext` for number > 0, `name` itself for 0
+void pgs_log_numbered_filename(char *out, const char *name, int number) {
+    if (number == 0) {
+        snprintf(out, PGS_LOG_MAX_PATH_LEN, "%s", name);
+        return;
+    }
+
+    int file_ending_pos = pgs_log_get_last_occurence_of('.', name);
+    if (file_ending_pos == -1)
+        snprintf(out, PGS_LOG_MAX_PATH_LEN, "%s(%d)", name, number);
+    else
+        snprintf(out, PGS_LOG_MAX_PATH_LEN, "%.*s(%d)%s", file_ending_pos, name, number, name + file_ending_pos);
+}
+
+// `name` is the formatted `PGS_LOG_PATH`, `filename` gets the file to open, `name(number).ext` if numbered
+static Pgs_Log_Error pgs_log_resolve_log_file(time_t t, char *name, char *filename, int *number, const char **mode) {
+    struct tm *tm_info = localtime(&t);
+
+    if (strftime(name, PGS_LOG_MAX_PATH_LEN, PGS_LOG_PATH, tm_info) == 0) {
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to format log filename", 0);
+    }
+
+    if (pgs_log_create_dirs_for_path(name) != PGS_LOG_OK) {
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, pgs_log_temp_sprintf("Failed to create dirs for path %s", name), 0);
+    }
+
+    strcpy(filename, name);
+    *number = 0;
+    *mode = "w";
+
+    if (pgs_log_file_exists(filename)) {
+#if PGS_LOG_APPEND
+        *mode = "a";
+#elif PGS_LOG_OVERRIDE
+        *mode = "w";
+#else
+        while (pgs_log_file_exists(filename)) {
+            *number += 1;
+            if (*number >= PGS_LOG_MAX_FILENAME_NUMBER)
+                return pgs_log_set_last_error(PGS_LOG_ERR, "Too many log files with the same name exist, change `PGS_LOG_MAX_FILENAME_NUMBER` or fix ur config", errno);
+            pgs_log_numbered_filename(filename, name, *number);
+        }
+#endif
+    }
+
+    return pgs_log_set_last_error(PGS_LOG_OK, "Resolved log file", 0);
+}
+
+static FILE *pgs_log_file = NULL;                              // the stdio log file among the outputs
+#if PGS_LOG_SWITCHES_LOG_FILE
+static char pgs_log_file_name[PGS_LOG_MAX_PATH_LEN];            // formatted `PGS_LOG_PATH` it belongs to
+static int pgs_log_file_number = 0;
+static size_t pgs_log_file_bytes = 0;
+static time_t pgs_log_file_opened = 0;
+static int pgs_log_oldest_number = 0;                           // lowest number that may still exist, retention starts here
+
+static void pgs_log_track_log_file(FILE *file, const char *name, int number, time_t t) {
+    struct stat st;
+    pgs_log_file = file;
+    strcpy(pgs_log_file_name, name);
+    pgs_log_file_number = number;
+    pgs_log_file_bytes = fstat(fileno(file), &st) == 0 ? (size_t)st.st_size : 0;
+    pgs_log_file_opened = t;
+    pgs_log_oldest_number = 0;
+}
+
+#if PGS_LOG_ENABLE_ROTATION
+static FILE *pgs_log_standby_file = NULL;       // next file, opened ahead so the rotating log call only swaps
+static int pgs_log_standby_number = 0;
+
+static Pgs_Log_Error pgs_log_prepare_standby(void) {
+    if (pgs_log_standby_file) return PGS_LOG_OK;
+
+    // numbers wrap around at `PGS_LOG_MAX_FILENAME_NUMBER`, the first free one after the current file is taken,
+    // if every number is in use the one right after the current file (the oldest) gets overwritten
+    char filename[PGS_LOG_MAX_PATH_LEN];
+    int free_number = -1;
+    for (int i = 1; i < PGS_LOG_MAX_FILENAME_NUMBER && free_number < 0; ++i) {
+        int candidate = (pgs_log_file_number + i) % PGS_LOG_MAX_FILENAME_NUMBER;
+        pgs_log_numbered_filename(filename, pgs_log_file_name, candidate);
+        if (!pgs_log_file_exists(filename)) free_number = candidate;
+    }
+    int number = free_number >= 0 ? free_number : (pgs_log_file_number + 1) % PGS_LOG_MAX_FILENAME_NUMBER;
+    pgs_log_numbered_filename(filename, pgs_log_file_name, number);
+
+    pgs_log_standby_file = fopen(filename, "w");
+    if (!pgs_log_standby_file)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open next rotated log file", errno);
+
+    pgs_log_standby_number = number;
+    return PGS_LOG_OK;
+}
+#endif
+#endif
+
+#if PGS_LOG_DATE_ROLLOVER
+static bool pgs_log_rollover_pending = false;
+
+static void pgs_log_check_rollover(const struct tm *tm_info) {
+    char name[PGS_LOG_MAX_PATH_LEN];
+    if (pgs_log_file && strftime(name, sizeof(name), PGS_LOG_PATH, tm_info) > 0 && strcmp(name, pgs_log_file_name) != 0)
+        pgs_log_rollover_pending = true;
+}
+#endif
+
+static Pgs_Log_Error pgs_log_open_log_file(time_t t) {
+    char name[PGS_LOG_MAX_PATH_LEN];
+    char filename[PGS_LOG_MAX_PATH_LEN];
+    int number = 0;
+    const char *mode = "w";
+
+    Pgs_Log_Error err = pgs_log_resolve_log_file(t, name, filename, &number, &mode);
+    if (err != PGS_LOG_OK)
+        return err;
+
+#if PGS_LOG_FILE_MMAP
+    err = pgs_log_add_mmap_output(filename, mode[0] == 'a');
+    if (err != PGS_LOG_OK)
+        return err;
+#elif PGS_LOG_FILE_DIRECT
+    err = pgs_log_add_direct_output(filename, mode[0] == 'a');
+    if (err != PGS_LOG_OK)
+        return err;
+#elif PGS_LOG_FILE_SEGMENTS
+    // the segments get reused, numbering/append do not apply
+    err = pgs_log_add_segment_output(name);
+    if (err != PGS_LOG_OK)
+        return err;
+#else
+    FILE *log_file = fopen(filename, mode);
+
+    if (!log_file) {
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open log file", errno);
+    }
+
+    if (pgs_log_add_fd_output(log_file) != PGS_LOG_OK) {
+        fclose(log_file);
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Failed to add log file to file descriptors", 0);
+    }
+
+#if PGS_LOG_SWITCHES_LOG_FILE
+    pgs_log_track_log_file(log_file, name, number, t);
+#if PGS_LOG_ENABLE_ROTATION
+    // the log call crossing a limit only swaps files, so the first standby gets opened here, a failure is
+    // retried and reported by the next flush
+    pgs_log_prepare_standby();
+#endif
+#else
+    pgs_log_file = log_file;
+#endif
+#endif
+
+    return pgs_log_set_last_error(PGS_LOG_OK, "Opened log file", 0);
+}
+#endif // PGS_LOG_ENABLE_FILE
+
+Pgs_Log_Error pgs_log_init_if_needed() {
+    if (!pgs_log_initialized) {
+        signal(SIGINT, sigint_handler);
+#if PGS_LOG_ENABLE_STDOUT
+        Pgs_Log_Error stdout_err = PGS_LOG_ERR;
+#if PGS_LOG_STDOUT_VMSPLICE
+        // a supervisor reading stdout through a pipe gets whole buffers gifted
+        if (pgs_log_fd_is_pipe(fileno(stdout))) {
+            fflush(stdout);
+            stdout_err = pgs_log_add_pipe_output(fileno(stdout), false);
+        }
+#endif
+        if (stdout_err != PGS_LOG_OK && pgs_log_add_fd_output(stdout) != PGS_LOG_OK)
+            return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to add STDOUT as output", 0);
+#endif
+#if PGS_LOG_ENABLE_FILE
+        Pgs_Log_Error err = pgs_log_open_log_file(time(NULL));
+        if (err != PGS_LOG_OK)
+            return err;
+#endif
+        pgs_log_initialized = true;
+        atexit(pgs_log_cleanup);
+    }
+
+    return pgs_log_set_last_error(PGS_LOG_OK, "Initialized logging", 0);
+}
+
+static const char *pgs_log_level_color(Pgs_Log_Level level) {
+    switch (level) {
+        case PGS_LOG_DEBUG: return "\x1b[36m";
+        case PGS_LOG_INFO: return "\x1b[32m";
+        case PGS_LOG_WARN: return "\x1b[33m";
+        case PGS_LOG_ERROR: return "\x1b[31m";
+        case PGS_LOG_FATAL: return "\x1b[1;31m";
+        default: return "";
+    }
+}
+
+static size_t pgs_log_format_entry(const char *format, char *log_string, Pgs_Log_Level level, const char *file, size_t file_len, const char *line, size_t line_len, const char *msg, size_t msg_len, const char *timestamp) {
+    size_t pos = 0;
+
+    while (*format && pos < PGS_LOG_MAX_ENTRY_LEN - 1) {
+        if (*format == '%' && *(format +1)) {
+            switch (*(format + 1)) {
+                case 'L':
+                    const char *lvl = pgs_log_level_to_string(level);
+                    size_t lvl_length = strlen(lvl);
+                    if (pos + lvl_length >= PGS_LOG_MAX_ENTRY_LEN -1) break;
+                    memcpy(log_string + pos, lvl, lvl_length);
+                    pos += lvl_length;
+                    break;
+                case 'T':
+                    if (!timestamp) timestamp = pgs_log_timestamp_string();  // If used more than once per log is less efficient but this way we have most improvement if not used
+                    size_t timestamp_length = strlen(timestamp);             // If used more than once per log is less efficient but this way we have most improvement if not used
+                    if (pos + timestamp_length >= PGS_LOG_MAX_ENTRY_LEN -1) break;
+                    memcpy(log_string + pos, timestamp, timestamp_length);
+                    pos += timestamp_length;
+                    break;
+                case 'F':
+                    if (pos + file_len >= PGS_LOG_MAX_ENTRY_LEN -1) break;
+                    memcpy(log_string + pos, file, file_len);
+                    pos += file_len;
+                    break;
+                case 'l':
+                    if (pos + line_len >= PGS_LOG_MAX_ENTRY_LEN -1) break;
+                    memcpy(log_string + pos, line, line_len);
+                    pos += line_len;
+                    break;
+                case 'M':
+                    // cut instead of left out, whatever comes after it in the format is lost too
+                    if (pos + msg_len >= PGS_LOG_MAX_ENTRY_LEN -1) msg_len = PGS_LOG_MAX_ENTRY_LEN - 2 - pos;
+                    memcpy(log_string + pos, msg, msg_len);
+                    pos += msg_len;
+                    break;
+                case 'C':
+                case 'R':
+                    const char *color = format[1] == 'C' ? pgs_log_level_color(level) : "\x1b[0m";
+                    size_t color_length = strlen(color);
+                    if (pos + color_length >= PGS_LOG_MAX_ENTRY_LEN -1) break;
+                    memcpy(log_string + pos, color, color_length);
+                    pos += color_length;
+                    break;
+                default:
+                    if (pos < PGS_LOG_MAX_ENTRY_LEN - 1) log_string[pos++] = format[0];
+                    if (pos < PGS_LOG_MAX_ENTRY_LEN - 1) log_string[pos++] = format[1];
+                    break;
+            }
+            format += 2;
+        } else {
+            log_string[pos++] = *format++;
+        }
+    }
+
+    if (pos > PGS_LOG_MAX_ENTRY_LEN - 2) pos = PGS_LOG_MAX_ENTRY_LEN - 2;
+    log_string[pos++] = '\n';
+    log_string[pos] = '\0';
+
+    return pos;
+}
+
+// byte outputs get the formatted entry, outputs framing entries on their own get the parts
+#if PGS_LOG_ENABLE_OUTPUT_FORMATS || PGS_LOG_ENABLE_SYSLOG_OUTPUT
+// the entry pgs_log_write_entry() is writing, outputs with their own format render their line from it
+static struct {
+    bool active;
+    Pgs_Log_Level level;
+    const char *file;
+    size_t file_len;
+    const char *line;
+    size_t line_len;
+    const char *msg;
+    size_t msg_len;
+    const char *timestamp;
+#if PGS_LOG_ENABLE_OUTPUT_FORMATS
+    size_t lens[PGS_LOG_MAX_OUTPUT_FORMATS];                        // 0 until rendered for this entry
+    char lines[PGS_LOG_MAX_OUTPUT_FORMATS][PGS_LOG_MAX_ENTRY_LEN];
+#endif
+} pgs_log_entry;
+#endif
+
+#if PGS_LOG_ENABLE_OUTPUT_FORMATS
+
+static char pgs_log_formats[PGS_LOG_MAX_OUTPUT_FORMATS][PGS_LOG_MAX_FORMAT_LEN];  // "" while no output uses it
+
+static bool pgs_log_output_accepts(const Pgs_Log_Output *o) {
+    return !pgs_log_entry.active || pgs_log_entry.level >= o->min_level;
+}
+
+// raw pgs_log_write_output() strings go out as they are
+static const char *pgs_log_output_line(const Pgs_Log_Output *o, const char *str, size_t *len) {
+    if (!pgs_log_entry.active || o->format == 0) return str;
+
+    int f = o->format - 1;
+    if (pgs_log_entry.lens[f] == 0) {
+        pgs_log_entry.lens[f] = pgs_log_format_entry(pgs_log_formats[f], pgs_log_entry.lines[f], pgs_log_entry.level,
+            pgs_log_entry.file, pgs_log_entry.file_len, pgs_log_entry.line, pgs_log_entry.line_len,
+            pgs_log_entry.msg, pgs_log_entry.msg_len, pgs_log_entry.timestamp);
+    }
+    *len = pgs_log_entry.lens[f];
+    return pgs_log_entry.lines[f];
+}
+
+#endif // PGS_LOG_ENABLE_OUTPUT_FORMATS
+
+#if PGS_LOG_ENABLE_SYSLOG_OUTPUT
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// glibc only declares sendmmsg() and `struct mmsghdr` with `_GNU_SOURCE`, the syscall works without it
+#ifdef __linux__
+#   include <sys/syscall.h>
+#endif
+#if PGS_LOG_SYSLOG_SENDMMSG && defined(__linux__) && defined(SYS_sendmmsg)
+#   define PGS_LOG_HAS_SENDMMSG true
+typedef struct {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+} Pgs_Log_Mmsghdr;
+#else
+#   define PGS_LOG_HAS_SENDMMSG false
+#endif
+
+#ifdef MSG_NOSIGNAL
+#   define PGS_LOG_SEND_FLAGS MSG_NOSIGNAL
+#else
+#   define PGS_LOG_SEND_FLAGS 0
+#endif
+
+static Pgs_Log_Syslog_Output pgs_syslog_outputs[PGS_LOG_MAX_SYSLOG_OUTPUTS];
+
+static int pgs_log_syslog_severity(Pgs_Log_Level level) {
+    switch (level) {
+        case PGS_LOG_DEBUG: return 7;
+        case PGS_LOG_INFO: return 6;
+        case PGS_LOG_WARN: return 4;
+        case PGS_LOG_ERROR: return 3;
+        case PGS_LOG_FATAL: return 2;
+        default: return 5;
+    }
+}
+
+static Pgs_Log_Error pgs_log_syslog_connect(Pgs_Log_Syslog_Output *s) {
+    if (s->fd >= 0) close(s->fd);
+
+    s->fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (s->fd < 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to create syslog socket", errno);
+    fcntl(s->fd, F_SETFD, FD_CLOEXEC);
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, s->path);
+
+    if (connect(s->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        int connect_err = errno;
+        close(s->fd);
+        s->fd = -1;
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to connect to syslog socket", connect_err);
+    }
+
+    return PGS_LOG_OK;
+}
+
+// sends datagrams starting at `first`, returns how many went out or -1 with errno set
+static int pgs_log_syslog_send_some(Pgs_Log_Syslog_Output *s, int first, size_t off) {
+#if PGS_LOG_HAS_SENDMMSG
+    Pgs_Log_Mmsghdr msgs[PGS_LOG_SYSLOG_BATCH];
+    struct iovec iovs[PGS_LOG_SYSLOG_BATCH];
+    int n = s->count - first;
+    memset(msgs, 0, sizeof(msgs[0]) * (size_t)n);
+    for (int i = 0; i < n; ++i) {
+        iovs[i].iov_base = s->buffer + off;
+        iovs[i].iov_len = s->lens[first + i];
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        off += s->lens[first + i];
+    }
+    return (int)syscall(SYS_sendmmsg, s->fd, msgs, (unsigned int)n, PGS_LOG_SEND_FLAGS);
+#else
+    return send(s->fd, s->buffer + off, s->lens[first], PGS_LOG_SEND_FLAGS) < 0 ? -1 : 1;
+#endif
+}
+
+static Pgs_Log_Error pgs_log_syslog_output_send(Pgs_Log_Syslog_Output *s) {
+    Pgs_Log_Error result = PGS_LOG_OK;
+    bool reconnected = false;
+    size_t off = 0;
+    int sent = 0;
+
+    while (sent < s->count) {
+        int n = s->fd >= 0 ? pgs_log_syslog_send_some(s, sent, off) : -1;
+        if (n < 0 && s->fd < 0) errno = ENOTCONN;
+        if (n > 0) {
+            for (int i = 0; i < n; ++i) off += s->lens[sent + i];
+            sent += n;
+            continue;
+        }
+
+        int send_err = errno;
+        if (send_err == EINTR) continue;
+
+        // the daemon restarted (or the socket is not there yet), try a fresh connection once per batch
+        if (!reconnected && (send_err == ECONNREFUSED || send_err == ENOENT || send_err == ENOTCONN || send_err == EBADF || send_err == EPIPE)) {
+            reconnected = true;
+            if (pgs_log_syslog_connect(s) == PGS_LOG_OK) continue;
+        }
+
+        if (send_err == EMSGSIZE) {
+            // only this datagram is too large for the socket, keep going with the rest
+            off += s->lens[sent++];
+            s->dropped++;
+            result = pgs_log_set_last_error(PGS_LOG_ERR_IO, "Syslog datagram too large, dropped", send_err);
+            continue;
+        }
+
+        s->dropped += (uint64_t)(s->count - sent);
+        result = pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to send to syslog socket, dropped batch", send_err);
+        break;
+    }
+
+    s->count = 0;
+    s->buf_pos = 0;
+    return result;
+}
+
+static size_t pgs_log_syslog_frame_rfc5424(Pgs_Log_Syslog_Output *s, char *out, size_t cap, Pgs_Log_Level level, const char *msg, size_t msg_len) {
+    struct timespec ts;
+    struct tm tm_info;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    gmtime_r(&ts.tv_sec, &tm_info);
+
+    char timestamp[32];
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &tm_info);
+
+    int n = snprintf(out, cap, "<%d>1 %s.%06ldZ %s %s %d - - ",
+                     PGS_LOG_SYSLOG_FACILITY * 8 + pgs_log_syslog_severity(level), timestamp, ts.tv_nsec / 1000,
+                     s->hostname, s->ident[0] ? s->ident : "-", s->pid);
+    memcpy(out + n, msg, msg_len);
+    return (size_t)n + msg_len;
+}
+
+static size_t pgs_log_syslog_frame_journald(Pgs_Log_Syslog_Output *s, char *out, size_t cap, Pgs_Log_Level level, const char *file, size_t file_len, const char *line, size_t line_len, const char *msg, size_t msg_len) {
+    int n = snprintf(out, cap, "PRIORITY=%d\nSYSLOG_FACILITY=%d\nSYSLOG_PID=%d\nCODE_FILE=%.*s\nCODE_LINE=%.*s\n",
+                     pgs_log_syslog_severity(level), PGS_LOG_SYSLOG_FACILITY, s->pid, (int)file_len, file, (int)line_len, line);
+    size_t pos = (size_t)n;
+    if (s->ident[0])
+        pos += (size_t)snprintf(out + pos, cap - pos, "SYSLOG_IDENTIFIER=%s\n", s->ident);
+
+    if (memchr(msg, '\n', msg_len)) {
+        // values with newlines use the binary form, name, newline, little endian 64 bit length, data
+        memcpy(out + pos, "MESSAGE\n", 8);
+        pos += 8;
+        uint64_t len = msg_len;
+        for (int i = 0; i < 8; ++i) out[pos++] = (char)((len >> (8 * i)) & 0xff);
+    } else {
+        memcpy(out + pos, "MESSAGE=", 8);
+        pos += 8;
+    }
+    memcpy(out + pos, msg, msg_len);
+    pos += msg_len;
+    out[pos++] = '\n';
+    return pos;
+}
+
+static Pgs_Log_Error pgs_log_syslog_output_write(Pgs_Log_Syslog_Output *s, Pgs_Log_Level level, const char *file, size_t file_len, const char *line, size_t line_len, const char *msg, size_t msg_len) {
+    // upper bound of the framing around the message, checked before anything gets written
+    size_t needed = 256 + sizeof(s->ident) + sizeof(s->hostname) + file_len + line_len + msg_len;
+    if (needed > PGS_LOG_SYSLOG_BUFFER_SIZE)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Log entry too large for `PGS_LOG_SYSLOG_BUFFER_SIZE`", 0);
+
+    if (s->count == PGS_LOG_SYSLOG_BATCH || s->buf_pos + needed > PGS_LOG_SYSLOG_BUFFER_SIZE) {
+        Pgs_Log_Error err = pgs_log_syslog_output_send(s);
+        if (err != PGS_LOG_OK) {
+            // the entry that needed the room never gets framed, it is lost with the batch
+            s->dropped++;
+            return err;
+        }
+    }
+
+    char *out = s->buffer + s->buf_pos;
+    size_t cap = PGS_LOG_SYSLOG_BUFFER_SIZE - s->buf_pos;
+    size_t len = s->format == PGS_LOG_SYSLOG_JOURNALD
+        ? pgs_log_syslog_frame_journald(s, out, cap, level, file, file_len, line, line_len, msg, msg_len)
+        : pgs_log_syslog_frame_rfc5424(s, out, cap, level, msg, msg_len);
+
+    s->lens[s->count++] = len;
+    s->buf_pos += len;
+    return PGS_LOG_OK;
+}
+
+// syslog frames the parts of the entry itself, raw pgs_log_write_output() strings are no entries and skip it
+static Pgs_Log_Error pgs_log_syslog_sink_write(void *ctx, const char *data, size_t len) {
+    (void)data;
+    (void)len;
+    if (!pgs_log_entry.active) return PGS_LOG_OK;
+
+    return pgs_log_syslog_output_write((Pgs_Log_Syslog_Output *)ctx, pgs_log_entry.level, pgs_log_entry.file,
+        pgs_log_entry.file_len, pgs_log_entry.line, pgs_log_entry.line_len, pgs_log_entry.msg, pgs_log_entry.msg_len);
+}
+
+static Pgs_Log_Error pgs_log_syslog_sink_flush(void *ctx) {
+    return pgs_log_syslog_output_send((Pgs_Log_Syslog_Output *)ctx);
+}
+
+static void pgs_log_syslog_sink_close(void *ctx) {
+    Pgs_Log_Syslog_Output *s = (Pgs_Log_Syslog_Output *)ctx;
+    if (s->fd >= 0) close(s->fd);
+    s->fd = -1;
+    s->in_use = false;
+}
+
+Pgs_Log_Error pgs_log_add_syslog_output(const char *socket_path, Pgs_Log_Syslog_Format format, const char *ident) {
+    if (!socket_path)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No socket path passed to add to output", 0);
+
+    Pgs_Log_Syslog_Output *s = NULL;
+    for (int i = 0; i < PGS_LOG_MAX_SYSLOG_OUTPUTS && !s; ++i) {
+        if (!pgs_syslog_outputs[i].in_use) s = &pgs_syslog_outputs[i];
+    }
+    if (!s)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Reached max syslog output count, you can add `#define PGS_LOG_MAX_SYSLOG_OUTPUTS` and increase the number and recompile", 0);
+
+    struct sockaddr_un addr;
+    if (strlen(socket_path) >= sizeof(addr.sun_path) || (ident && strlen(ident) >= sizeof(s->ident)))
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Socket path or ident too long", 0);
+
+    s->fd = -1;
+    strcpy(s->path, socket_path);
+    s->format = format;
+    strcpy(s->ident, ident ? ident : "");
+    if (gethostname(s->hostname, sizeof(s->hostname)) != 0 || s->hostname[0] == '\0')
+        strcpy(s->hostname, "-");
+    s->hostname[sizeof(s->hostname) - 1] = '\0';
+    s->pid = (int)getpid();
+    s->buf_pos = 0;
+    s->count = 0;
+    s->dropped = 0;
+
+    Pgs_Log_Error err = pgs_log_syslog_connect(s);
+    if (err != PGS_LOG_OK)
+        return err;
+
+    s->in_use = true;
+    Pgs_Log_Sink sink = { .write = pgs_log_syslog_sink_write, .flush = pgs_log_syslog_sink_flush, .close = pgs_log_syslog_sink_close, .unbuffered = true };
+    err = pgs_log_add_sink_output(sink, s);
+    if (err != PGS_LOG_OK) {
+        pgs_log_syslog_sink_close(s);
+        return err;
+    }
+    return pgs_log_set_last_error(PGS_LOG_OK, "Added syslog output", 0);
+}
+
+Pgs_Log_Error pgs_log_remove_syslog_output(const char *socket_path) {
+    if (!socket_path)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No socket path passed", 0);
+
+    for (int i = 0; i < PGS_LOG_MAX_SYSLOG_OUTPUTS; ++i) {
+        if (pgs_syslog_outputs[i].in_use && strcmp(pgs_syslog_outputs[i].path, socket_path) == 0)
+            return pgs_log_remove_sink_output(&pgs_syslog_outputs[i]);
+    }
+
+    return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "socket path does not exist in syslog outputs", 0);
+}
+
+#endif // PGS_LOG_ENABLE_SYSLOG_OUTPUT
+
+
+static Pgs_Log_Error pgs_log_write_entry(Pgs_Log_Level level, const char *file, size_t file_len, const char *line, size_t line_len, const char *msg, size_t msg_len, const char *timestamp, const char *str, size_t len) {
+#if PGS_LOG_ENABLE_OUTPUT_FORMATS || PGS_LOG_ENABLE_SYSLOG_OUTPUT
+    pgs_log_entry.active = true;
+    pgs_log_entry.level = level;
+    pgs_log_entry.file = file;
+    pgs_log_entry.file_len = file_len;
+    pgs_log_entry.line = line;
+    pgs_log_entry.line_len = line_len;
+    pgs_log_entry.msg = msg;
+    pgs_log_entry.msg_len = msg_len < PGS_LOG_MAX_ENTRY_LEN - 1 ? msg_len : PGS_LOG_MAX_ENTRY_LEN - 1;
+    pgs_log_entry.timestamp = timestamp;
+#if PGS_LOG_ENABLE_OUTPUT_FORMATS
+    memset(pgs_log_entry.lens, 0, sizeof(pgs_log_entry.lens));
+#endif
+    Pgs_Log_Error err = pgs_log_write_output(str, len);
+    pgs_log_entry.active = false;
+#else
+    (void)level; (void)file; (void)file_len; (void)line; (void)line_len; (void)msg; (void)msg_len; (void)timestamp;
+    Pgs_Log_Error err = pgs_log_write_output(str, len);
+#endif
+    return err;
+}
+
+#if PGS_LOG_ENABLE_BACKLOG
+
+/*
+ * Backlog entries store the format pointer plus the raw argument values, format strings passed
+ * to the macros are literals so the pointer stays valid, `%s` arguments are copied since they may not.
+ * If the arguments dont fit into `PGS_LOG_BACKLOG_ARG_BYTES` (or use something we cant capture like `%ls`)
+ * the message gets formatted right away instead.
+ */
+
+typedef enum {
+    PGS_LOG_ARG_NONE,
+    PGS_LOG_ARG_INT,
+    PGS_LOG_ARG_LONG,
+    PGS_LOG_ARG_LLONG,
+    PGS_LOG_ARG_UINT,
+    PGS_LOG_ARG_ULONG,
+    PGS_LOG_ARG_ULLONG,
+    PGS_LOG_ARG_SIZE,
+    PGS_LOG_ARG_PTRDIFF,
+    PGS_LOG_ARG_INTMAX,
+    PGS_LOG_ARG_UINTMAX,
+    PGS_LOG_ARG_DOUBLE,
+    PGS_LOG_ARG_LDOUBLE,
+    PGS_LOG_ARG_STRING,
+    PGS_LOG_ARG_POINTER,
+    PGS_LOG_ARG_UNSUPPORTED,
+} Pgs_Log_Arg_Type;
+
+typedef struct {
+    Pgs_Log_Arg_Type type;
+    int stars;
+    int precision;                  // -1 without `.`, also -1 for `.*` where the last star holds it
+    bool precision_star;
+    size_t len;
+} Pgs_Log_Format_Spec;
+
+typedef struct {
+    Pgs_Log_Level level;
+    const char *file;
+    size_t file_len;
+    const char *line;
+    size_t line_len;
+    const char *fmt;
+    time_t time;
+    bool preformatted;
+    size_t args_len;
+    unsigned char args[PGS_LOG_BACKLOG_ARG_BYTES];
+} Pgs_Log_Backlog_Entry;
+
+typedef struct {
+    Pgs_Log_Backlog_Entry entries[PGS_LOG_BACKLOG_ENTRIES];
+    size_t head;
+    size_t count;
+} Pgs_Log_Backlog;
+
+static PGS_LOG_THREAD_LOCAL Pgs_Log_Backlog pgs_log_backlog;
+
+// parses the conversion spec starting at the `%`, fmt[0] must be '%' and fmt[1] not '%'
+static void pgs_log_parse_format_spec(const char *fmt, Pgs_Log_Format_Spec *spec) {
+    const char *p = fmt + 1;
+    int length = 0; // 1 = h, 2 = hh, 3 = l, 4 = ll, 5 = j, 6 = z, 7 = t, 8 = L
+    spec->stars = 0;
+    spec->precision = -1;
+    spec->precision_star = false;
+
+    while (*p && strchr("-+ #0'", *p)) p++;
+    if (*p == '*') { spec->stars++; p++; }
+    while (isdigit((unsigned char)*p)) p++;
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->stars++;
+            spec->precision_star = true;
+            p++;
+        } else {
+            spec->precision = 0;
+            while (isdigit((unsigned char)*p)) spec->precision = spec->precision * 10 + (*p++ - '0');
+        }
+    }
+
+    switch (*p) {
+        case 'h': length = 1; p++; if (*p == 'h') { length = 2; p++; } break;
+        case 'l': length = 3; p++; if (*p == 'l') { length = 4; p++; } break;
+        case 'q': length = 4; p++; break;
+        case 'j': length = 5; p++; break;
+        case 'z': length = 6; p++; break;
+        case 't': length = 7; p++; break;
+        case 'L': length = 8; p++; break;
+    }
+
+    switch (*p) {
+        case 'd': case 'i':
+            spec->type = length == 3 ? PGS_LOG_ARG_LONG : length == 4 ? PGS_LOG_ARG_LLONG : length == 5 ? PGS_LOG_ARG_INTMAX
+                       : length == 6 ? PGS_LOG_ARG_SIZE : length == 7 ? PGS_LOG_ARG_PTRDIFF : PGS_LOG_ARG_INT;
+            break;
+        case 'o': case 'u': case 'x': case 'X':
+            spec->type = length == 3 ? PGS_LOG_ARG_ULONG : length == 4 ? PGS_LOG_ARG_ULLONG : length == 5 ? PGS_LOG_ARG_UINTMAX
+                       : length == 6 ? PGS_LOG_ARG_SIZE : length == 7 ? PGS_LOG_ARG_PTRDIFF : PGS_LOG_ARG_UINT;
+            break;
+        case 'c':
+            spec->type = length == 3 ? PGS_LOG_ARG_UNSUPPORTED : PGS_LOG_ARG_INT;
+            break;
+        case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+            spec->type = length == 8 ? PGS_LOG_ARG_LDOUBLE : PGS_LOG_ARG_DOUBLE;
+            break;
+        case 's':
+            spec->type = length == 3 ? PGS_LOG_ARG_UNSUPPORTED : PGS_LOG_ARG_STRING;
+            break;
+        case 'p':
+            spec->type = PGS_LOG_ARG_POINTER;
+            break;
+        case 'n':
+            spec->type = PGS_LOG_ARG_NONE;
+            break;
+        default:
+            spec->type = PGS_LOG_ARG_UNSUPPORTED;
+            break;
+    }
+
+    if (*p) p++;
+    spec->len = (size_t)(p - fmt);
+}
+
+#define PGS_LOG_BACKLOG_PUSH(type, value)                                   \
+    do {                                                                    \
+        type pgs_v_ = (value);                                              \
+        if (e->args_len + sizeof(type) > PGS_LOG_BACKLOG_ARG_BYTES)         \
+            goto preformat;                                                 \
+        memcpy(e->args + e->args_len, &pgs_v_, sizeof(type));               \
+        e->args_len += sizeof(type);                                        \
+    } while (0)
+
+static void pgs_log_backlog_capture(Pgs_Log_Level level, const char *file, size_t file_len, const char *line, size_t line_len, const char *fmt, va_list ap) {
+    Pgs_Log_Backlog *b = &pgs_log_backlog;
+    Pgs_Log_Backlog_Entry *e = &b->entries[b->head];
+    b->head = (b->head + 1) % PGS_LOG_BACKLOG_ENTRIES;
+    if (b->count < PGS_LOG_BACKLOG_ENTRIES) b->count++;
+
+    e->level = level;
+    e->file = file;
+    e->file_len = file_len;
+    e->line = line;
+    e->line_len = line_len;
+    e->fmt = fmt;
+    e->time = time(NULL);
+    e->preformatted = false;
+    e->args_len = 0;
+
+    va_list cp;
+    va_copy(cp, ap);
+
+    for (const char *p = fmt; *p; ++p) {
+        if (*p != '%') continue;
+        if (p[1] == '%') { p++; continue; }
+
+        Pgs_Log_Format_Spec spec;
+        pgs_log_parse_format_spec(p, &spec);
+        p += spec.len - 1;
+
+        int star = 0;
+        for (int i = 0; i < spec.stars; ++i) {
+            star = va_arg(cp, int);
+            PGS_LOG_BACKLOG_PUSH(int, star);
+        }
+        // a negative `.*` counts as no precision, like in printf
+        int precision = spec.precision_star ? (star < 0 ? -1 : star) : spec.precision;
+
+        switch (spec.type) {
+            case PGS_LOG_ARG_NONE:     (void)va_arg(cp, void *); break;
+            case PGS_LOG_ARG_INT:      PGS_LOG_BACKLOG_PUSH(int, va_arg(cp, int)); break;
+            case PGS_LOG_ARG_LONG:     PGS_LOG_BACKLOG_PUSH(long, va_arg(cp, long)); break;
+            case PGS_LOG_ARG_LLONG:    PGS_LOG_BACKLOG_PUSH(long long, va_arg(cp, long long)); break;
+            case PGS_LOG_ARG_UINT:     PGS_LOG_BACKLOG_PUSH(unsigned int, va_arg(cp, unsigned int)); break;
+            case PGS_LOG_ARG_ULONG:    PGS_LOG_BACKLOG_PUSH(unsigned long, va_arg(cp, unsigned long)); break;
+            case PGS_LOG_ARG_ULLONG:   PGS_LOG_BACKLOG_PUSH(unsigned long long, va_arg(cp, unsigned long long)); break;
+            case PGS_LOG_ARG_SIZE:     PGS_LOG_BACKLOG_PUSH(size_t, va_arg(cp, size_t)); break;
+            case PGS_LOG_ARG_PTRDIFF:  PGS_LOG_BACKLOG_PUSH(ptrdiff_t, va_arg(cp, ptrdiff_t)); break;
+            case PGS_LOG_ARG_INTMAX:   PGS_LOG_BACKLOG_PUSH(intmax_t, va_arg(cp, intmax_t)); break;
+            case PGS_LOG_ARG_UINTMAX:  PGS_LOG_BACKLOG_PUSH(uintmax_t, va_arg(cp, uintmax_t)); break;
+            case PGS_LOG_ARG_DOUBLE:   PGS_LOG_BACKLOG_PUSH(double, va_arg(cp, double)); break;
+            case PGS_LOG_ARG_LDOUBLE:  PGS_LOG_BACKLOG_PUSH(long double, va_arg(cp, long double)); break;
+            case PGS_LOG_ARG_POINTER:  PGS_LOG_BACKLOG_PUSH(void *, va_arg(cp, void *)); break;
+            case PGS_LOG_ARG_STRING: {
+                const char *str = va_arg(cp, const char *);
+                if (!str) str = "(null)";
+                // with a precision the string does not have to be NUL terminated, printf reads at most that many bytes
+                size_t str_len = precision >= 0 ? strnlen(str, (size_t)precision) : strlen(str);
+                if (e->args_len + str_len + 1 > PGS_LOG_BACKLOG_ARG_BYTES)
+                    goto preformat;
+                memcpy(e->args + e->args_len, str, str_len);
+                e->args[e->args_len + str_len] = '\0';
+                e->args_len += str_len + 1;
+            } break;
+            case PGS_LOG_ARG_UNSUPPORTED:
+                goto preformat;
+        }
+    }
+
+    va_end(cp);
+    return;
+
+preformat:
+    va_end(cp);
+    e->preformatted = true;
+    int len = vsnprintf((char *)e->args, PGS_LOG_BACKLOG_ARG_BYTES, fmt, ap);
+    e->args_len = len < 0 ? 0 : (size_t)len >= PGS_LOG_BACKLOG_ARG_BYTES ? PGS_LOG_BACKLOG_ARG_BYTES - 1 : (size_t)len;
+}
+
+#define PGS_LOG_BACKLOG_POP(type, out)                                      \
+    do {                                                                    \
+        memcpy(&(out), e->args + args_pos, sizeof(type));                   \
+        args_pos += sizeof(type);                                           \
+    } while (0)
+
+#define PGS_LOG_BACKLOG_RENDER(type)                                                                        \
+    do {                                                                                                    \
+        type pgs_v_;                                                                                        \
+        PGS_LOG_BACKLOG_POP(type, pgs_v_);                                                                  \
+        written = spec.stars == 0 ? snprintf(msg + pos, cap, spec_str, pgs_v_)                              \
+                : spec.stars == 1 ? snprintf(msg + pos, cap, spec_str, stars[0], pgs_v_)                    \
+                :                   snprintf(msg + pos, cap, spec_str, stars[0], stars[1], pgs_v_);         \
+    } while (0)
+
+static size_t pgs_log_backlog_render(const Pgs_Log_Backlog_Entry *e, char *msg) {
+    if (e->preformatted) {
+        memcpy(msg, e->args, e->args_len);
+        msg[e->args_len] = '\0';
+        return e->args_len;
+    }
+
+    size_t pos = 0;
+    size_t args_pos = 0;
+
+    for (const char *p = e->fmt; *p && pos < PGS_LOG_MAX_ENTRY_LEN - 1; ++p) {
+        if (*p != '%') {
+            msg[pos++] = *p;
+            continue;
+        }
+        if (p[1] == '%') {
+            msg[pos++] = '%';
+            p++;
+            continue;
+        }
+
+        Pgs_Log_Format_Spec spec;
+        pgs_log_parse_format_spec(p, &spec);
+
+        char spec_str[32];
+        if (spec.len >= sizeof(spec_str)) break;
+        memcpy(spec_str, p, spec.len);
+        spec_str[spec.len] = '\0';
+        p += spec.len - 1;
+
+        int stars[2] = {0};
+        for (int i = 0; i < spec.stars; ++i) PGS_LOG_BACKLOG_POP(int, stars[i]);
+
+        size_t cap = PGS_LOG_MAX_ENTRY_LEN - pos;
+        int written = 0;
+        switch (spec.type) {
+            case PGS_LOG_ARG_NONE:         break;
+            case PGS_LOG_ARG_INT:          PGS_LOG_BACKLOG_RENDER(int); break;
+            case PGS_LOG_ARG_LONG:         PGS_LOG_BACKLOG_RENDER(long); break;
+            case PGS_LOG_ARG_LLONG:        PGS_LOG_BACKLOG_RENDER(long long); break;
+            case PGS_LOG_ARG_UINT:         PGS_LOG_BACKLOG_RENDER(unsigned int); break;
+            case PGS_LOG_ARG_ULONG:        PGS_LOG_BACKLOG_RENDER(unsigned long); break;
+            case PGS_LOG_ARG_ULLONG:       PGS_LOG_BACKLOG_RENDER(unsigned long long); break;
+            case PGS_LOG_ARG_SIZE:         PGS_LOG_BACKLOG_RENDER(size_t); break;
+            case PGS_LOG_ARG_PTRDIFF:      PGS_LOG_BACKLOG_RENDER(ptrdiff_t); break;
+            case PGS_LOG_ARG_INTMAX:       PGS_LOG_BACKLOG_RENDER(intmax_t); break;
+            case PGS_LOG_ARG_UINTMAX:      PGS_LOG_BACKLOG_RENDER(uintmax_t); break;
+            case PGS_LOG_ARG_DOUBLE:       PGS_LOG_BACKLOG_RENDER(double); break;
+            case PGS_LOG_ARG_LDOUBLE:      PGS_LOG_BACKLOG_RENDER(long double); break;
+            case PGS_LOG_ARG_POINTER:      PGS_LOG_BACKLOG_RENDER(void *); break;
+            case PGS_LOG_ARG_STRING: {
+                const char *str = (const char *)e->args + args_pos;
+                args_pos += strlen(str) + 1;
+                written = spec.stars == 0 ? snprintf(msg + pos, cap, spec_str, str)
+                        : spec.stars == 1 ? snprintf(msg + pos, cap, spec_str, stars[0], str)
+                        :                   snprintf(msg + pos, cap, spec_str, stars[0], stars[1], str);
+            } break;
+            case PGS_LOG_ARG_UNSUPPORTED:  break; // never captured, those are preformatted
+        }
+
+        if (written < 0) written = 0;
+        pos += (size_t)written >= cap ? cap - 1 : (size_t)written;
+    }
+
+    msg[pos] = '\0';
+    return pos;
+}
+
+Pgs_Log_Error pgs_log_backlog_flush(void) {
+    Pgs_Log_Backlog *b = &pgs_log_backlog;
+    size_t start = (b->head + PGS_LOG_BACKLOG_ENTRIES - b->count) % PGS_LOG_BACKLOG_ENTRIES;
+    size_t count = b->count;
+    b->count = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        const Pgs_Log_Backlog_Entry *e = &b->entries[(start + i) % PGS_LOG_BACKLOG_ENTRIES];
+
+        char msg[PGS_LOG_MAX_ENTRY_LEN];
+        size_t msg_len = pgs_log_backlog_render(e, msg);
+
+        char timestamp[PGS_LOG_MAX_TIMESTAMP_LEN];
+        struct tm *tm_info = localtime(&e->time);
+        if (!tm_info || strftime(timestamp, PGS_LOG_MAX_TIMESTAMP_LEN, PGS_LOG_TIMESTAMP_FORMAT, tm_info) == 0)
+            timestamp[0] = '\0';
+
+        char log_string[PGS_LOG_MAX_ENTRY_LEN];
+        size_t pos = pgs_log_format_entry(PGS_LOG_FORMAT, log_string, e->level, e->file, e->file_len, e->line, e->line_len, msg, msg_len, timestamp);
+
+        Pgs_Log_Error err = pgs_log_write_entry(e->level, e->file, e->file_len, e->line, e->line_len, msg, msg_len, timestamp, log_string, pos);
+        if (err != PGS_LOG_OK)
+            return err;
+    }
+
+    return pgs_log_set_last_error(PGS_LOG_OK, "Flushed backlog", 0);
+}
+
+void pgs_log_backlog_clear(void) {
+    pgs_log_backlog.count = 0;
+}
+
+#endif // PGS_LOG_ENABLE_BACKLOG
+
+#if PGS_LOG_ENABLE_FLIGHT_RECORDER
+
+#ifndef _WIN32
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#endif
+
+Pgs_Log_Level pgs_log_flight_recorder_level = PGS_LOG_DEBUG;
+
+static unsigned char pgs_log_flight_recorder_memory[sizeof(Pgs_Log_Flight_Recorder_Header) + PGS_LOG_FLIGHT_RECORDER_SIZE];
+static Pgs_Log_Flight_Recorder_Header *pgs_log_flight_recorder = NULL;
+
+static void pgs_log_flight_recorder_reset(Pgs_Log_Flight_Recorder_Header *h) {
+    memcpy(h->magic, PGS_LOG_FLIGHT_RECORDER_MAGIC, sizeof(h->magic));
+    h->size = PGS_LOG_FLIGHT_RECORDER_SIZE;
+    h->written = 0;
+}
+
+Pgs_Log_Error pgs_log_flight_recorder_init(const char *mmap_path) {
+    if (pgs_log_flight_recorder)
+        return pgs_log_set_last_error(PGS_LOG_OK, "Flight recorder already initialized", 0);
+
+    if (!mmap_path) {
+        pgs_log_flight_recorder = (Pgs_Log_Flight_Recorder_Header *)pgs_log_flight_recorder_memory;
+        pgs_log_flight_recorder_reset(pgs_log_flight_recorder);
+        return pgs_log_set_last_error(PGS_LOG_OK, "Initialized in memory flight recorder", 0);
+    }
+
+#ifdef _WIN32
+    return pgs_log_set_last_error(PGS_LOG_ERR, "File backed flight recorder is not supported on windows", 0);
+#else
+    if (pgs_log_create_dirs_for_path(mmap_path) != PGS_LOG_OK)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, pgs_log_temp_sprintf("Failed to create dirs for path %s", mmap_path), 0);
+
+    size_t total = sizeof(Pgs_Log_Flight_Recorder_Header) + PGS_LOG_FLIGHT_RECORDER_SIZE;
+    int fd = open(mmap_path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open flight recorder file", errno);
+
+    // a recorder left behind by a crashed run keeps its ring and gets appended to, anything else that is
+    // not empty is moved to `path.prev` so it can still be read with pgs_log_flight_recorder_read()
+    struct stat st;
+    Pgs_Log_Flight_Recorder_Header existing = {0};
+    bool keep = false;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        keep = (size_t)st.st_size == total && pread(fd, &existing, sizeof(existing), 0) == (ssize_t)sizeof(existing)
+            && memcmp(existing.magic, PGS_LOG_FLIGHT_RECORDER_MAGIC, sizeof(existing.magic)) == 0
+            && existing.size == PGS_LOG_FLIGHT_RECORDER_SIZE;
+        if (!keep) {
+            close(fd);
+            char prev[PGS_LOG_MAX_PATH_LEN];
+            snprintf(prev, sizeof(prev), "%s.prev", mmap_path);
+            if (rename(mmap_path, prev) != 0)
+                return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to move old flight recorder file aside", errno);
+            fd = open(mmap_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0)
+                return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open flight recorder file", errno);
+        }
+    }
+
+    if (!keep && ftruncate(fd, (off_t)total) != 0) {
+        int err = errno;
+        close(fd);
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to size flight recorder file", err);
+    }
+
+    void *mem = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd); // mapping keeps the file alive
+    if (mem == MAP_FAILED)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to mmap flight recorder file", err);
+
+    pgs_log_flight_recorder = (Pgs_Log_Flight_Recorder_Header *)mem;
+    if (keep)
+        return pgs_log_set_last_error(PGS_LOG_OK, "Reattached to existing flight recorder file", 0);
+
+    pgs_log_flight_recorder_reset(pgs_log_flight_recorder);
+    return pgs_log_set_last_error(PGS_LOG_OK, "Initialized file backed flight recorder", 0);
+#endif
+}
+
+Pgs_Log_Error pgs_log_flight_recorder_write(const char *str, size_t len) {
+    Pgs_Log_Flight_Recorder_Header *h = pgs_log_flight_recorder;
+    if (!h)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Flight recorder not initialized", 0);
+
+    unsigned char *data = (unsigned char *)(h + 1);
+    if (len > h->size) {
+        str += len - h->size;
+        len = h->size;
+    }
+
+    size_t pos = (size_t)(h->written % h->size);
+    size_t first = h->size - pos < len ? h->size - pos : len;
+    memcpy(data + pos, str, first);
+    memcpy(data, str + first, len - first);
+    h->written += len; // only advance after the bytes are in, a crash mid copy just loses this entry
+
+    return PGS_LOG_OK;
+}
+
+// only uses async signal safe calls, so can be used from the signal/crash handlers
+static bool pgs_log_flight_recorder_dump_fd(const Pgs_Log_Flight_Recorder_Header *h, int fd) {
+    const unsigned char *data = (const unsigned char *)(h + 1);
+    size_t size = (size_t)h->size;
+    size_t start = 0;
+    size_t len = (size_t)h->written;
+
+    if (h->written > h->size) {
+        // wrapped, skip the partially overwritten oldest entry
+        start = (size_t)(h->written % size);
+        len = size;
+        while (len > 0 && data[start] != '\n') {
+            start = (start + 1) % size;
+            len--;
+        }
+        if (len > 0) {
+            start = (start + 1) % size;
+            len--;
+        }
+    }
+
+    size_t first = size - start < len ? size - start : len;
+    if (first > 0 && pgs_write(fd, data + start, first) != (ssize_t)first)
+        return false;
+    if (len - first > 0 && pgs_write(fd, data, len - first) != (ssize_t)(len - first))
+        return false;
+    return true;
+}
+
+static bool pgs_log_flight_recorder_dump_path(const Pgs_Log_Flight_Recorder_Header *h, const char *path) {
+#ifdef _WIN32
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = pgs_log_flight_recorder_dump_fd(h, fileno(f));
+    fclose(f);
+    return ok;
+#else
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok = pgs_log_flight_recorder_dump_fd(h, fd);
+    close(fd);
+    return ok;
+#endif
+}
+
+Pgs_Log_Error pgs_log_flight_recorder_dump(const char *path) {
+    if (!pgs_log_flight_recorder)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Flight recorder not initialized", 0);
+    if (!path)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "no path passed", 0);
+
+    if (pgs_log_create_dirs_for_path(path) != PGS_LOG_OK)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, pgs_log_temp_sprintf("Failed to create dirs for path %s", path), 0);
+
+    if (!pgs_log_flight_recorder_dump_path(pgs_log_flight_recorder, path))
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to dump flight recorder", errno);
+
+    return pgs_log_set_last_error(PGS_LOG_OK, "Dumped flight recorder", 0);
+}
+
+Pgs_Log_Error pgs_log_flight_recorder_read(const char *recorder_path, const char *out_path) {
+    if (!recorder_path || !out_path)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "no path passed", 0);
+
+#ifdef _WIN32
+    return pgs_log_set_last_error(PGS_LOG_ERR, "File backed flight recorder is not supported on windows", 0);
+#else
+    int fd = open(recorder_path, O_RDONLY);
+    if (fd < 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open flight recorder file", errno);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Pgs_Log_Flight_Recorder_Header)) {
+        close(fd);
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Not a flight recorder file", 0);
+    }
+
+    void *mem = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int err = errno;
+    close(fd);
+    if (mem == MAP_FAILED)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to mmap flight recorder file", err);
+
+    const Pgs_Log_Flight_Recorder_Header *h = (const Pgs_Log_Flight_Recorder_Header *)mem;
+    if (memcmp(h->magic, PGS_LOG_FLIGHT_RECORDER_MAGIC, sizeof(h->magic)) != 0 || h->size == 0
+        || h->size > (size_t)st.st_size - sizeof(Pgs_Log_Flight_Recorder_Header)) {
+        munmap(mem, (size_t)st.st_size);
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Not a flight recorder file", 0);
+    }
+
+    bool ok = pgs_log_flight_recorder_dump_path(h, out_path);
+    err = errno;
+    munmap(mem, (size_t)st.st_size);
+    if (!ok)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write flight recorder contents", err);
+
+    return pgs_log_set_last_error(PGS_LOG_OK, "Read flight recorder", 0);
+#endif
+}
+
+static void pgs_log_flight_recorder_signal_handler(int signo) {
+    int saved_errno = errno;
+    if (pgs_log_flight_recorder)
+        pgs_log_flight_recorder_dump_path(pgs_log_flight_recorder, PGS_LOG_FLIGHT_RECORDER_DUMP_PATH);
+    errno = saved_errno;
+    (void)signo;
+}
+
+static void pgs_log_flight_recorder_crash_handler(int signo) {
+    if (pgs_log_flight_recorder)
+        pgs_log_flight_recorder_dump_path(pgs_log_flight_recorder, PGS_LOG_FLIGHT_RECORDER_DUMP_PATH);
+    signal(signo, SIG_DFL);
+    raise(signo);
+}
+
+Pgs_Log_Error pgs_log_flight_recorder_install_signal(int signo) {
+    // dirs cant be created from inside the handler
+    if (pgs_log_create_dirs_for_path(PGS_LOG_FLIGHT_RECORDER_DUMP_PATH) != PGS_LOG_OK)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to create dirs for flight recorder dump", 0);
+
+    if (signal(signo, pgs_log_flight_recorder_signal_handler) == SIG_ERR)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Failed to install flight recorder signal handler", errno);
+
+    return pgs_log_set_last_error(PGS_LOG_OK, "Installed flight recorder signal handler", 0);
+}
+
+Pgs_Log_Error pgs_log_flight_recorder_install_crash_handler(void) {
+    if (pgs_log_create_dirs_for_path(PGS_LOG_FLIGHT_RECORDER_DUMP_PATH) != PGS_LOG_OK)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to create dirs for flight recorder dump", 0);
+
+    int signals[] = {
+        SIGSEGV, SIGABRT, SIGFPE, SIGILL,
+#ifdef SIGBUS
+        SIGBUS,
+#endif
+    };
+
+    for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); ++i) {
+        if (signal(signals[i], pgs_log_flight_recorder_crash_handler) == SIG_ERR)
+            return pgs_log_set_last_error(PGS_LOG_ERR, "Failed to install flight recorder crash handler", errno);
+    }
+
+    return pgs_log_set_last_error(PGS_LOG_OK, "Installed flight recorder crash handler", 0);
+}
+
+#endif // PGS_LOG_ENABLE_FLIGHT_RECORDER
+
+#define PGS_LOG_MODULE_NAME_(id, name) name,
+
+static const char *pgs_log_module_names[PGS_LOG_MODULE_COUNT] = { "", PGS_LOG_MODULES(PGS_LOG_MODULE_NAME_) };
+
+// stored as level + 1, 0 means not set. `pgs_log_module_levels` is what the log path reads, already resolved through the parents
+static unsigned char pgs_log_module_explicit_levels[PGS_LOG_MODULE_COUNT];
+static unsigned char pgs_log_module_levels[PGS_LOG_MODULE_COUNT];
+
+static void pgs_log_resolve_module_levels(void) {
+    for (int m = 0; m < PGS_LOG_MODULE_COUNT; ++m) {
+        const char *name = pgs_log_module_names[m];
+        size_t best_len = 0;
+        unsigned char level = pgs_log_module_explicit_levels[0];
+
+        for (int p = 1; p < PGS_LOG_MODULE_COUNT; ++p) {
+            if (pgs_log_module_explicit_levels[p] == 0) continue;
+            const char *parent = pgs_log_module_names[p];
+            size_t parent_len = strlen(parent);
+            if (parent_len < best_len || strncmp(name, parent, parent_len) != 0) continue;
+            if (name[parent_len] != '\0' && name[parent_len] != '.') continue;
+            best_len = parent_len;
+            level = pgs_log_module_explicit_levels[p];
+        }
+
+        pgs_log_module_levels[m] = level;
+    }
+}
+
+static int pgs_log_find_module(const char *name) {
+    if (!name) return -1;
+    for (int m = 0; m < PGS_LOG_MODULE_COUNT; ++m) {
+        if (strcmp(pgs_log_module_names[m], name) == 0) return m;
+    }
+    return -1;
+}
+
+Pgs_Log_Error pgs_log_set_module_level(const char *name, Pgs_Log_Level level) {
+    int m = pgs_log_find_module(name);
+    if (m < 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR, pgs_log_temp_sprintf("Unknown log module `%s`", name ? name : "(null)"), 0);
+
+    pgs_log_module_explicit_levels[m] = (unsigned char)(level + 1);
+    pgs_log_resolve_module_levels();
+    return pgs_log_set_last_error(PGS_LOG_OK, "Set module level", 0);
+}
+
+Pgs_Log_Error pgs_log_reset_module_level(const char *name) {
+    int m = pgs_log_find_module(name);
+    if (m < 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR, pgs_log_temp_sprintf("Unknown log module `%s`", name ? name : "(null)"), 0);
+
+    pgs_log_module_explicit_levels[m] = 0;
+    pgs_log_resolve_module_levels();
+    return pgs_log_set_last_error(PGS_LOG_OK, "Reset module level", 0);
+}
+
+Pgs_Log_Level pgs_log_get_module_level(Pgs_Log_Module module) {
+    unsigned char level = pgs_log_module_levels[module];
+    return level ? (Pgs_Log_Level)(level - 1) : pgs_log_minimal_log_level;
+}
+
+const char *pgs_log_module_name(Pgs_Log_Module module) {
+    if ((int)module < 0 || module >= PGS_LOG_MODULE_COUNT) return "UNKNOWN";
+    return pgs_log_module_names[module];
+}
+
+Pgs_Log_Error pgs_log(Pgs_Log_Level level, const char *file, size_t file_len, const char *line, size_t line_len, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    Pgs_Log_Error err = pgs_log_modulev(PGS_LOG_MODULE_ROOT, level, file, file_len, line, line_len, fmt, ap);
+    va_end(ap);
+    return err;
+}
+
+Pgs_Log_Error pgs_log_module(Pgs_Log_Module module, Pgs_Log_Level level, const char *file, size_t file_len, const char *line, size_t line_len, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    Pgs_Log_Error err = pgs_log_modulev(module, level, file, file_len, line, line_len, fmt, ap);
+    va_end(ap);
+    return err;
+}
+
+#if PGS_LOG_ENABLE_LARGE_ENTRIES
+// puts the whole entry together on the heap, PGS_LOG_FORMAT split around %M with the message formatted in between
+static char *pgs_log_large_entry(Pgs_Log_Level level, const char *file, size_t file_len, const char *line, size_t line_len, const char *fmt, va_list ap, size_t msg_len, size_t *len) {
+    const char *m = strstr(PGS_LOG_FORMAT, "%M");
+    if (!m) return NULL;
+
+    char head_format[sizeof(PGS_LOG_FORMAT)];
+    memcpy(head_format, PGS_LOG_FORMAT, (size_t)(m - PGS_LOG_FORMAT));
+    head_format[m - PGS_LOG_FORMAT] = '\0';
+
+    char head[PGS_LOG_MAX_ENTRY_LEN];
+    char tail[PGS_LOG_MAX_ENTRY_LEN];
+    size_t head_len = pgs_log_format_entry(head_format, head, level, file, file_len, line, line_len, "", 0, NULL) - 1;
+    size_t tail_len = pgs_log_format_entry(m + 2, tail, level, file, file_len, line, line_len, "", 0, NULL);
+
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+    char *entry = pgs_log_mem_alloc(head_len + msg_len + tail_len + 1);
+#else
+    char *entry = malloc(head_len + msg_len + tail_len + 1);
+#endif
+    if (!entry) return NULL;
+
+    memcpy(entry, head, head_len);
+    vsnprintf(entry + head_len, msg_len + 1, fmt, ap);
+    memcpy(entry + head_len + msg_len, tail, tail_len + 1);
+    *len = head_len + msg_len + tail_len;
+    return entry;
+}
+#endif
+
+Pgs_Log_Error pgs_log_modulev(Pgs_Log_Module module, Pgs_Log_Level level, const char *file, size_t file_len, const char *line, size_t line_len, const char *fmt, va_list ap) {
+
+    if (!pgs_log_is_enabled)
+        return pgs_log_set_last_error(PGS_LOG_OK, "Logging disabled", 0);
+
+    bool to_outputs = level >= pgs_log_get_module_level(module);
+#if PGS_LOG_ENABLE_FLIGHT_RECORDER
+    bool to_recorder = pgs_log_flight_recorder && level >= pgs_log_flight_recorder_level;
+#else
+    bool to_recorder = false;
+#endif
+#if PGS_LOG_USDT_ACTIVE
+    bool to_probe = PGS_LOG_USDT_MESSAGE_ENABLED();
+#else
+    bool to_probe = false;
+#endif
+
+    if (!to_outputs) {
+#if PGS_LOG_ENABLE_BACKLOG
+        va_list cp;
+        va_copy(cp, ap);
+        pgs_log_backlog_capture(level, file, file_len, line, line_len, fmt, cp);
+        va_end(cp);
+#endif
+        if (!to_recorder && !to_probe)
+            return pgs_log_set_last_error(PGS_LOG_OK, "Below minimal Log Level", 0);
+    }
+
+    if (to_outputs) {
+        Pgs_Log_Error init_err = pgs_log_init_if_needed();
+        if (init_err != PGS_LOG_OK) {
+            return init_err;
+        }
+    }
+
+#if PGS_LOG_ENABLE_BACKLOG
+    if (to_outputs && level >= PGS_LOG_BACKLOG_TRIGGER_LEVEL) {
+        Pgs_Log_Error backlog_err = pgs_log_backlog_flush();
+        if (backlog_err != PGS_LOG_OK)
+            return backlog_err;
+    }
+#endif
+
+    char msg[PGS_LOG_MAX_ENTRY_LEN];
+#if PGS_LOG_ENABLE_LARGE_ENTRIES
+    // `ap` stays untouched in case the message has to be formatted again at full length
+    va_list cp;
+    va_copy(cp, ap);
+    int msg_len = vsnprintf(msg, PGS_LOG_MAX_ENTRY_LEN, fmt, cp);
+    va_end(cp);
+#else
+    int msg_len = vsnprintf(msg, PGS_LOG_MAX_ENTRY_LEN, fmt, ap);
+#endif
+
+    if (msg_len < 0) {
+        return pgs_log_set_last_error(PGS_LOG_ERR, "vsnprintf failed", 0);
+    }
+
+#if PGS_LOG_USDT_ACTIVE
+    if (to_probe)
+        PGS_LOG_USDT_PROBE4("message", "pgs_log_usdt_message_semaphore", level, file, atoi(line), msg);
+#endif
+
+    if (!to_outputs && !to_recorder)
+        return pgs_log_set_last_error(PGS_LOG_OK, "Below minimal Log Level", 0);
+
+    char log_string[PGS_LOG_MAX_ENTRY_LEN];
+    size_t pos = pgs_log_format_entry(PGS_LOG_FORMAT, log_string, level, file, file_len, line, line_len, msg, (size_t)msg_len, NULL);
+
+#if PGS_LOG_ENABLE_FLIGHT_RECORDER
+    if (to_recorder)
+        pgs_log_flight_recorder_write(log_string, pos);
+#endif
+
+    if (!to_outputs)
+        return pgs_log_set_last_error(PGS_LOG_OK, "Below minimal Log Level", 0);
+
+    pgs_log_thread_sequence = ++pgs_log_sequence;
+
+    const char *entry = log_string;
+    size_t entry_len = pos;
+    bool cut = (size_t)msg_len >= PGS_LOG_MAX_ENTRY_LEN - 1 || pos >= PGS_LOG_MAX_ENTRY_LEN - 1;
+#if PGS_LOG_ENABLE_LARGE_ENTRIES
+    char *large = cut ? pgs_log_large_entry(level, file, file_len, line, line_len, fmt, ap, (size_t)msg_len, &entry_len) : NULL;
+    if (large) entry = large;
+    else entry_len = pos;
+#endif
+    if (cut && entry == log_string) pgs_log_truncated++;
+
+    Pgs_Log_Error err = pgs_log_write_entry(level, file, file_len, line, line_len, msg, (size_t)msg_len, NULL, entry, entry_len);
+#if PGS_LOG_ENABLE_LARGE_ENTRIES && PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+    pgs_log_mem_free(large, entry_len + 1);
+#elif PGS_LOG_ENABLE_LARGE_ENTRIES
+    free(large);
+#endif
+    if (err != PGS_LOG_OK)
+        return err;
+
+#if PGS_LOG_TERMINAL_COALESCE
+    err = pgs_log_terminal_write_if_due(level);
+    if (err != PGS_LOG_OK)
+        return err;
+#endif
+
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    // the loop does the writing, the log call only wakes it. A FATAL entry is often the last thing the process
+    // does, the loop may never run again, so that one still goes out right here
+    if (level >= pgs_log_flush_level && level < PGS_LOG_FATAL) {
+        pgs_log_loop_request();
+    }
+    else
+#endif
+    if (level >= pgs_log_flush_level) {
+        err = PGS_LOG_FLUSH_SYNC ? pgs_log_sync() : pgs_log_flush();
+        if (err != PGS_LOG_OK)
+            return err;
+    }
+    else {
+#if PGS_LOG_MAX_BUFFER_AGE_MS > 0
+        if (pgs_log_buffered_since_ms == 0)
+            pgs_log_buffered_since_ms = pgs_log_now_ms();
+#endif
+        err = pgs_log_flush_if_due();
+        if (err != PGS_LOG_OK)
+            return err;
+    }
+
+    return pgs_log_set_last_error(PGS_LOG_OK, "Log entry written", 0);
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define PGS_LOG_ATOMIC_LOAD(p)            __atomic_load_n((p), __ATOMIC_RELAXED)
+#   define PGS_LOG_ATOMIC_STORE(p, v)        __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#   define PGS_LOG_ATOMIC_ADD(p, v)          __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#   define PGS_LOG_ATOMIC_EXCHANGE(p, v)     __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#   define PGS_LOG_ATOMIC_CAS(p, expected, v) __atomic_compare_exchange_n((p), (expected), (v), false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+#else
+// no atomics available, still correct single threaded
+#   define PGS_LOG_ATOMIC_LOAD(p)            (*(p))
+#   define PGS_LOG_ATOMIC_STORE(p, v)        (*(p) = (v))
+#   define PGS_LOG_ATOMIC_ADD(p, v)          ((*(p) += (v)) - (v))
+#   define PGS_LOG_ATOMIC_EXCHANGE(p, v)     pgs_log_atomic_exchange_uint_((p), (v))
+#   define PGS_LOG_ATOMIC_CAS(p, expected, v) (*(p) == *(expected) ? (*(p) = (v), true) : (*(expected) = *(p), false))
+static unsigned int pgs_log_atomic_exchange_uint_(unsigned int *p, unsigned int v) { unsigned int old = *p; *p = v; return old; }
+#endif
+
+static Pgs_Log_Ratelimit pgs_log_ratelimit_sites[PGS_LOG_MAX_RATELIMIT_SITES];
+static Pgs_Log_Ratelimit pgs_log_ratelimit_overflow = {
+    .module = PGS_LOG_MODULE_ROOT, .level = PGS_LOG_WARN, .file = "callsites past PGS_LOG_MAX_RATELIMIT_SITES", .line = "0" };
+static Pgs_Log_Ratelimit *pgs_log_ratelimit_list = NULL;
+
+// the state of a callsite for compilers without statement expressions, open addressing on the literal's address, a
+// slot is claimed once and never given back. Once the table is full the remaining callsites share one state, that
+// gets logged once
+Pgs_Log_Ratelimit *pgs_log_ratelimit_site(const char *site, Pgs_Log_Module module, Pgs_Log_Level level, const char *file, const char *line) {
+    size_t start = (size_t)((uintptr_t)site >> 3) % PGS_LOG_MAX_RATELIMIT_SITES;
+    for (size_t i = 0; i < PGS_LOG_MAX_RATELIMIT_SITES; ++i) {
+        Pgs_Log_Ratelimit *rl = &pgs_log_ratelimit_sites[(start + i) % PGS_LOG_MAX_RATELIMIT_SITES];
+        const char *current = PGS_LOG_ATOMIC_LOAD(&rl->site);
+        if (current == site) return rl;
+        if (current) continue;
+
+        if (PGS_LOG_ATOMIC_CAS(&rl->site, &current, site)) {
+            rl->module = module;
+            rl->level = level;
+            rl->file = file;
+            rl->line = line;
+            return rl;
+        }
+        if (current == site) return rl;
+    }
+
+    static unsigned int warned = 0;
+    if (PGS_LOG_ATOMIC_EXCHANGE(&warned, 1u) == 0) {
+        pgs_log_module(PGS_LOG_MODULE_ROOT, PGS_LOG_WARN, file, strlen(file), line, strlen(line),
+                       "rate limit table full, callsites from here on share one limit, raise `PGS_LOG_MAX_RATELIMIT_SITES`");
+    }
+    return &pgs_log_ratelimit_overflow;
+}
+
+static void pgs_log_ratelimit_register(Pgs_Log_Ratelimit *rl) {
+    int expected = 0;
+    if (!PGS_LOG_ATOMIC_CAS(&rl->registered, &expected, 1)) return;
+
+    Pgs_Log_Ratelimit *head = PGS_LOG_ATOMIC_LOAD(&pgs_log_ratelimit_list);
+    do {
+        rl->next = head;
+    } while (!PGS_LOG_ATOMIC_CAS(&pgs_log_ratelimit_list, &head, rl));
+}
+
+static void pgs_log_ratelimit_summary(Pgs_Log_Ratelimit *rl) {
+    unsigned int suppressed = PGS_LOG_ATOMIC_EXCHANGE(&rl->suppressed, 0u);
+    if (suppressed == 0) return;
+
+    pgs_log_module(rl->module, rl->level, rl->file, strlen(rl->file), rl->line, strlen(rl->line),
+                   "suppressed %u messages from %s:%s", suppressed, rl->file, rl->line);
+}
+
+// window second and count share one word, a new window starts with this call counted, so no increment of another
+// thread gets lost between resetting and counting
+bool pgs_log_ratelimit_allow(Pgs_Log_Ratelimit *rl, unsigned int n_per_sec) {
+    uint64_t now = (uint64_t)(uint32_t)time(NULL);
+    uint64_t window = PGS_LOG_ATOMIC_LOAD(&rl->window);
+
+    for (;;) {
+        uint64_t next;
+        if (window >> 32 != now) next = now << 32 | 1u;
+        else if ((uint32_t)window < n_per_sec) next = window + 1;
+        else break;
+
+        if (PGS_LOG_ATOMIC_CAS(&rl->window, &window, next)) {
+            pgs_log_ratelimit_summary(rl);
+            return true;
+        }
+    }
+
+    PGS_LOG_ATOMIC_ADD(&rl->suppressed, 1u);
+    pgs_log_ratelimit_register(rl);
+    return false;
+}
+
+bool pgs_log_sample_allow(Pgs_Log_Ratelimit *rl, unsigned int one_in_n) {
+    if (one_in_n <= 1) return true;
+    return PGS_LOG_ATOMIC_ADD(&rl->sampled, 1u) % one_in_n == 0;
+}
+
+Pgs_Log_Error pgs_log_ratelimit_report(void) {
+    for (Pgs_Log_Ratelimit *rl = PGS_LOG_ATOMIC_LOAD(&pgs_log_ratelimit_list); rl; rl = rl->next) {
+        pgs_log_ratelimit_summary(rl);
+    }
+    return pgs_log_set_last_error(PGS_LOG_OK, "Reported suppressed messages", 0);
+}
+
+// summaries of callsites that went quiet after their window, checked at most once a second
+static void pgs_log_ratelimit_report_due(void) {
+    static uint64_t checked = 0;
+    uint64_t now = (uint64_t)(uint32_t)time(NULL);
+    if (PGS_LOG_ATOMIC_LOAD(&checked) == now || !PGS_LOG_ATOMIC_LOAD(&pgs_log_ratelimit_list)) return;
+    PGS_LOG_ATOMIC_STORE(&checked, now);
+
+    for (Pgs_Log_Ratelimit *rl = PGS_LOG_ATOMIC_LOAD(&pgs_log_ratelimit_list); rl; rl = rl->next) {
+        if (PGS_LOG_ATOMIC_LOAD(&rl->window) >> 32 != now) pgs_log_ratelimit_summary(rl);
+    }
+}
+
+#if PGS_LOG_ENABLE_MMAP_OUTPUT
+
+#include <fcntl.h>
+#include <sys/mman.h>
+
+static Pgs_Log_Mmap_Output pgs_mmap_outputs[PGS_LOG_MAX_MMAP_OUTPUTS];
+
+static size_t pgs_log_mmap_window_size(void) {
+    static size_t size = 0;
+    if (size == 0) {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size = (PGS_LOG_MMAP_WINDOW_SIZE + page - 1) / page * page;
+    }
+    return size;
+}
+
+// file always reaches one window past the mapped one, so moving the window does not need to grow the file first
+// grows in `PGS_LOG_MMAP_GROW_SIZE` steps, most window moves find the room already there
+static Pgs_Log_Error pgs_log_mmap_reserve(Pgs_Log_Mmap_Output *m, size_t end) {
+    if (m->allocated >= end) return PGS_LOG_OK;
+
+    size_t step = PGS_LOG_MMAP_GROW_SIZE < 2 * pgs_log_mmap_window_size() ? 2 * pgs_log_mmap_window_size() : PGS_LOG_MMAP_GROW_SIZE;
+    end = (end + step - 1) / step * step;
+
+    int err = posix_fallocate(m->fd, (off_t)m->allocated, (off_t)(end - m->allocated));
+    if (err == EINVAL || err == EOPNOTSUPP) {
+        if (ftruncate(m->fd, (off_t)end) != 0)
+            return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to grow mmap log file", errno);
+    } else if (err != 0) {
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to preallocate mmap log file", err);
+    }
+
+    m->allocated = end;
+    return PGS_LOG_OK;
+}
+
+static Pgs_Log_Error pgs_log_mmap_map_window(Pgs_Log_Mmap_Output *m, size_t window_off) {
+    size_t window = pgs_log_mmap_window_size();
+
+    Pgs_Log_Error err = pgs_log_mmap_reserve(m, window_off + 2 * window);
+    if (err != PGS_LOG_OK)
+        return err;
+
+    if (m->window) munmap(m->window, window);
+    m->window = NULL;
+
+    void *mem = mmap(NULL, window, PROT_READ | PROT_WRITE, MAP_SHARED, m->fd, (off_t)window_off);
+    if (mem == MAP_FAILED)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to mmap log file window", errno);
+
+    madvise(mem, window, MADV_SEQUENTIAL);
+    m->window = mem;
+    m->window_off = window_off;
+    return PGS_LOG_OK;
+}
+
+static Pgs_Log_Error pgs_log_mmap_output_write(void *ctx, const char *str, size_t len) {
+    Pgs_Log_Mmap_Output *m = (Pgs_Log_Mmap_Output *)ctx;
+    size_t window = pgs_log_mmap_window_size();
+
+    while (len > 0) {
+        if (m->pos == window) {
+            Pgs_Log_Error err = pgs_log_mmap_map_window(m, m->window_off + window);
+            if (err != PGS_LOG_OK)
+                return err;
+            m->pos = 0;
+        }
+
+        size_t n = window - m->pos < len ? window - m->pos : len;
+        memcpy(m->window + m->pos, str, n);
+        m->pos += n;
+        str += n;
+        len -= n;
+    }
+
+    return PGS_LOG_OK;
+}
+
+// cuts the preallocated tail once the file is done, a flush leaves it so the next write does not grow it again
+static void pgs_log_mmap_output_close(void *ctx) {
+    Pgs_Log_Mmap_Output *m = (Pgs_Log_Mmap_Output *)ctx;
+    if (m->window) munmap(m->window, pgs_log_mmap_window_size());
+    if (m->allocated != m->window_off + m->pos && ftruncate(m->fd, (off_t)(m->window_off + m->pos)) != 0)
+        pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to truncate mmap log file", errno);
+    close(m->fd);
+    m->window = NULL;
+    m->fd = -1;
+    m->in_use = false;
+}
+
+static int pgs_log_mmap_output_fd(void *ctx) {
+    return ((Pgs_Log_Mmap_Output *)ctx)->fd;
+}
+
+Pgs_Log_Error pgs_log_add_mmap_output(const char *path, bool append) {
+    if (!path)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No path passed to add to output", 0);
+
+    Pgs_Log_Mmap_Output *m = NULL;
+    for (int i = 0; i < PGS_LOG_MAX_MMAP_OUTPUTS && !m; ++i) {
+        if (!pgs_mmap_outputs[i].in_use) m = &pgs_mmap_outputs[i];
+    }
+    if (!m)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Reached max mmap output count, you can add `#define PGS_LOG_MAX_MMAP_OUTPUTS` and increase the number and recompile", 0);
+
+    if (strlen(path) >= PGS_LOG_MAX_PATH_LEN)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Path too long", 0);
+
+    int fd = open(path, O_RDWR | O_CREAT | (append ? 0 : O_TRUNC), 0644);
+    if (fd < 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open mmap log file", errno);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to stat mmap log file", err);
+    }
+
+    memset(m, 0, sizeof(*m));
+    m->fd = fd;
+    strcpy(m->path, path);
+    m->allocated = (size_t)st.st_size;
+
+    // a file that was not closed still has its zero filled tail, continue after the last entry
+    size_t length = (size_t)st.st_size;
+    char tail[4096];
+    while (length > 0) {
+        size_t n = length < sizeof(tail) ? length : sizeof(tail);
+        if (pread(fd, tail, n, (off_t)(length - n)) != (ssize_t)n) break;
+        size_t keep = n;
+        while (keep > 0 && tail[keep - 1] == '\0') keep--;
+        length -= n - keep;
+        if (keep > 0) break;
+    }
+
+    size_t window = pgs_log_mmap_window_size();
+    size_t window_off = length / window * window;
+    Pgs_Log_Error err = pgs_log_mmap_map_window(m, window_off);
+    if (err != PGS_LOG_OK) {
+        close(fd);
+        return err;
+    }
+    m->pos = length - window_off;
+
+    m->in_use = true;
+    Pgs_Log_Sink sink = { .write = pgs_log_mmap_output_write, .close = pgs_log_mmap_output_close, .sync_fd = pgs_log_mmap_output_fd, .unbuffered = true };
+    err = pgs_log_add_sink_output(sink, m);
+    if (err != PGS_LOG_OK) {
+        pgs_log_mmap_output_close(m);
+        return err;
+    }
+    return pgs_log_set_last_error(PGS_LOG_OK, "Added mmap output", 0);
+}
+
+Pgs_Log_Error pgs_log_remove_mmap_output(const char *path) {
+    if (!path)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No path passed", 0);
+
+    for (int i = 0; i < PGS_LOG_MAX_MMAP_OUTPUTS; ++i) {
+        if (pgs_mmap_outputs[i].in_use && strcmp(pgs_mmap_outputs[i].path, path) == 0)
+            return pgs_log_remove_sink_output(&pgs_mmap_outputs[i]);
+    }
+
+    return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "path does not exist in mmap outputs", 0);
+}
+
+#endif // PGS_LOG_ENABLE_MMAP_OUTPUT
+
+#if PGS_LOG_ENABLE_DIRECT_OUTPUT
+
+#include <fcntl.h>
+
+// glibc only defines O_DIRECT with _GNU_SOURCE, the value differs between architectures
+#if defined(O_DIRECT)
+#   define PGS_LOG_O_DIRECT O_DIRECT
+#elif defined(__linux__) && (defined(__x86_64__) || defined(__i386__))
+#   define PGS_LOG_O_DIRECT 040000
+#elif defined(__linux__) && (defined(__aarch64__) || defined(__arm__))
+#   define PGS_LOG_O_DIRECT 0200000
+#else
+#   define PGS_LOG_O_DIRECT 0
+#endif
+
+static Pgs_Log_Direct_Output pgs_direct_outputs[PGS_LOG_MAX_DIRECT_OUTPUTS];
+
+static Pgs_Log_Error pgs_log_direct_write_block(Pgs_Log_Direct_Output *d, size_t len) {
+    if (pwrite(d->fd, d->buffer, len, d->file_off) != (ssize_t)len)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write direct output block", errno);
+
+    // pages still under writeback are skipped by the kernel and dropped by a later call
+    if (!d->direct)
+        posix_fadvise(d->fd, 0, d->file_off + (off_t)len, POSIX_FADV_DONTNEED);
+
+    return PGS_LOG_OK;
+}
+
+static Pgs_Log_Error pgs_log_direct_output_write(void *ctx, const char *str, size_t len) {
+    Pgs_Log_Direct_Output *d = (Pgs_Log_Direct_Output *)ctx;
+    while (len > 0) {
+        size_t n = PGS_LOG_DIRECT_BUFFER_SIZE - d->pos < len ? PGS_LOG_DIRECT_BUFFER_SIZE - d->pos : len;
+        memcpy(d->buffer + d->pos, str, n);
+        d->pos += n;
+        str += n;
+        len -= n;
+
+        if (d->pos == PGS_LOG_DIRECT_BUFFER_SIZE) {
+            Pgs_Log_Error err = pgs_log_direct_write_block(d, PGS_LOG_DIRECT_BUFFER_SIZE);
+            if (err != PGS_LOG_OK)
+                return err;
+            d->file_off += PGS_LOG_DIRECT_BUFFER_SIZE;
+            d->pos = 0;
+        }
+    }
+
+    return PGS_LOG_OK;
+}
+
+// writes the partial block zero padded to the alignment, the block stays in the buffer and gets rewritten once more
+// entries arrive, the padding stays in the file until pgs_log_direct_output_finish() cuts it off
+static Pgs_Log_Error pgs_log_direct_output_sync(void *ctx) {
+    Pgs_Log_Direct_Output *d = (Pgs_Log_Direct_Output *)ctx;
+    if (d->pos == 0) return PGS_LOG_OK;
+
+    size_t padded = (d->pos + PGS_LOG_DIRECT_ALIGNMENT - 1) / PGS_LOG_DIRECT_ALIGNMENT * PGS_LOG_DIRECT_ALIGNMENT;
+    memset(d->buffer + d->pos, 0, padded - d->pos);
+
+    return pgs_log_direct_write_block(d, padded);
+}
+
+static void pgs_log_direct_output_release(Pgs_Log_Direct_Output *d) {
+    close(d->fd);
+    free(d->buffer);
+    d->buffer = NULL;
+    d->fd = -1;
+    d->in_use = false;
+}
+
+// on remove/cleanup, after the flush wrote the padded block, the file gets its real length
+static void pgs_log_direct_output_close(void *ctx) {
+    Pgs_Log_Direct_Output *d = (Pgs_Log_Direct_Output *)ctx;
+    if (d->pos > 0 && ftruncate(d->fd, d->file_off + (off_t)d->pos) != 0)
+        pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to truncate direct output", errno);
+    pgs_log_direct_output_release(d);
+}
+
+static int pgs_log_direct_output_fd(void *ctx) {
+    return ((Pgs_Log_Direct_Output *)ctx)->fd;
+}
+
+Pgs_Log_Error pgs_log_add_direct_output(const char *path, bool append) {
+    if (!path)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No path passed to add to output", 0);
+
+    Pgs_Log_Direct_Output *d = NULL;
+    for (int i = 0; i < PGS_LOG_MAX_DIRECT_OUTPUTS && !d; ++i) {
+        if (!pgs_direct_outputs[i].in_use) d = &pgs_direct_outputs[i];
+    }
+    if (!d)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Reached max direct output count, you can add `#define PGS_LOG_MAX_DIRECT_OUTPUTS` and increase the number and recompile", 0);
+
+    if (strlen(path) >= PGS_LOG_MAX_PATH_LEN)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Path too long", 0);
+
+    int flags = O_RDWR | O_CREAT | (append ? 0 : O_TRUNC);
+    bool direct = PGS_LOG_O_DIRECT != 0;
+    int fd = direct ? open(path, flags | PGS_LOG_O_DIRECT, 0644) : -1;
+    if (fd < 0) {
+        direct = false;
+        fd = open(path, flags, 0644);
+    }
+    if (fd < 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open direct output file", errno);
+
+    struct stat st;
+    void *buffer = NULL;
+    int err = fstat(fd, &st) != 0 ? errno : posix_memalign(&buffer, PGS_LOG_DIRECT_ALIGNMENT, PGS_LOG_DIRECT_BUFFER_SIZE);
+    if (err != 0) {
+        close(fd);
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Failed to set up direct output", err);
+    }
+
+    memset(d, 0, sizeof(*d));
+    d->fd = fd;
+    strcpy(d->path, path);
+    d->buffer = buffer;
+    d->direct = direct;
+
+    // appending starts at the last aligned block, its existing bytes are read back into the buffer, padding a process
+    // that did not get to remove/cleanup left behind is dropped
+    d->file_off = st.st_size > 0 ? (st.st_size - 1) / PGS_LOG_DIRECT_ALIGNMENT * PGS_LOG_DIRECT_ALIGNMENT : 0;
+    d->pos = (size_t)(st.st_size - d->file_off);
+    if (d->pos > 0 && pread(fd, d->buffer, PGS_LOG_DIRECT_ALIGNMENT, d->file_off) < (ssize_t)d->pos) {
+        int read_err = errno;
+        pgs_log_direct_output_release(d);
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to read tail of direct output file", read_err);
+    }
+    while (d->pos > 0 && d->buffer[d->pos - 1] == '\0') d->pos--;
+
+    d->in_use = true;
+    Pgs_Log_Sink sink = { .write = pgs_log_direct_output_write, .flush = pgs_log_direct_output_sync, .close = pgs_log_direct_output_close, .sync_fd = pgs_log_direct_output_fd, .unbuffered = true };
+    Pgs_Log_Error add_err = pgs_log_add_sink_output(sink, d);
+    if (add_err != PGS_LOG_OK) {
+        pgs_log_direct_output_release(d);
+        return add_err;
+    }
+    return pgs_log_set_last_error(PGS_LOG_OK, "Added direct output", 0);
+}
+
+Pgs_Log_Error pgs_log_remove_direct_output(const char *path) {
+    if (!path)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No path passed", 0);
+
+    for (int i = 0; i < PGS_LOG_MAX_DIRECT_OUTPUTS; ++i) {
+        if (pgs_direct_outputs[i].in_use && strcmp(pgs_direct_outputs[i].path, path) == 0)
+            return pgs_log_remove_sink_output(&pgs_direct_outputs[i]);
+    }
+
+    return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "path does not exist in direct outputs", 0);
+}
+
+bool pgs_log_direct_output_is_direct(const char *path) {
+    for (int i = 0; i < PGS_LOG_MAX_DIRECT_OUTPUTS; ++i) {
+        if (pgs_direct_outputs[i].in_use && strcmp(pgs_direct_outputs[i].path, path) == 0) return pgs_direct_outputs[i].direct;
+    }
+    return false;
+}
+
+#endif // PGS_LOG_ENABLE_DIRECT_OUTPUT
+
+#if PGS_LOG_ENABLE_SEGMENTS
+
+#include <fcntl.h>
+#include <inttypes.h>
+
+#if PGS_LOG_SEGMENT_SIZE <= PGS_LOG_SEGMENT_HEADER_SIZE
+#   error "PGS_LOG_SEGMENT_SIZE has to be larger than the 64 byte segment header"
+#endif
+
+static Pgs_Log_Segment_Output pgs_segment_outputs[PGS_LOG_MAX_SEGMENT_OUTPUTS];
+
+static void pgs_log_segment_filename(char *out, const char *path, int index) {
+    snprintf(out, PGS_LOG_MAX_PATH_LEN, "%s.%d", path, index);
+}
+
+// fixed size text line, so a segment still reads fine with cat/less
+static Pgs_Log_Error pgs_log_segment_write_header(int fd, uint64_t generation, size_t len) {
+    char header[PGS_LOG_SEGMENT_HEADER_SIZE + 1];
+    int n = snprintf(header, sizeof(header), "PGSSEG v1 gen %020" PRIu64 " len %020" PRIu64, generation, (uint64_t)len);
+    memset(header + n, ' ', PGS_LOG_SEGMENT_HEADER_SIZE - 1 - (size_t)n);
+    header[PGS_LOG_SEGMENT_HEADER_SIZE - 1] = '\n';
+
+    if (pwrite(fd, header, PGS_LOG_SEGMENT_HEADER_SIZE, 0) != PGS_LOG_SEGMENT_HEADER_SIZE)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write segment header", errno);
+    return PGS_LOG_OK;
+}
+
+// false for segments that never got a header
+static bool pgs_log_segment_read_header(int fd, uint64_t *generation, uint64_t *len) {
+    char header[PGS_LOG_SEGMENT_HEADER_SIZE + 1];
+    if (pread(fd, header, PGS_LOG_SEGMENT_HEADER_SIZE, 0) != PGS_LOG_SEGMENT_HEADER_SIZE) return false;
+    header[PGS_LOG_SEGMENT_HEADER_SIZE] = '\0';
+
+    if (sscanf(header, "PGSSEG v1 gen %" SCNu64 " len %" SCNu64, generation, len) != 2) return false;
+    return *len <= PGS_LOG_SEGMENT_SIZE - PGS_LOG_SEGMENT_HEADER_SIZE;
+}
+
+static Pgs_Log_Error pgs_log_segment_write_buffer(Pgs_Log_Segment_Output *g) {
+    if (g->buf_pos == 0) return PGS_LOG_OK;
+
+    off_t off = (off_t)(PGS_LOG_SEGMENT_HEADER_SIZE + g->used);
+    if (pwrite(g->fds[g->current], g->buffer, g->buf_pos, off) != (ssize_t)g->buf_pos)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write log segment", errno);
+
+    g->used += g->buf_pos;
+    g->buf_pos = 0;
+    return PGS_LOG_OK;
+}
+
+static Pgs_Log_Error pgs_log_segment_output_sync(void *ctx) {
+    Pgs_Log_Segment_Output *g = (Pgs_Log_Segment_Output *)ctx;
+    Pgs_Log_Error err = pgs_log_segment_write_buffer(g);
+    if (err != PGS_LOG_OK)
+        return err;
+    return pgs_log_segment_write_header(g->fds[g->current], g->generation, g->used);
+}
+
+// finishes the current segment and starts over in the oldest one. A finished segment is fdatasync'ed once right
+// here, one flush can fill several segments and durability waits only have to sync the current one
+static Pgs_Log_Error pgs_log_segment_advance(Pgs_Log_Segment_Output *g) {
+    Pgs_Log_Error err = pgs_log_segment_output_sync(g);
+    if (err != PGS_LOG_OK)
+        return err;
+    int sync_err = fdatasync(g->fds[g->current]) != 0 ? errno : 0;
+
+    g->current = (g->current + 1) % PGS_LOG_SEGMENT_COUNT;
+    g->generation++;
+    g->used = 0;
+    err = pgs_log_segment_write_header(g->fds[g->current], g->generation, 0);
+    if (err != PGS_LOG_OK)
+        return err;
+    if (sync_err != 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to sync finished log segment", sync_err);
+    return PGS_LOG_OK;
+}
+
+static Pgs_Log_Error pgs_log_segment_output_write(void *ctx, const char *str, size_t len) {
+    Pgs_Log_Segment_Output *g = (Pgs_Log_Segment_Output *)ctx;
+    const size_t capacity = PGS_LOG_SEGMENT_SIZE - PGS_LOG_SEGMENT_HEADER_SIZE;
+    if (len > capacity || len > PGS_LOG_SEGMENT_BUFFER_SIZE)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Log entry larger than a log segment", 0);
+
+    Pgs_Log_Error err = PGS_LOG_OK;
+    // entries never get split between two segments
+    if (g->used + g->buf_pos + len > capacity)
+        err = pgs_log_segment_advance(g);
+    else if (g->buf_pos + len > PGS_LOG_SEGMENT_BUFFER_SIZE)
+        err = pgs_log_segment_write_buffer(g);
+    if (err != PGS_LOG_OK)
+        return err;
+
+    memcpy(g->buffer + g->buf_pos, str, len);
+    g->buf_pos += len;
+    return PGS_LOG_OK;
+}
+
+static void pgs_log_segment_output_close(void *ctx) {
+    Pgs_Log_Segment_Output *g = (Pgs_Log_Segment_Output *)ctx;
+    for (int i = 0; i < PGS_LOG_SEGMENT_COUNT; ++i) {
+        if (g->fds[i] >= 0) close(g->fds[i]);
+        g->fds[i] = -1;
+    }
+    g->in_use = false;
+}
+
+// finished segments got synced when they were closed, only the current one is left
+static int pgs_log_segment_output_fd(void *ctx) {
+    Pgs_Log_Segment_Output *g = (Pgs_Log_Segment_Output *)ctx;
+    return g->fds[g->current];
+}
+
+Pgs_Log_Error pgs_log_add_segment_output(const char *path) {
+    if (!path)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No path passed to add to output", 0);
+
+    Pgs_Log_Segment_Output *g = NULL;
+    for (int i = 0; i < PGS_LOG_MAX_SEGMENT_OUTPUTS && !g; ++i) {
+        if (!pgs_segment_outputs[i].in_use) g = &pgs_segment_outputs[i];
+    }
+    if (!g)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Reached max segment output count, you can add `#define PGS_LOG_MAX_SEGMENT_OUTPUTS` and increase the number and recompile", 0);
+
+    if (strlen(path) + 12 >= PGS_LOG_MAX_PATH_LEN)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Path too long", 0);
+
+    strcpy(g->path, path);
+    g->buf_pos = 0;
+    g->used = 0;
+    g->current = PGS_LOG_SEGMENT_COUNT - 1;
+    g->generation = 0;
+    for (int i = 0; i < PGS_LOG_SEGMENT_COUNT; ++i) g->fds[i] = -1;
+
+    // all space is taken up front, later runs find the segments already allocated
+    for (int i = 0; i < PGS_LOG_SEGMENT_COUNT; ++i) {
+        char filename[PGS_LOG_MAX_PATH_LEN];
+        pgs_log_segment_filename(filename, path, i);
+
+        g->fds[i] = open(filename, O_RDWR | O_CREAT, 0644);
+        if (g->fds[i] < 0) {
+            int open_err = errno;
+            pgs_log_segment_output_close(g);
+            return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open log segment", open_err);
+        }
+
+        int err = posix_fallocate(g->fds[i], 0, PGS_LOG_SEGMENT_SIZE);
+        if ((err == EINVAL || err == EOPNOTSUPP) && ftruncate(g->fds[i], PGS_LOG_SEGMENT_SIZE) == 0) err = 0;
+        if (err != 0) {
+            pgs_log_segment_output_close(g);
+            return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to preallocate log segment", err);
+        }
+
+        uint64_t generation, len;
+        if (pgs_log_segment_read_header(g->fds[i], &generation, &len) && generation > g->generation) {
+            g->generation = generation;
+            g->current = i;
+        }
+    }
+
+    // keep what the last run wrote, continue in the segment after its newest one
+    g->current = (g->current + 1) % PGS_LOG_SEGMENT_COUNT;
+    g->generation++;
+    Pgs_Log_Error err = pgs_log_segment_write_header(g->fds[g->current], g->generation, 0);
+    if (err != PGS_LOG_OK) {
+        pgs_log_segment_output_close(g);
+        return err;
+    }
+
+    g->in_use = true;
+    Pgs_Log_Sink sink = { .write = pgs_log_segment_output_write, .flush = pgs_log_segment_output_sync, .close = pgs_log_segment_output_close, .sync_fd = pgs_log_segment_output_fd, .unbuffered = true };
+    err = pgs_log_add_sink_output(sink, g);
+    if (err != PGS_LOG_OK) {
+        pgs_log_segment_output_close(g);
+        return err;
+    }
+    return pgs_log_set_last_error(PGS_LOG_OK, "Added segment output", 0);
+}
+
+Pgs_Log_Error pgs_log_remove_segment_output(const char *path) {
+    if (!path)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No path passed", 0);
+
+    for (int i = 0; i < PGS_LOG_MAX_SEGMENT_OUTPUTS; ++i) {
+        if (pgs_segment_outputs[i].in_use && strcmp(pgs_segment_outputs[i].path, path) == 0)
+            return pgs_log_remove_sink_output(&pgs_segment_outputs[i]);
+    }
+
+    return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "path does not exist in segment outputs", 0);
+}
+
+Pgs_Log_Error pgs_log_segments_dump(const char *path, const char *out_path) {
+    if (!path || !out_path)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No path passed", 0);
+
+    int order[PGS_LOG_SEGMENT_COUNT];
+    uint64_t generations[PGS_LOG_SEGMENT_COUNT];
+    uint64_t lens[PGS_LOG_SEGMENT_COUNT];
+    int fds[PGS_LOG_SEGMENT_COUNT];
+    int count = 0;
+
+    for (int i = 0; i < PGS_LOG_SEGMENT_COUNT; ++i) {
+        char filename[PGS_LOG_MAX_PATH_LEN];
+        pgs_log_segment_filename(filename, path, i);
+        fds[i] = open(filename, O_RDONLY);
+        if (fds[i] < 0 || !pgs_log_segment_read_header(fds[i], &generations[i], &lens[i])) continue;
+
+        // insertion sort by generation, oldest first
+        int j = count++;
+        while (j > 0 && generations[order[j - 1]] > generations[i]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    FILE *out = fopen(out_path, "wb");
+    Pgs_Log_Error err = out ? PGS_LOG_OK : pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open segment dump file", errno);
+
+    char chunk[4096];
+    for (int k = 0; k < count && err == PGS_LOG_OK; ++k) {
+        int i = order[k];
+        for (uint64_t done = 0; done < lens[i] && err == PGS_LOG_OK;) {
+            size_t want = lens[i] - done < sizeof(chunk) ? (size_t)(lens[i] - done) : sizeof(chunk);
+            ssize_t n = pread(fds[i], chunk, want, (off_t)(PGS_LOG_SEGMENT_HEADER_SIZE + done));
+            if (n <= 0 || fwrite(chunk, 1, (size_t)n, out) != (size_t)n)
+                err = pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to copy log segment", errno);
+            done += n > 0 ? (uint64_t)n : 0;
+        }
+    }
+
+    for (int i = 0; i < PGS_LOG_SEGMENT_COUNT; ++i)
+        if (fds[i] >= 0) close(fds[i]);
+    if (out && fclose(out) != 0 && err == PGS_LOG_OK)
+        err = pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write segment dump file", errno);
+
+    if (err != PGS_LOG_OK)
+        return err;
+    return pgs_log_set_last_error(PGS_LOG_OK, "Dumped log segments", 0);
+}
+
+#endif // PGS_LOG_ENABLE_SEGMENTS
+
+#if PGS_LOG_ENABLE_VMSPLICE
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#ifndef SPLICE_F_GIFT
+#   define SPLICE_F_GIFT 0x08
+#endif
+#ifndef F_SETPIPE_SZ
+#   define F_SETPIPE_SZ 1031
+#endif
+
+static Pgs_Log_Pipe_Output pgs_pipe_outputs[PGS_LOG_MAX_PIPE_OUTPUTS];
+
+static bool pgs_log_fd_is_pipe(int fd) {
+    struct stat st;
+    return fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode);
+}
+
+// the old pages stay with the pipe (or whoever it moved them to), the buffer address keeps working
+static Pgs_Log_Error pgs_log_pipe_fresh_pages(Pgs_Log_Pipe_Output *p) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | (p->buffer ? MAP_FIXED : 0);
+    void *buffer = mmap(p->buffer, PGS_LOG_VMSPLICE_BUFFER_SIZE, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (buffer == MAP_FAILED)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to map pipe output buffer", errno);
+    p->buffer = buffer;
+    return PGS_LOG_OK;
+}
+
+// writes the buffer from `done` up to `len`
+static Pgs_Log_Error pgs_log_pipe_output_copy(Pgs_Log_Pipe_Output *p, size_t done, size_t len) {
+    while (done < len) {
+        ssize_t n = pgs_write(p->fd, p->buffer + done, len - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write to pipe", errno);
+        }
+        done += (size_t)n;
+    }
+    return PGS_LOG_OK;
+}
+
+// hands the first `len` bytes of the buffer to the pipe, after this the buffer has fresh pages and is empty
+static Pgs_Log_Error pgs_log_pipe_output_gift(Pgs_Log_Pipe_Output *p, size_t len) {
+    size_t done = 0;
+    while (p->spliced && done < len) {
+        struct iovec iov = { .iov_base = p->buffer + done, .iov_len = len - done };
+        ssize_t n = (ssize_t)syscall(__NR_vmsplice, p->fd, &iov, 1UL, (unsigned int)SPLICE_F_GIFT);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            // a full non-blocking pipe or no memory only falls back for this write,
+            // anything else means no vmsplice for this fd/kernel, stay with write()
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOMEM) p->spliced = false;
+            break;
+        }
+        done += (size_t)n;
+    }
+
+    if (done < len) {
+        // the gifted prefix is already in the pipe, only the rest gets copied
+        Pgs_Log_Error err = pgs_log_pipe_output_copy(p, done, len);
+        if (done == 0 || err != PGS_LOG_OK) {
+            p->pos = 0;
+            return err;
+        }
+    }
+
+    p->pos = 0;
+    return pgs_log_pipe_fresh_pages(p);
+}
+
+static Pgs_Log_Error pgs_log_pipe_output_write(void *ctx, const char *str, size_t len) {
+    Pgs_Log_Pipe_Output *p = (Pgs_Log_Pipe_Output *)ctx;
+    if (len > PGS_LOG_VMSPLICE_BUFFER_SIZE)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Log entry larger than `PGS_LOG_VMSPLICE_BUFFER_SIZE`", 0);
+
+    if (p->pos + len > PGS_LOG_VMSPLICE_BUFFER_SIZE) {
+        Pgs_Log_Error err = pgs_log_pipe_output_gift(p, p->pos);
+        if (err != PGS_LOG_OK)
+            return err;
+    }
+
+    memcpy(p->buffer + p->pos, str, len);
+    p->pos += len;
+    return PGS_LOG_OK;
+}
+
+static Pgs_Log_Error pgs_log_pipe_output_sync(void *ctx) {
+    Pgs_Log_Pipe_Output *p = (Pgs_Log_Pipe_Output *)ctx;
+    if (p->pos == 0) return PGS_LOG_OK;
+
+    // copying a few pages is cheaper than mapping fresh ones
+    if (p->pos < PGS_LOG_VMSPLICE_MIN_GIFT || !p->spliced) {
+        Pgs_Log_Error err = pgs_log_pipe_output_copy(p, 0, p->pos);
+        p->pos = 0;
+        return err;
+    }
+    return pgs_log_pipe_output_gift(p, p->pos);
+}
+
+static void pgs_log_pipe_output_close(void *ctx) {
+    Pgs_Log_Pipe_Output *p = (Pgs_Log_Pipe_Output *)ctx;
+    if (p->buffer) munmap(p->buffer, PGS_LOG_VMSPLICE_BUFFER_SIZE);
+    p->buffer = NULL;
+    if (p->owned) close(p->fd);
+    p->in_use = false;
+}
+
+Pgs_Log_Error pgs_log_add_pipe_output(int fd, bool owned) {
+    Pgs_Log_Pipe_Output *p = NULL;
+    for (int i = 0; i < PGS_LOG_MAX_PIPE_OUTPUTS && !p; ++i) {
+        if (!pgs_pipe_outputs[i].in_use) p = &pgs_pipe_outputs[i];
+    }
+    if (!p)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Reached max pipe output count, you can add `#define PGS_LOG_MAX_PIPE_OUTPUTS` and increase the number and recompile", 0);
+
+    if (fd < 0 || !pgs_log_fd_is_pipe(fd))
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "fd is not a pipe", 0);
+
+    p->fd = fd;
+    p->owned = owned;
+    p->spliced = true;
+    p->buffer = NULL;
+    p->pos = 0;
+
+    Pgs_Log_Error err = pgs_log_pipe_fresh_pages(p);
+    if (err != PGS_LOG_OK)
+        return err;
+
+    // a whole buffer fits into the pipe at once if we may grow it, otherwise vmsplice just takes it in parts
+    fcntl(fd, F_SETPIPE_SZ, PGS_LOG_VMSPLICE_BUFFER_SIZE);
+
+    p->in_use = true;
+    Pgs_Log_Sink sink = { .write = pgs_log_pipe_output_write, .flush = pgs_log_pipe_output_sync, .close = pgs_log_pipe_output_close, .unbuffered = true };
+    err = pgs_log_add_sink_output(sink, p);
+    if (err != PGS_LOG_OK) {
+        p->owned = false;
+        pgs_log_pipe_output_close(p);
+        return err;
+    }
+    return pgs_log_set_last_error(PGS_LOG_OK, "Added pipe output", 0);
+}
+
+Pgs_Log_Error pgs_log_remove_pipe_output(int fd) {
+    for (int i = 0; i < PGS_LOG_MAX_PIPE_OUTPUTS; ++i) {
+        if (pgs_pipe_outputs[i].in_use && pgs_pipe_outputs[i].fd == fd)
+            return pgs_log_remove_sink_output(&pgs_pipe_outputs[i]);
+    }
+
+    return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "fd does not exist in pipe outputs", 0);
+}
+
+bool pgs_log_pipe_output_is_spliced(int fd) {
+    for (int i = 0; i < PGS_LOG_MAX_PIPE_OUTPUTS; ++i) {
+        if (pgs_pipe_outputs[i].in_use && pgs_pipe_outputs[i].fd == fd) return pgs_pipe_outputs[i].spliced;
+    }
+    return false;
+}
+
+#endif // PGS_LOG_ENABLE_VMSPLICE
+
+#if PGS_LOG_ENABLE_COMPRESSION
+
+#include <fcntl.h>
+#if PGS_LOG_COMPRESS_ZLIB
+#   include <zlib.h>
+#endif
+
+// worst case of the LZ codec, zlib's compressBound() is below it
+#define PGS_LOG_COMPRESS_BOUND(n) ((n) + (n) / 255 + 16)
+#define PGS_LOG_LZ_HASH_BITS 12
+#define PGS_LOG_LZ_MIN_MATCH 4
+
+static Pgs_Log_Compressed_Output pgs_compressed_outputs[PGS_LOG_MAX_COMPRESSED_OUTPUTS];
+static unsigned char pgs_log_compress_frame[PGS_LOG_COMPRESS_HEADER_SIZE + PGS_LOG_COMPRESS_BOUND(PGS_LOG_COMPRESS_FRAME_SIZE)];
+
+static void pgs_log_put_le32(unsigned char *p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static void pgs_log_put_le64(unsigned char *p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static uint32_t pgs_log_get_le32(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t pgs_log_get_le64(const unsigned char *p) {
+    return (uint64_t)pgs_log_get_le32(p) | (uint64_t)pgs_log_get_le32(p + 4) << 32;
+}
+
+static size_t pgs_log_lz_length(unsigned char *out, size_t op, size_t len) {
+    for (; len >= 255; len -= 255) out[op++] = 255;
+    out[op++] = (unsigned char)len;
+    return op;
+}
+
+// one LZ4 style sequence: token, literal length, literals, offset, match length, `match_len` 0 for the last one
+static size_t pgs_log_lz_sequence(unsigned char *out, size_t op, const unsigned char *lit, size_t lit_len, size_t offset, size_t match_len) {
+    size_t extra = match_len ? match_len - PGS_LOG_LZ_MIN_MATCH : 0;
+    out[op++] = (unsigned char)((lit_len < 15 ? lit_len : 15) << 4 | (extra < 15 ? extra : 15));
+    if (lit_len >= 15) op = pgs_log_lz_length(out, op, lit_len - 15);
+    memcpy(out + op, lit, lit_len);
+    op += lit_len;
+    if (!match_len) return op;
+
+    out[op++] = (unsigned char)offset;
+    out[op++] = (unsigned char)(offset >> 8);
+    if (extra >= 15) op = pgs_log_lz_length(out, op, extra - 15);
+    return op;
+}
+
+// greedy single probe hash matcher, log lines repeat a lot so that is most of the win for very little time
+static size_t pgs_log_lz_compress(const unsigned char *in, size_t len, unsigned char *out) {
+    static uint32_t table[1 << PGS_LOG_LZ_HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    size_t ip = 0, anchor = 0, op = 0;
+    while (len >= 12 && ip + 12 <= len) {
+        uint32_t seq;
+        memcpy(&seq, in + ip, 4);
+        uint32_t h = (seq * 2654435761u) >> (32 - PGS_LOG_LZ_HASH_BITS);
+        size_t ref = table[h];
+        table[h] = (uint32_t)ip;
+
+        uint32_t found;
+        memcpy(&found, in + ref, 4);
+        if (ref >= ip || ip - ref > 65535 || found != seq) {
+            ip++;
+            continue;
+        }
+
+        // the last 5 bytes always stay literals so the decoder knows where to stop
+        size_t match = PGS_LOG_LZ_MIN_MATCH;
+        while (ip + match < len - 5 && in[ref + match] == in[ip + match]) match++;
+        op = pgs_log_lz_sequence(out, op, in + anchor, ip - anchor, ip - ref, match);
+        ip += match;
+        anchor = ip;
+    }
+    return pgs_log_lz_sequence(out, op, in + anchor, len - anchor, 0, 0);
+}
+
+static bool pgs_log_lz_read_length(const unsigned char *in, size_t len, size_t *ip, size_t *value) {
+    unsigned char b;
+    do {
+        if (*ip >= len) return false;
+        b = in[(*ip)++];
+        *value += b;
+    } while (b == 255);
+    return true;
+}
+
+// returns the decompressed length or -1 if `in` is not a valid frame that fits into `cap`
+static long pgs_log_lz_decompress(const unsigned char *in, size_t len, unsigned char *out, size_t cap) {
+    size_t ip = 0, op = 0;
+    while (ip < len) {
+        unsigned char token = in[ip++];
+        size_t lit = token >> 4;
+        if (lit == 15 && !pgs_log_lz_read_length(in, len, &ip, &lit)) return -1;
+        if (lit > len - ip || lit > cap - op) return -1;
+        memcpy(out + op, in + ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == len) break;
+
+        if (len - ip < 2) return -1;
+        size_t offset = (size_t)in[ip] | (size_t)in[ip + 1] << 8;
+        ip += 2;
+        size_t match = token & 15;
+        if (match == 15 && !pgs_log_lz_read_length(in, len, &ip, &match)) return -1;
+        match += PGS_LOG_LZ_MIN_MATCH;
+        if (offset == 0 || offset > op || match > cap - op) return -1;
+
+        // may overlap itself, byte by byte repeats the pattern
+        for (size_t k = 0; k < match; ++k, ++op) out[op] = out[op - offset];
+    }
+    return (long)op;
+}
+
+static Pgs_Log_Error pgs_log_compress_write_all(int fd, const void *data, size_t len) {
+    const char *p = data;
+    while (len > 0) {
+        ssize_t n = pgs_write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write compressed log file", errno);
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return PGS_LOG_OK;
+}
+
+static Pgs_Log_Error pgs_log_compress_index(Pgs_Log_Compressed_Output *c) {
+    unsigned char entry[16];
+    pgs_log_put_le64(entry, c->file_offset);
+    pgs_log_put_le64(entry + 8, c->raw_offset);
+    return pgs_log_compress_write_all(c->index_fd, entry, sizeof(entry));
+}
+
+static Pgs_Log_Error pgs_log_compress_frame_write(Pgs_Log_Compressed_Output *c, const char *data, size_t len) {
+    unsigned char *frame = pgs_log_compress_frame;
+    unsigned char *payload = frame + PGS_LOG_COMPRESS_HEADER_SIZE;
+    Pgs_Log_Codec codec = PGS_LOG_CODEC_LZ;
+    size_t packed;
+#if PGS_LOG_COMPRESS_ZLIB
+    uLongf zlen = (uLongf)PGS_LOG_COMPRESS_BOUND(PGS_LOG_COMPRESS_FRAME_SIZE);
+    codec = PGS_LOG_CODEC_ZLIB;
+    packed = compress2(payload, &zlen, (const Bytef *)data, (uLong)len, Z_BEST_SPEED) == Z_OK ? (size_t)zlen : len;
+#else
+    packed = pgs_log_lz_compress((const unsigned char *)data, len, payload);
+#endif
+    if (packed >= len) {
+        codec = PGS_LOG_CODEC_STORED;
+        memcpy(payload, data, len);
+        packed = len;
+    }
+
+    memcpy(frame, PGS_LOG_COMPRESS_MAGIC, 4);
+    frame[4] = (unsigned char)codec;
+    frame[5] = frame[6] = frame[7] = 0;
+    pgs_log_put_le32(frame + 8, (uint32_t)len);
+    pgs_log_put_le32(frame + 12, (uint32_t)packed);
+
+    // frame first, a frame without index entry is still reached by reading on from the one before
+    Pgs_Log_Error err = pgs_log_compress_write_all(c->fd, frame, PGS_LOG_COMPRESS_HEADER_SIZE + packed);
+    if (err != PGS_LOG_OK)
+        return err;
+    err = pgs_log_compress_index(c);
+    if (err != PGS_LOG_OK)
+        return err;
+
+    c->file_offset += PGS_LOG_COMPRESS_HEADER_SIZE + packed;
+    c->raw_offset += len;
+    return PGS_LOG_OK;
+}
+
+static Pgs_Log_Error pgs_log_compress_sink_write(void *ctx, const char *data, size_t len) {
+    Pgs_Log_Compressed_Output *c = ctx;
+    while (len > 0) {
+        size_t n = len < PGS_LOG_COMPRESS_FRAME_SIZE ? len : PGS_LOG_COMPRESS_FRAME_SIZE;
+        Pgs_Log_Error err = pgs_log_compress_frame_write(c, data, n);
+        if (err != PGS_LOG_OK)
+            return err;
+        data += n;
+        len -= n;
+    }
+    return PGS_LOG_OK;
+}
+
+static void pgs_log_compress_sink_close(void *ctx) {
+    Pgs_Log_Compressed_Output *c = ctx;
+    close(c->fd);
+    close(c->index_fd);
+    c->used = false;
+}
+
+// the index is only a seek aid and rebuilt on append, it never gets synced
+static int pgs_log_compress_sink_fd(void *ctx) {
+    Pgs_Log_Compressed_Output *c = ctx;
+    return c->fd;
+}
+
+static bool pgs_log_compress_read_header(int fd, uint64_t off, uint32_t *raw_len, uint32_t *packed_len, int *codec) {
+    unsigned char header[PGS_LOG_COMPRESS_HEADER_SIZE];
+    if (pread(fd, header, sizeof(header), (off_t)off) != (ssize_t)sizeof(header)) return false;
+    if (memcmp(header, PGS_LOG_COMPRESS_MAGIC, 4) != 0) return false;
+    *codec = header[4];
+    *raw_len = pgs_log_get_le32(header + 8);
+    *packed_len = pgs_log_get_le32(header + 12);
+    return true;
+}
+
+// walks the frames already in the file, cuts a torn tail and rebuilds the index to match
+static Pgs_Log_Error pgs_log_compress_resume(Pgs_Log_Compressed_Output *c) {
+    struct stat st;
+    if (fstat(c->fd, &st) != 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to stat compressed log file", errno);
+
+    uint32_t raw_len, packed_len;
+    int codec;
+    while (pgs_log_compress_read_header(c->fd, c->file_offset, &raw_len, &packed_len, &codec)
+           && c->file_offset + PGS_LOG_COMPRESS_HEADER_SIZE + packed_len <= (uint64_t)st.st_size) {
+        Pgs_Log_Error err = pgs_log_compress_index(c);
+        if (err != PGS_LOG_OK)
+            return err;
+        c->file_offset += PGS_LOG_COMPRESS_HEADER_SIZE + packed_len;
+        c->raw_offset += raw_len;
+    }
+
+    if (c->file_offset < (uint64_t)st.st_size && ftruncate(c->fd, (off_t)c->file_offset) != 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to cut torn compressed frame", errno);
+    return PGS_LOG_OK;
+}
+
+static void pgs_log_compress_index_path(char *out, const char *path) {
+    snprintf(out, PGS_LOG_MAX_PATH_LEN, "%s.idx", path);
+}
+
+Pgs_Log_Error pgs_log_add_compressed_output(const char *path, bool append) {
+    if (!path || strlen(path) >= PGS_LOG_MAX_PATH_LEN - 4)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No or too long path passed", 0);
+
+    Pgs_Log_Compressed_Output *c = NULL;
+    for (int i = 0; i < PGS_LOG_MAX_COMPRESSED_OUTPUTS; ++i) {
+        if (pgs_compressed_outputs[i].used && strcmp(pgs_compressed_outputs[i].path, path) == 0)
+            return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Compressed output already added", 0);
+        if (!pgs_compressed_outputs[i].used && !c) c = &pgs_compressed_outputs[i];
+    }
+    if (!c)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Reached max compressed output count, you can add `#define PGS_LOG_MAX_COMPRESSED_OUTPUTS` and increase the number and recompile", 0);
+
+    if (pgs_log_create_dirs_for_path(path) != PGS_LOG_OK)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to create dirs for compressed log file", 0);
+
+    char index_path[PGS_LOG_MAX_PATH_LEN];
+    pgs_log_compress_index_path(index_path, path);
+    c->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC | (append ? 0 : O_TRUNC), 0644);
+    if (c->fd < 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open compressed log file", errno);
+    c->index_fd = open(index_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (c->index_fd < 0) {
+        close(c->fd);
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open compressed log index", errno);
+    }
+
+    strcpy(c->path, path);
+    c->file_offset = 0;
+    c->raw_offset = 0;
+    Pgs_Log_Error err = append ? pgs_log_compress_resume(c) : PGS_LOG_OK;
+    if (err == PGS_LOG_OK && lseek(c->fd, (off_t)c->file_offset, SEEK_SET) < 0)
+        err = pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to seek compressed log file", errno);
+    if (err != PGS_LOG_OK) {
+        close(c->fd);
+        close(c->index_fd);
+        return err;
+    }
+
+    c->used = true;
+    Pgs_Log_Sink sink = { .write = pgs_log_compress_sink_write, .close = pgs_log_compress_sink_close, .sync_fd = pgs_log_compress_sink_fd };
+    err = pgs_log_add_sink_output(sink, c);
+    if (err != PGS_LOG_OK) {
+        pgs_log_compress_sink_close(c);
+        return err;
+    }
+    return pgs_log_set_last_error(PGS_LOG_OK, "Added compressed output", 0);
+}
+
+Pgs_Log_Error pgs_log_remove_compressed_output(const char *path) {
+    for (int i = 0; i < PGS_LOG_MAX_COMPRESSED_OUTPUTS; ++i) {
+        if (pgs_compressed_outputs[i].used && strcmp(pgs_compressed_outputs[i].path, path) == 0)
+            return pgs_log_remove_sink_output(&pgs_compressed_outputs[i]);
+    }
+    return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Path does not exist in compressed outputs", 0);
+}
+
+// file offset of the frame holding uncompressed offset `from`, binary search over the index
+static uint64_t pgs_log_compress_seek(const char *path, uint64_t from, uint64_t *raw_start) {
+    char index_path[PGS_LOG_MAX_PATH_LEN];
+    pgs_log_compress_index_path(index_path, path);
+    *raw_start = 0;
+    int fd = open(index_path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    uint64_t found = 0;
+    size_t lo = 0, hi = fstat(fd, &st) == 0 ? (size_t)st.st_size / 16 : 0;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        unsigned char entry[16];
+        if (pread(fd, entry, sizeof(entry), (off_t)(mid * 16)) != (ssize_t)sizeof(entry)) break;
+        if (pgs_log_get_le64(entry + 8) > from) {
+            hi = mid;
+            continue;
+        }
+        found = pgs_log_get_le64(entry);
+        *raw_start = pgs_log_get_le64(entry + 8);
+        lo = mid + 1;
+    }
+    close(fd);
+    return found;
+}
+
+Pgs_Log_Error pgs_log_compressed_dump(const char *path, uint64_t from, const char *out_path) {
+    if (!path || !out_path)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No path passed", 0);
+
+    static unsigned char packed[PGS_LOG_COMPRESS_BOUND(PGS_LOG_COMPRESS_FRAME_SIZE)];
+    static unsigned char raw[PGS_LOG_COMPRESS_FRAME_SIZE];
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open compressed log file", errno);
+    FILE *out = fopen(out_path, "wb");
+    Pgs_Log_Error err = out ? PGS_LOG_OK : pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open compressed dump file", errno);
+
+    uint64_t raw_off;
+    uint64_t off = pgs_log_compress_seek(path, from, &raw_off);
+    uint32_t raw_len, packed_len;
+    int codec;
+    while (err == PGS_LOG_OK && pgs_log_compress_read_header(fd, off, &raw_len, &packed_len, &codec)) {
+        if (raw_len > sizeof(raw) || packed_len > sizeof(packed)) {
+            err = pgs_log_set_last_error(PGS_LOG_ERR, "Compressed frame larger than `PGS_LOG_COMPRESS_FRAME_SIZE`", 0);
+            break;
+        }
+        // a torn last frame ends the readable part
+        if (pread(fd, packed, packed_len, (off_t)(off + PGS_LOG_COMPRESS_HEADER_SIZE)) != (ssize_t)packed_len) break;
+
+        long n = -1;
+        if (codec == PGS_LOG_CODEC_STORED && packed_len == raw_len) {
+            memcpy(raw, packed, raw_len);
+            n = (long)raw_len;
+        }
+        else if (codec == PGS_LOG_CODEC_LZ) {
+            n = pgs_log_lz_decompress(packed, packed_len, raw, sizeof(raw));
+        }
+#if PGS_LOG_COMPRESS_ZLIB
+        else if (codec == PGS_LOG_CODEC_ZLIB) {
+            uLongf zlen = sizeof(raw);
+            n = uncompress(raw, &zlen, packed, packed_len) == Z_OK ? (long)zlen : -1;
+        }
+#endif
+        if (n != (long)raw_len) {
+            err = pgs_log_set_last_error(PGS_LOG_ERR, "Corrupt or unsupported compressed frame", 0);
+            break;
+        }
+
+        size_t skip = from > raw_off ? (size_t)(from - raw_off < raw_len ? from - raw_off : raw_len) : 0;
+        if (fwrite(raw + skip, 1, raw_len - skip, out) != raw_len - skip)
+            err = pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write compressed dump file", errno);
+        off += PGS_LOG_COMPRESS_HEADER_SIZE + packed_len;
+        raw_off += raw_len;
+    }
+
+    close(fd);
+    if (out && fclose(out) != 0 && err == PGS_LOG_OK)
+        err = pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write compressed dump file", errno);
+
+    if (err != PGS_LOG_OK)
+        return err;
+    return pgs_log_set_last_error(PGS_LOG_OK, "Dumped compressed log file", 0);
+}
+
+#endif // PGS_LOG_ENABLE_COMPRESSION
+
+#if PGS_LOG_ENABLE_IO_URING
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+
+typedef struct {
+    int fd;                                         // -1 not set up yet, -2 not available
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    unsigned to_submit;
+} Pgs_Log_Uring;
+
+static Pgs_Log_Uring pgs_log_uring = { .fd = -1 };
+
+// sets the ring up on first use, rings live until the process exits
+static bool pgs_log_uring_available(void) {
+    if (pgs_log_uring.fd >= 0) return true;
+    if (pgs_log_uring.fd == -2) return false;
+    pgs_log_uring.fd = -2;
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = (int)syscall(__NR_io_uring_setup, PGS_LOG_IO_URING_ENTRIES, &p);
+    if (fd < 0) return false;
+
+    // IORING_OP_WRITE at the current file position came with 5.6
+    if (!(p.features & IORING_FEAT_RW_CUR_POS)) {
+        close(fd);
+        return false;
+    }
+
+    size_t sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    size_t cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && cq_size > sq_size) sq_size = cq_size;
+
+    unsigned char *sq = mmap(NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    unsigned char *cq = sq;
+    if (!single_mmap) {
+        cq = mmap(NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED) {
+            munmap(sq, sq_size);
+            close(fd);
+            return false;
+        }
+    }
+
+    struct io_uring_sqe *sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        if (!single_mmap) munmap(cq, cq_size);
+        munmap(sq, sq_size);
+        close(fd);
+        return false;
+    }
+
+    pgs_log_uring.sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    pgs_log_uring.sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    pgs_log_uring.sq_array = (unsigned *)(sq + p.sq_off.array);
+    pgs_log_uring.cq_head = (unsigned *)(cq + p.cq_off.head);
+    pgs_log_uring.cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    pgs_log_uring.cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    pgs_log_uring.cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    pgs_log_uring.sqes = sqes;
+    pgs_log_uring.to_submit = 0;
+    pgs_log_uring.fd = fd;
+    return true;
+}
+
+bool pgs_log_io_uring_active(void) {
+    return pgs_log_uring_available();
+}
+
+// only the oldest queued buffer of an output is ever in flight, keeps the file contents in order
+static void pgs_log_uring_queue_write(int output_index) {
+    Pgs_Log_Output *o = &pgs_outputs[output_index];
+    Pgs_Log_Uring *u = &pgs_log_uring;
+
+    unsigned tail = *u->sq_tail;
+    unsigned slot = tail & *u->sq_mask;
+    struct io_uring_sqe *sqe = &u->sqes[slot];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = o->queued_fds[o->queue_head];
+    sqe->off = (__u64)-1;
+    sqe->addr = (__u64)(uintptr_t)(o->buffers[o->queue_head] + o->queued_done);
+    sqe->len = (__u32)(o->queued_lens[o->queue_head] - o->queued_done);
+    sqe->user_data = (__u64)output_index;
+    u->sq_array[slot] = slot;
+    __atomic_store_n(u->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    u->to_submit++;
+    o->in_flight = true;
+}
+
+static Pgs_Log_Error pgs_log_uring_enter(unsigned min_complete) {
+    Pgs_Log_Uring *u = &pgs_log_uring;
+    unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+
+    for (;;) {
+        int submitted = (int)syscall(__NR_io_uring_enter, u->fd, u->to_submit, min_complete, flags, NULL, 0);
+        if (submitted < 0) {
+            if (errno == EINTR) continue;
+            return pgs_log_set_last_error(PGS_LOG_ERR_IO, "io_uring_enter failed", errno);
+        }
+        u->to_submit -= (unsigned)submitted < u->to_submit ? (unsigned)submitted : u->to_submit;
+        return PGS_LOG_OK;
+    }
+}
+
+static Pgs_Log_Error pgs_log_uring_reap(void) {
+    Pgs_Log_Uring *u = &pgs_log_uring;
+    Pgs_Log_Error result = PGS_LOG_OK;
+    unsigned head = *u->cq_head;
+
+    while (head != __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE)) {
+        struct io_uring_cqe *cqe = &u->cqes[head & *u->cq_mask];
+        int output_index = (int)cqe->user_data;
+        int res = cqe->res;
+        head++;
+        __atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+
+        Pgs_Log_Output *o = &pgs_outputs[output_index];
+        size_t len = o->queued_lens[o->queue_head];
+        o->in_flight = false;
+
+        if (res <= 0) {
+            // write the rest the blocking way so nothing gets lost or reordered
+            size_t rest = len - o->queued_done;
+            if (pgs_write(o->queued_fds[o->queue_head], o->buffers[o->queue_head] + o->queued_done, rest) != (ssize_t)rest)
+                result = pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write buffer to file", res < 0 ? -res : errno);
+            o->queued_done = len;
+        } else {
+            o->queued_done += (size_t)res;
+        }
+
+        if (o->queued_done >= len) {
+            o->queue_head = (o->queue_head + 1) % PGS_LOG_OUTPUT_BUFFERS;
+            o->queued--;
+            o->queued_done = 0;
+        }
+
+        if (o->queued > 0)
+            pgs_log_uring_queue_write(output_index);
+    }
+
+    return result;
+}
+
+static Pgs_Log_Error pgs_log_uring_wait(Pgs_Log_Output *o, int max_queued) {
+    Pgs_Log_Error result = PGS_LOG_OK;
+    while (o->queued > max_queued) {
+        Pgs_Log_Error err = pgs_log_uring_enter(1);
+        if (err != PGS_LOG_OK) return err;
+        err = pgs_log_uring_reap();
+        if (err != PGS_LOG_OK) result = err;
+    }
+    return result;
+}
+
+static Pgs_Log_Error pgs_log_uring_submit(void) {
+    if (pgs_log_uring.fd < 0 || pgs_log_uring.to_submit == 0) return PGS_LOG_OK;
+    return pgs_log_uring_enter(0);
+}
+
+#endif // PGS_LOG_ENABLE_IO_URING
+
+#if PGS_LOG_ENABLE_FLUSH_THREAD
+
+#include <fcntl.h>
+#include <pthread.h>
+
+// the flusher only touches queued buffers and the queue fields, both under `lock`, the caller keeps appending to
+// its current buffer without it
+static struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    int state;                  // 0 not started, 1 running, -1 unavailable
+    bool stop;
+    int next;                   // output to look at first, keeps one busy output from starving the others
+    int error;                  // errno of the last failed background write, reported by the next hand off
+} pgs_log_flusher = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+static void *pgs_log_flusher_main(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&pgs_log_flusher.lock);
+    for (;;) {
+        Pgs_Log_Output *o = NULL;
+        for (int n = 0; n < pgs_output_count && !o; ++n) {
+            int i = (pgs_log_flusher.next + n) % pgs_output_count;
+            if (pgs_outputs[i].queued > 0) {
+                o = &pgs_outputs[i];
+                pgs_log_flusher.next = i + 1;
+            }
+        }
+
+        if (!o) {
+            if (pgs_log_flusher.stop) break;
+            pthread_cond_wait(&pgs_log_flusher.work, &pgs_log_flusher.lock);
+            continue;
+        }
+
+        // the output can not move or close while in flight, remove/cleanup wait for its queue to empty
+        int fd = o->queued_fds[o->queue_head];
+        const char *buf = o->buffers[o->queue_head];
+        size_t len = o->queued_lens[o->queue_head];
+        o->in_flight = true;
+        pthread_mutex_unlock(&pgs_log_flusher.lock);
+
+        // a pipe or socket can take part of the buffer, keep going until all of it is written
+        int err = 0;
+        for (size_t done = 0; done < len;) {
+            ssize_t res = pgs_write(fd, buf + done, len - done);
+            if (res < 0 && errno == EINTR) continue;
+            if (res <= 0) {
+                err = res < 0 ? errno : EIO;
+                break;
+            }
+            done += (size_t)res;
+        }
+
+        pthread_mutex_lock(&pgs_log_flusher.lock);
+        if (err != 0) pgs_log_flusher.error = err;
+        o->in_flight = false;
+        o->queue_head = (o->queue_head + 1) % PGS_LOG_OUTPUT_BUFFERS;
+        o->queued--;
+        pthread_cond_broadcast(&pgs_log_flusher.done);
+    }
+    pthread_mutex_unlock(&pgs_log_flusher.lock);
+
+    return NULL;
+}
+
+static void *pgs_log_interrupt_main(void *arg) {
+    (void)arg;
+    char c;
+    while (read(pgs_log_interrupt_pipe[0], &c, 1) < 0 && errno == EINTR) {}
+    pgs_log_cleanup();
+    exit(130);
+}
+
+// a forked child has neither thread, its SIGINT must not wake the parent's helper
+static void pgs_log_flusher_prepare_fork(void) {
+    pthread_mutex_lock(&pgs_log_flusher.lock);
+}
+
+static void pgs_log_flusher_parent_fork(void) {
+    pthread_mutex_unlock(&pgs_log_flusher.lock);
+}
+
+static void pgs_log_flusher_child_fork(void) {
+    pthread_mutex_unlock(&pgs_log_flusher.lock);
+    if (pgs_log_flusher.state > 0) pgs_log_flusher.state = 0;
+    if (pgs_log_interrupt_pipe[0] >= 0) {
+        close(pgs_log_interrupt_pipe[0]);
+        close(pgs_log_interrupt_pipe[1]);
+        pgs_log_interrupt_pipe[0] = pgs_log_interrupt_pipe[1] = -1;
+    }
+}
+
+// started with the first flusher of the process and kept across cleanups, blocked in read() until SIGINT
+static void pgs_log_interrupt_start(void) {
+    static bool fork_handlers = false;
+    if (!fork_handlers)
+        fork_handlers = pthread_atfork(pgs_log_flusher_prepare_fork, pgs_log_flusher_parent_fork, pgs_log_flusher_child_fork) == 0;
+    if (pgs_log_interrupt_pipe[0] >= 0) return;
+
+    int fds[2];
+    if (pipe(fds) != 0) return;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+
+    pthread_t thread;
+    pgs_log_interrupt_pipe[0] = fds[0];
+    if (pthread_create(&thread, NULL, pgs_log_interrupt_main, NULL) != 0) {
+        close(fds[0]);
+        close(fds[1]);
+        pgs_log_interrupt_pipe[0] = -1;
+        return;
+    }
+    pthread_detach(thread);
+    pgs_log_interrupt_pipe[1] = fds[1];
+}
+
+static bool pgs_log_flusher_available(void) {
+    if (pgs_log_flusher.state == 0) {
+        pgs_log_flusher.stop = false;
+        pgs_log_flusher.state = pthread_create(&pgs_log_flusher.thread, NULL, pgs_log_flusher_main, NULL) == 0 ? 1 : -1;
+        if (pgs_log_flusher.state > 0) pgs_log_interrupt_start();
+    }
+    return pgs_log_flusher.state > 0;
+}
+
+static Pgs_Log_Error pgs_log_flusher_take_error(void) {
+    int err = pgs_log_flusher.error;
+    pgs_log_flusher.error = 0;
+    if (err != 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Flush thread failed to write buffer to file", err);
+    return PGS_LOG_OK;
+}
+
+// blocks until at most `max_queued` buffers of `o` are waiting to be written
+static Pgs_Log_Error pgs_log_flusher_wait(Pgs_Log_Output *o, int max_queued) {
+    if (pgs_log_flusher.state <= 0) return PGS_LOG_OK;
+
+    pthread_mutex_lock(&pgs_log_flusher.lock);
+    while (o->queued > max_queued)
+        pthread_cond_wait(&pgs_log_flusher.done, &pgs_log_flusher.lock);
+    Pgs_Log_Error err = pgs_log_flusher_take_error();
+    pthread_mutex_unlock(&pgs_log_flusher.lock);
+
+    return err;
+}
+
+static void pgs_log_flusher_stop(void) {
+    if (pgs_log_flusher.state <= 0) return;
+
+    pthread_mutex_lock(&pgs_log_flusher.lock);
+    pgs_log_flusher.stop = true;
+    pthread_cond_signal(&pgs_log_flusher.work);
+    pthread_mutex_unlock(&pgs_log_flusher.lock);
+
+    pthread_join(pgs_log_flusher.thread, NULL);
+    pgs_log_flusher.state = 0;
+}
+
+bool pgs_log_flush_thread_active(void) {
+    return pgs_log_flusher.state > 0;
+}
+
+#define PGS_LOG_FLUSHER_LOCK() pthread_mutex_lock(&pgs_log_flusher.lock)
+#define PGS_LOG_FLUSHER_UNLOCK() pthread_mutex_unlock(&pgs_log_flusher.lock)
+
+#else
+#define PGS_LOG_FLUSHER_LOCK()
+#define PGS_LOG_FLUSHER_UNLOCK()
+#endif // PGS_LOG_ENABLE_FLUSH_THREAD
+
+#if PGS_LOG_ENABLE_NONBLOCKING
+
+#include <fcntl.h>
+#include <poll.h>
+
+// io_uring and the flush thread would spin on EAGAIN, non-blocking outputs stay on the calling thread
+#define PGS_LOG_OUTPUT_ASYNC(o) ((o)->fd >= 0 && !(o)->nonblocking && PGS_LOG_TERMINAL_QUEUES(o))
+
+static void pgs_log_nonblock_count_drop(Pgs_Log_Output *o, const char *data, size_t len) {
+    for (const char *p = data; (p = memchr(p, '\n', (size_t)(data + len - p))) != NULL; ++p)
+        o->dropped_entries++;
+    o->dropped_bytes += len;
+}
+
+static char *pgs_log_nonblock_pending_alloc(void) {
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+    return pgs_log_mem_alloc(PGS_LOG_NONBLOCK_PENDING_SIZE);
+#else
+    return malloc(PGS_LOG_NONBLOCK_PENDING_SIZE);
+#endif
+}
+
+static void pgs_log_nonblock_pending_free(Pgs_Log_Output *o) {
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+    pgs_log_mem_free(o->pending, PGS_LOG_NONBLOCK_PENDING_SIZE);
+#else
+    free(o->pending);
+#endif
+    o->pending = NULL;
+}
+
+// `O_NONBLOCK` belongs to the open file description, which a terminal or pipe shares with the shell and every
+// other process that inherited it, linux can open the same tty/pipe again through /proc so only our own
+// description turns non-blocking, everything else (sockets, other systems) falls back to the shared one
+static int pgs_log_nonblock_open(int fd, int flags) {
+#ifdef __linux__
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (S_ISFIFO(st.st_mode) || S_ISCHR(st.st_mode))) {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+        int own = open(path, O_WRONLY | O_NONBLOCK | O_NOCTTY | O_CLOEXEC | (flags & O_APPEND));
+        if (own >= 0) return own;
+    }
+#endif
+    if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) return -1;
+    return fd;
+}
+
+// undoes pgs_log_nonblock_open(), the shared description gets its flags back
+static void pgs_log_nonblock_put_back(Pgs_Log_Output *o) {
+    if (o->write_fd != o->fd) close(o->write_fd);
+    else fcntl(o->fd, F_SETFL, o->fd_flags);
+    o->write_fd = o->fd;
+    pgs_log_nonblock_pending_free(o);
+}
+
+// writes as much of the pending tail as the fd takes right now
+static Pgs_Log_Error pgs_log_nonblock_drain(Pgs_Log_Output *o) {
+    while (o->pending_len > 0) {
+        ssize_t n = pgs_write(o->write_fd, o->pending + o->pending_off, o->pending_len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return PGS_LOG_OK;
+            return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write pending output", errno);
+        }
+        o->pending_off += (size_t)n;
+        o->pending_len -= (size_t)n;
+        o->mid_entry = o->pending[o->pending_off - 1] != '\n';
+    }
+    o->pending_off = 0;
+    return PGS_LOG_OK;
+}
+
+// drops whole entries from the front until `needed` bytes are free or nothing droppable is left, the rest of an
+// entry the fd already got part of stays
+static void pgs_log_nonblock_drop_oldest(Pgs_Log_Output *o, size_t needed) {
+    size_t start = o->pending_off;
+    size_t end = o->pending_off + o->pending_len;
+    if (o->mid_entry) {
+        const char *nl = memchr(o->pending + start, '\n', end - start);
+        start = nl ? (size_t)(nl - o->pending) + 1 : end;
+    }
+
+    size_t drop_end = start;
+    while (drop_end < end && drop_end - start < needed) {
+        const char *nl = memchr(o->pending + drop_end, '\n', end - drop_end);
+        drop_end = nl ? (size_t)(nl - o->pending) + 1 : end;
+    }
+
+    pgs_log_nonblock_count_drop(o, o->pending + start, drop_end - start);
+    memmove(o->pending + start, o->pending + drop_end, end - drop_end);
+    o->pending_len -= drop_end - start;
+}
+
+static void pgs_log_nonblock_append(Pgs_Log_Output *o, const char *data, size_t len) {
+    if (o->pending_off + o->pending_len + len > PGS_LOG_NONBLOCK_PENDING_SIZE) {
+        memmove(o->pending, o->pending + o->pending_off, o->pending_len);
+        o->pending_off = 0;
+    }
+    memcpy(o->pending + o->pending_off + o->pending_len, data, len);
+    o->pending_len += len;
+}
+
+// length of the whole entries at the start of `data` that fit into `room`
+static size_t pgs_log_whole_entries(const char *data, size_t len, size_t room) {
+    size_t fit = len < room ? len : room;
+    while (fit > 0 && data[fit - 1] != '\n') fit--;
+    return fit;
+}
+
+// `data` is whole entries, keeps them pending as far as the policy allows
+static Pgs_Log_Error pgs_log_nonblock_keep(Pgs_Log_Output *o, const char *data, size_t len) {
+    const size_t cap = PGS_LOG_NONBLOCK_PENDING_SIZE;
+
+    while (o->overflow == PGS_LOG_OVERFLOW_BLOCK && o->pending_len + len > cap) {
+        struct pollfd p = { .fd = o->write_fd, .events = POLLOUT };
+        if (poll(&p, 1, -1) < 0 && errno != EINTR)
+            return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to poll output", errno);
+
+        Pgs_Log_Error err = pgs_log_nonblock_drain(o);
+        if (err != PGS_LOG_OK)
+            return err;
+        if (o->pending_len > 0) continue;
+
+        // larger than the whole cap, the fd has to take the front directly
+        ssize_t n = pgs_write(o->write_fd, data, len);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write to file", errno);
+        if (n > 0) {
+            data += n;
+            len -= (size_t)n;
+            o->mid_entry = data[-1] != '\n';
+        }
+        if (o->mid_entry) {
+            // the rest of that entry always stays
+            const char *nl = memchr(data, '\n', len);
+            size_t rest = nl ? (size_t)(nl - data) + 1 : len;
+            pgs_log_nonblock_append(o, data, rest);
+            data += rest;
+            len -= rest;
+        }
+    }
+
+    if (o->pending_len + len > cap && o->overflow == PGS_LOG_OVERFLOW_DROP_OLDEST) {
+        pgs_log_nonblock_drop_oldest(o, o->pending_len + len - cap);
+        if (o->pending_len + len > cap) {
+            // the new entries alone are too many, only their newest ones fit
+            size_t skip = 0;
+            while (len - skip > cap - o->pending_len) {
+                const char *nl = memchr(data + skip, '\n', len - skip);
+                skip = nl ? (size_t)(nl - data) + 1 : len;
+            }
+            pgs_log_nonblock_count_drop(o, data, skip);
+            data += skip;
+            len -= skip;
+        }
+    }
+
+    size_t fit = pgs_log_whole_entries(data, len, cap - o->pending_len);
+    pgs_log_nonblock_append(o, data, fit);
+    if (fit < len) pgs_log_nonblock_count_drop(o, data + fit, len - fit);
+    return PGS_LOG_OK;
+}
+
+// never waits for the fd (except with PGS_LOG_OVERFLOW_BLOCK), whatever it does not take goes to the pending tail
+static Pgs_Log_Error pgs_log_nonblock_write(Pgs_Log_Output *o, const char *data, size_t len) {
+    Pgs_Log_Error err = pgs_log_nonblock_drain(o);
+    if (err != PGS_LOG_OK)
+        return err;
+
+    size_t done = 0;
+    while (o->pending_len == 0 && done < len) {
+        ssize_t n = pgs_write(o->write_fd, data + done, len - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write to file", errno);
+            break;
+        }
+        done += (size_t)n;
+        o->mid_entry = data[done - 1] != '\n';
+    }
+
+    if (done == len) return PGS_LOG_OK;
+    o->stalls++;
+
+    if (o->mid_entry && o->pending_len == 0) {
+        // the fd got part of an entry, its rest is kept no matter the policy
+        const char *nl = memchr(data + done, '\n', len - done);
+        size_t rest = nl ? (size_t)(nl - (data + done)) + 1 : len - done;
+        pgs_log_nonblock_append(o, data + done, rest);
+        done += rest;
+    }
+    return pgs_log_nonblock_keep(o, data + done, len - done);
+}
+
+// gives the pending tail up to `timeout_ms` to drain, drops what is left and puts the fd back to blocking
+static void pgs_log_nonblock_release(Pgs_Log_Output *o, int timeout_ms) {
+    if (!o->nonblocking) return;
+
+    uint64_t deadline = pgs_log_now_ms() + (uint64_t)timeout_ms;
+    while (o->pending_len > 0 && pgs_log_nonblock_drain(o) == PGS_LOG_OK && o->pending_len > 0) {
+        uint64_t now = pgs_log_now_ms();
+        struct pollfd p = { .fd = o->write_fd, .events = POLLOUT };
+        if (now >= deadline || poll(&p, 1, (int)(deadline - now)) == 0) break;
+    }
+    if (o->pending_len > 0) pgs_log_nonblock_count_drop(o, o->pending + o->pending_off, o->pending_len);
+    o->pending_len = 0;
+    o->pending_off = 0;
+
+    pgs_log_nonblock_put_back(o);
+    o->nonblocking = false;
+}
+
+static Pgs_Log_Output *pgs_log_find_fd_output(int fd) {
+    for (int i = 0; i < pgs_output_count; ++i) {
+        if (pgs_outputs[i].fd == fd) return &pgs_outputs[i];
+    }
+    return NULL;
+}
+
+#else
+#define PGS_LOG_OUTPUT_ASYNC(o) ((o)->fd >= 0 && PGS_LOG_TERMINAL_QUEUES(o))
+#endif // PGS_LOG_ENABLE_NONBLOCKING
+
+#if PGS_LOG_ENABLE_EVENT_LOOP
+
+#include <fcntl.h>
+#include <poll.h>
+
+// writes queued buffers of `o` oldest first, at most `budget` bytes, without `block` it stops where the fd would
+// block, returns the bytes written
+static size_t pgs_log_loop_write(Pgs_Log_Output *o, size_t budget, bool block, Pgs_Log_Error *err) {
+    size_t spent = 0;
+    while (o->queued > 0 && spent < budget) {
+        size_t len = o->queued_lens[o->queue_head];
+        size_t rest = len - o->queued_done;
+        if (rest > budget - spent) rest = budget - spent;
+
+        int fd = o->queued_fds[o->queue_head];
+        ssize_t n = pgs_write(fd, o->buffers[o->queue_head] + o->queued_done, rest);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!block) break;
+                struct pollfd p = { .fd = fd, .events = POLLOUT };
+                poll(&p, 1, -1);
+                continue;
+            }
+            // the buffer is lost, retrying a broken fd from every loop iteration helps nobody
+            *err = pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write to file", errno);
+            n = (ssize_t)(len - o->queued_done);
+        }
+
+        o->queued_done += (size_t)n;
+        spent += (size_t)n;
+        if (o->queued_done >= len) {
+            o->queued_done = 0;
+            o->queue_head = (o->queue_head + 1) % PGS_LOG_OUTPUT_BUFFERS;
+            o->queued--;
+        }
+    }
+    return spent;
+}
+
+// the log call writes itself when all buffers are queued or an entry is larger than a buffer, a non-blocking fd
+// then has to wait like a blocking one would
+static Pgs_Log_Error pgs_log_loop_write_now(int fd, const char *data, size_t len, const char *msg) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = pgs_write(fd, data + done, len - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd p = { .fd = fd, .events = POLLOUT };
+                poll(&p, 1, -1);
+                continue;
+            }
+            return pgs_log_set_last_error(PGS_LOG_ERR_IO, msg, errno);
+        }
+        done += (size_t)n;
+    }
+    return PGS_LOG_OK;
+}
+
+// the loop must never stall on an fd, restored when the output goes away
+static void pgs_log_loop_set_nonblocking(Pgs_Log_Output *o) {
+    o->loop_fd_flags = -1;
+    if (o->fd < 0) return;
+
+    int flags = fcntl(o->fd, F_GETFL);
+    if (flags < 0 || (flags & O_NONBLOCK)) return;
+    if (fcntl(o->fd, F_SETFL, flags | O_NONBLOCK) == 0) o->loop_fd_flags = flags;
+}
+
+static void pgs_log_loop_restore_blocking(Pgs_Log_Output *o) {
+    if (o->loop_fd_flags >= 0) fcntl(o->fd, F_SETFL, o->loop_fd_flags);
+    o->loop_fd_flags = -1;
+}
+
+static void pgs_log_loop_queue(Pgs_Log_Output *o) {
+    if (o->queued == 0) o->queue_head = o->buf_index;
+    o->queued_lens[o->buf_index] = o->buf_pos;
+    o->queued_fds[o->buf_index] = o->fd;
+    o->queued++;
+    o->buf_index = (o->buf_index + 1) % PGS_LOG_OUTPUT_BUFFERS;
+    o->buf_pos = 0;
+}
+
+#endif // PGS_LOG_ENABLE_EVENT_LOOP
+
+static Pgs_Log_Error pgs_log_output_write(Pgs_Log_Output *o, const char *data, size_t len) {
+#if PGS_LOG_ENABLE_NONBLOCKING
+    if (o->nonblocking) return pgs_log_nonblock_write(o, data, len);
+#endif
+    return o->sink.write(o->ctx, data, len);
+}
+
+#if PGS_LOG_ENABLE_BUFFERING
+// gets the current buffer of `o` written (or on its way to be written) and leaves an empty one to append to
+static Pgs_Log_Error pgs_log_output_hand_off(Pgs_Log_Output *o) {
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    if (PGS_LOG_OUTPUT_ASYNC(o)) {
+        if (o->buf_pos == 0) return PGS_LOG_OK;
+
+        // the loop fell behind and every other buffer is still queued, the oldest goes out right here
+        Pgs_Log_Error err = PGS_LOG_OK;
+        if (o->queued == PGS_LOG_OUTPUT_BUFFERS - 1)
+            pgs_log_loop_write(o, o->queued_lens[o->queue_head] - o->queued_done, true, &err);
+
+        pgs_log_loop_queue(o);
+        pgs_log_loop_signal();
+        return err;
+    }
+#endif
+#if PGS_LOG_ENABLE_IO_URING
+    if (PGS_LOG_OUTPUT_ASYNC(o) && pgs_log_uring_available()) {
+        Pgs_Log_Error err = pgs_log_uring_reap();
+        if (o->buf_pos == 0) return err;
+
+        if (o->queued == 0) o->queue_head = o->buf_index;
+        o->queued_lens[o->buf_index] = o->buf_pos;
+        o->queued_fds[o->buf_index] = o->fd;
+        o->queued++;
+        if (!o->in_flight) pgs_log_uring_queue_write((int)(o - pgs_outputs));
+
+        // only stall if every other buffer is still in flight
+        Pgs_Log_Error wait_err = pgs_log_uring_wait(o, PGS_LOG_OUTPUT_BUFFERS - 1);
+        if (wait_err != PGS_LOG_OK) err = wait_err;
+
+        o->buf_index = (o->buf_index + 1) % PGS_LOG_OUTPUT_BUFFERS;
+        o->buf_pos = 0;
+        return err;
+    }
+#endif
+#if PGS_LOG_ENABLE_FLUSH_THREAD
+    if (PGS_LOG_OUTPUT_ASYNC(o) && pgs_log_flusher_available()) {
+        if (o->buf_pos == 0) return PGS_LOG_OK;
+
+        pthread_mutex_lock(&pgs_log_flusher.lock);
+        if (o->queued == 0) o->queue_head = o->buf_index;
+        o->queued_lens[o->buf_index] = o->buf_pos;
+        o->queued_fds[o->buf_index] = o->fd;
+        o->queued++;
+        pthread_cond_signal(&pgs_log_flusher.work);
+
+        // only stall if every other buffer is still waiting for the flusher
+        while (o->queued > PGS_LOG_OUTPUT_BUFFERS - 1)
+            pthread_cond_wait(&pgs_log_flusher.done, &pgs_log_flusher.lock);
+        Pgs_Log_Error err = pgs_log_flusher_take_error();
+        pthread_mutex_unlock(&pgs_log_flusher.lock);
+
+        o->buf_index = (o->buf_index + 1) % PGS_LOG_OUTPUT_BUFFERS;
+        o->buf_pos = 0;
+        return err;
+    }
+#endif
+    if (o->buf_pos == 0) return PGS_LOG_OK;
+
+    Pgs_Log_Error err = pgs_log_output_write(o, PGS_LOG_OUTPUT_BUFFER(o), o->buf_pos);
+    if (err != PGS_LOG_OK)
+        return err;
+
+    o->buf_pos = 0;
+    return PGS_LOG_OK;
+}
+
+// everything buffered for `o` is written once this returns
+static Pgs_Log_Error pgs_log_output_drain(Pgs_Log_Output *o) {
+    Pgs_Log_Error err = pgs_log_output_hand_off(o);
+#if PGS_LOG_ENABLE_IO_URING
+    if (pgs_log_uring.fd >= 0) {
+        Pgs_Log_Error wait_err = pgs_log_uring_wait(o, 0);
+        if (wait_err != PGS_LOG_OK) err = wait_err;
+    }
+#endif
+#if PGS_LOG_ENABLE_FLUSH_THREAD
+    Pgs_Log_Error wait_err = pgs_log_flusher_wait(o, 0);
+    if (wait_err != PGS_LOG_OK) err = wait_err;
+#endif
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    pgs_log_loop_write(o, SIZE_MAX, true, &err);
+#endif
+    return err;
+}
+#endif // PGS_LOG_ENABLE_BUFFERING
+
+#if PGS_LOG_TERMINAL_COALESCE
+// hands off what the terminals buffered, with the terminal lock held
+static Pgs_Log_Error pgs_log_terminal_write_locked(void) {
+    pgs_log_terminal_pending = 0;
+    for (int i = 0; i < pgs_output_count; ++i) {
+        if (!pgs_outputs[i].terminal || pgs_outputs[i].buf_pos == 0) continue;
+
+        Pgs_Log_Error err = pgs_log_output_hand_off(&pgs_outputs[i]);
+        if (err != PGS_LOG_OK)
+            return err;
+    }
+    return pgs_log_set_last_error(PGS_LOG_OK, "Wrote terminal outputs", 0);
+}
+
+#endif // PGS_LOG_TERMINAL_COALESCE
+
+#if PGS_LOG_SWITCHES_LOG_FILE
+// previous files, closed by a flush once no queued buffer goes to them anymore. At most
+// `PGS_LOG_OUTPUT_BUFFERS - 1` of them can still have queued buffers, so a full list always has one to close
+static FILE *pgs_log_retired_files[PGS_LOG_OUTPUT_BUFFERS + 1];
+
+static Pgs_Log_Output *pgs_log_file_output(void) {
+    for (int i = 0; i < pgs_output_count; ++i) {
+        if (pgs_outputs[i].file == pgs_log_file) return &pgs_outputs[i];
+    }
+    return NULL;
+}
+
+// with the flusher lock held if there is one
+static bool pgs_log_fd_queued(const Pgs_Log_Output *o, int fd) {
+#if PGS_LOG_ENABLE_BUFFERING && PGS_LOG_OUTPUT_BUFFERS > 1
+    for (int n = 0; o && n < o->queued; ++n) {
+        if (o->queued_fds[(o->queue_head + n) % PGS_LOG_OUTPUT_BUFFERS] == fd) return true;
+    }
+#else
+    (void)o;
+    (void)fd;
+#endif
+    return false;
+}
+
+// closes the retired files nothing is queued for anymore, `keep_one` stops after the first free slot
+static void pgs_log_close_retired(bool keep_one) {
+    Pgs_Log_Output *o = pgs_log_file_output();
+    PGS_LOG_FLUSHER_LOCK();
+    for (int i = 0; i < PGS_LOG_OUTPUT_BUFFERS + 1; ++i) {
+        if (!pgs_log_retired_files[i] || pgs_log_fd_queued(o, fileno(pgs_log_retired_files[i]))) continue;
+        fclose(pgs_log_retired_files[i]);
+        pgs_log_retired_files[i] = NULL;
+        if (keep_one) break;
+    }
+    PGS_LOG_FLUSHER_UNLOCK();
+}
+
+// lets the output of the log file continue in `next`, the current buffer is handed off to the old file the way a
+// full one would be, what is queued keeps its fd, the old file gets closed by a later flush
+static Pgs_Log_Error pgs_log_swap_log_file(FILE *next) {
+    Pgs_Log_Output *o = pgs_log_file_output();
+    if (!o) return pgs_log_set_last_error(PGS_LOG_ERR, "Log file is not among the outputs", 0);
+
+#if PGS_LOG_ENABLE_BUFFERING
+    Pgs_Log_Error err = pgs_log_output_hand_off(o);
+    if (err != PGS_LOG_OK)
+        return err;
+#endif
+
+    int slot = -1;
+    for (int i = 0; i < PGS_LOG_OUTPUT_BUFFERS + 1 && slot < 0; ++i) {
+        if (!pgs_log_retired_files[i]) slot = i;
+    }
+    // switching faster than flushes happen
+    if (slot < 0) {
+        pgs_log_close_retired(true);
+        for (int i = 0; i < PGS_LOG_OUTPUT_BUFFERS + 1 && slot < 0; ++i) {
+            if (!pgs_log_retired_files[i]) slot = i;
+        }
+    }
+    pgs_log_retired_files[slot] = pgs_log_file;
+
+    PGS_LOG_FLUSHER_LOCK();
+    o->file = next;
+    o->ctx = next;
+    o->fd = fileno(next);
+    PGS_LOG_FLUSHER_UNLOCK();
+
+    pgs_log_file = next;
+    return PGS_LOG_OK;
+}
+
+#if PGS_LOG_ENABLE_ROTATION
+static void pgs_log_discard_standby(void) {
+    if (!pgs_log_standby_file) return;
+
+    char filename[PGS_LOG_MAX_PATH_LEN];
+    pgs_log_numbered_filename(filename, pgs_log_file_name, pgs_log_standby_number);
+    fclose(pgs_log_standby_file);
+    remove(filename);
+    pgs_log_standby_file = NULL;
+}
+
+// bytes the entry adds to the log file, 0 if its output skips the level, its own format may be longer or shorter
+static size_t pgs_log_file_entry_len(const char *str, size_t len) {
+#if PGS_LOG_ENABLE_OUTPUT_FORMATS
+    Pgs_Log_Output *o = pgs_log_file_output();
+    if (!o) return len;
+    if (!pgs_log_output_accepts(o)) return 0;
+    pgs_log_output_line(o, str, &len);
+#else
+    (void)str;
+#endif
+    return len;
+}
+
+// called before `len` bytes get written, swaps the log file of its output for the standby if a limit is reached
+static Pgs_Log_Error pgs_log_rotate_if_needed(size_t len) {
+    if (!pgs_log_file) return PGS_LOG_OK;
+
+    bool due = false;
+#if PGS_LOG_ROTATE_SIZE > 0
+    due = due || (pgs_log_file_bytes > 0 && pgs_log_file_bytes + len > PGS_LOG_ROTATE_SIZE);
+#endif
+#if PGS_LOG_ROTATE_INTERVAL_S > 0
+    due = due || time(NULL) - pgs_log_file_opened >= PGS_LOG_ROTATE_INTERVAL_S;
+#endif
+    pgs_log_file_bytes += len;
+    if (!due) return PGS_LOG_OK;
+
+    // standby not ready yet when limits are reached faster than flushes happen, if it can not be opened the
+    // current file keeps going and the next entry tries again
+    Pgs_Log_Error err = pgs_log_prepare_standby();
+    if (err != PGS_LOG_OK)
+        return err;
+
+    err = pgs_log_swap_log_file(pgs_log_standby_file);
+    if (err != PGS_LOG_OK)
+        return err;
+
+    pgs_log_file_number = pgs_log_standby_number;
+    pgs_log_file_bytes = len;
+    pgs_log_file_opened = time(NULL);
+    pgs_log_standby_file = NULL;
+
+    return PGS_LOG_OK;
+}
+#endif // PGS_LOG_ENABLE_ROTATION
+
+#if PGS_LOG_DATE_ROLLOVER
+static Pgs_Log_Error pgs_log_rollover(void) {
+    pgs_log_rollover_pending = false;
+    if (!pgs_log_file) return PGS_LOG_OK;
+
+    time_t t = time(NULL);
+    char name[PGS_LOG_MAX_PATH_LEN];
+    char filename[PGS_LOG_MAX_PATH_LEN];
+    int number = 0;
+    const char *mode = "w";
+
+    Pgs_Log_Error err = pgs_log_resolve_log_file(t, name, filename, &number, &mode);
+    if (err != PGS_LOG_OK)
+        return err;
+
+#if PGS_LOG_ENABLE_ROTATION
+    // numbered after the old name
+    pgs_log_discard_standby();
+#endif
+
+    FILE *next = fopen(filename, mode);
+    if (!next)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open log file for the new date", errno);
+
+    err = pgs_log_swap_log_file(next);
+    if (err != PGS_LOG_OK) {
+        fclose(next);
+        return err;
+    }
+
+    pgs_log_track_log_file(next, name, number, t);
+    return PGS_LOG_OK;
+}
+#endif // PGS_LOG_DATE_ROLLOVER
+
+// the slow part of switching files, runs on flush
+static Pgs_Log_Error pgs_log_switch_service(void) {
+    if (pgs_log_reopen_requested) {
+        Pgs_Log_Error err = pgs_log_reopen();
+        if (err != PGS_LOG_OK)
+            return err;
+    }
+
+    pgs_log_close_retired(false);
+
+#if PGS_LOG_ENABLE_ROTATION
+    if (!pgs_log_file) return PGS_LOG_OK;
+
+#if PGS_LOG_ROTATE_KEEP > 0
+    // distance in wrap around order, the numbers freed here get picked up again by pgs_log_prepare_standby()
+    while ((pgs_log_file_number - pgs_log_oldest_number + PGS_LOG_MAX_FILENAME_NUMBER) % PGS_LOG_MAX_FILENAME_NUMBER >= PGS_LOG_ROTATE_KEEP) {
+        char filename[PGS_LOG_MAX_PATH_LEN];
+        pgs_log_numbered_filename(filename, pgs_log_file_name, pgs_log_oldest_number);
+        remove(filename);
+        pgs_log_oldest_number = (pgs_log_oldest_number + 1) % PGS_LOG_MAX_FILENAME_NUMBER;
+    }
+#endif
+
+    return pgs_log_prepare_standby();
+#else
+    return PGS_LOG_OK;
+#endif
+}
+#endif // PGS_LOG_SWITCHES_LOG_FILE
+
+Pgs_Log_Error pgs_log_reopen(void) {
+    pgs_log_reopen_requested = 0;
+#if PGS_LOG_SWITCHES_LOG_FILE
+    if (!pgs_log_file)
+        return pgs_log_set_last_error(PGS_LOG_OK, "No log file open", 0);
+
+    char name[PGS_LOG_MAX_PATH_LEN];
+    char filename[PGS_LOG_MAX_PATH_LEN];
+    strcpy(name, pgs_log_file_name);
+    pgs_log_numbered_filename(filename, name, pgs_log_file_number);
+
+    if (pgs_log_create_dirs_for_path(filename) != PGS_LOG_OK)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, pgs_log_temp_sprintf("Failed to create dirs for path %s", filename), 0);
+
+    FILE *next = fopen(filename, "a");
+    if (!next)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to reopen log file", errno);
+
+    // everything buffered so far still belongs to the old (possibly renamed) file
+    Pgs_Log_Error err = pgs_log_swap_log_file(next);
+    if (err != PGS_LOG_OK) {
+        fclose(next);
+        return err;
+    }
+
+    pgs_log_track_log_file(next, name, pgs_log_file_number, time(NULL));
+    return pgs_log_set_last_error(PGS_LOG_OK, "Reopened log file", 0);
+#else
+    return pgs_log_set_last_error(PGS_LOG_ERR, "Reopening needs the stdio log file, not available with `PGS_LOG_FILE_MMAP`/`PGS_LOG_FILE_DIRECT`/`PGS_LOG_FILE_SEGMENTS`", 0);
+#endif
+}
+
+static void pgs_log_reopen_signal_handler(int signo) {
+    (void)signo;
+    pgs_log_reopen_requested = 1;
+}
+
+Pgs_Log_Error pgs_log_install_reopen_signal(int signo) {
+    if (signal(signo, pgs_log_reopen_signal_handler) == SIG_ERR)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Failed to install reopen signal handler", errno);
+
+    return pgs_log_set_last_error(PGS_LOG_OK, "Installed reopen signal handler", 0);
+}
+
+#if PGS_LOG_ENABLE_BUFFERING
+// appends `line` to the buffer of `o`, handing off or writing whatever does not fit
+static Pgs_Log_Error pgs_log_output_append(Pgs_Log_Output *o, const char *line, size_t line_len) {
+    if (o->sink.unbuffered)
+        return pgs_log_output_write(o, line, line_len);
+#if PGS_LOG_BUFFER_INSTA_WRITE_TERMINAL && !PGS_LOG_TERMINAL_COALESCE && !PGS_LOG_ENABLE_EVENT_LOOP
+    if (o->terminal)
+        return pgs_log_output_write(o, line, line_len);
+#endif
+    if (o->buf_pos + line_len > PGS_LOG_OUTPUT_BUFFER_SIZE(o)) {
+        Pgs_Log_Error err = pgs_log_output_hand_off(o);
+        if (err != PGS_LOG_OK)
+            return err;
+
+        if (o->buf_pos + line_len > PGS_LOG_OUTPUT_BUFFER_SIZE(o)) {
+#if PGS_LOG_ENABLE_LARGE_ENTRIES
+            // larger than the whole buffer, one write right after whatever was queued before it
+            err = pgs_log_output_drain(o);
+            if (err == PGS_LOG_OK) err = pgs_log_output_write(o, line, line_len);
+            return err;
+#else
+#if PGS_LOG_BUFFER_INSTA_WRITE_IF_TOO_LARGE
+            err = pgs_log_output_write(o, line, line_len);
+            if (err != PGS_LOG_OK)
+                return err;
+#endif
+            return pgs_log_set_last_error(PGS_LOG_ERR, "Log file to big for buffering, insta writing, can be disabled with `PGS_LOG_BUFFER_INSTA_WRITE_IF_TOO_LARGE false`", 0);
+#endif
+        }
+    }
+
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+    // without memory for the buffer the entry goes out unbuffered, after whatever is still queued
+    if (!PGS_LOG_OUTPUT_BUFFER(o) && !pgs_log_output_buffer_alloc(o)) {
+        Pgs_Log_Error err = pgs_log_output_drain(o);
+        if (err == PGS_LOG_OK) err = pgs_log_output_write(o, line, line_len);
+        return err;
+    }
+#endif
+    memcpy(PGS_LOG_OUTPUT_BUFFER(o) + o->buf_pos, line, line_len);
+    o->buf_pos += line_len;
+#if PGS_LOG_BUFFER_INSTA_WRITE_TERMINAL && !PGS_LOG_TERMINAL_COALESCE && PGS_LOG_ENABLE_EVENT_LOOP
+    // the terminal entry is queued right away, the loop writes it with its next service
+    if (o->terminal)
+        return pgs_log_output_hand_off(o);
+#endif
+    return PGS_LOG_OK;
+}
+#endif
+
+Pgs_Log_Error pgs_log_write_output(const char *str, size_t len) {
+    if (!PGS_LOG_ENABLED)
+        return pgs_log_set_last_error(PGS_LOG_OK, "Logging disabled", 0);
+
+    if (pgs_log_reopen_requested) {
+        Pgs_Log_Error reopen_err = pgs_log_reopen();
+        if (reopen_err != PGS_LOG_OK)
+            return reopen_err;
+    }
+
+#if PGS_LOG_DATE_ROLLOVER
+    pgs_log_timestamp_string();
+    if (pgs_log_rollover_pending) {
+        Pgs_Log_Error rollover_err = pgs_log_rollover();
+        if (rollover_err != PGS_LOG_OK)
+            return rollover_err;
+    }
+#endif
+
+#if PGS_LOG_ENABLE_FILE && PGS_LOG_ENABLE_ROTATION
+    // the entry still goes to every output, the current file included, the failed rotation gets reported at the end
+    size_t file_len = pgs_log_file_entry_len(str, len);
+    Pgs_Log_Error rotate_err = file_len > 0 ? pgs_log_rotate_if_needed(file_len) : PGS_LOG_OK;
+#endif
+
+    for (int i = 0; i < pgs_output_count; ++i) {
+        Pgs_Log_Output *o = &pgs_outputs[i];
+#if PGS_LOG_ENABLE_OUTPUT_FORMATS
+        if (!pgs_log_output_accepts(o)) continue;
+        size_t line_len = len;
+        const char *line = pgs_log_output_line(o, str, &line_len);
+#else
+        size_t line_len = len;
+        const char *line = str;
+#endif
+#if PGS_LOG_ENABLE_BUFFERING
+        PGS_LOG_TERMINAL_LOCK_OUTPUT(o);
+        Pgs_Log_Error err = pgs_log_output_append(o, line, line_len);
+        PGS_LOG_TERMINAL_UNLOCK_OUTPUT(o);
+#else
+        Pgs_Log_Error err = pgs_log_output_write(o, line, line_len);
+#endif
+        if (err != PGS_LOG_OK)
+            return err;
+    }
+
+#if PGS_LOG_ENABLE_IO_URING
+    Pgs_Log_Error submit_err = pgs_log_uring_submit();
+    if (submit_err != PGS_LOG_OK)
+        return submit_err;
+#endif
+
+#if PGS_LOG_ENABLE_FILE && PGS_LOG_ENABLE_ROTATION
+    if (rotate_err != PGS_LOG_OK)
+        return pgs_log_set_last_error(rotate_err, "Wrote/Buffered msg to all outputs, but rotating the log file failed, kept the current one", 0);
+#endif
+    return pgs_log_set_last_error(PGS_LOG_OK, "Wrote/Buffered msg to all outputs", 0);
+}
+
+// group commit: a flush (same thread rules as logging) snapshots the latest sequence and the fds to sync, whoever
+// waits for durability first becomes the leader and fdatasyncs for everyone that was flushed until then, the others
+// sleep until a sync covers their sequence
+#define PGS_LOG_MAX_SYNC_FDS PGS_LOG_MAX_FD
+
+static struct {
+#ifndef _WIN32
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+#endif
+    bool syncing;
+    uint64_t flushed;           // every entry up to here reached the kernel
+    uint64_t durable;           // every entry up to here got fdatasync'ed
+    uint64_t last_sync_ms;
+    int fds[PGS_LOG_MAX_SYNC_FDS];
+    int fd_count;
+} pgs_log_group = {
+#ifndef _WIN32
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+#endif
+};
+
+#ifndef _WIN32
+#   define PGS_LOG_GROUP_LOCK()   pthread_mutex_lock(&pgs_log_group.lock)
+#   define PGS_LOG_GROUP_UNLOCK() pthread_mutex_unlock(&pgs_log_group.lock)
+#   define PGS_LOG_GROUP_WAIT()   pthread_cond_wait(&pgs_log_group.done, &pgs_log_group.lock)
+#   define PGS_LOG_GROUP_WAKE()   pthread_cond_broadcast(&pgs_log_group.done)
+#else
+#   define PGS_LOG_GROUP_LOCK()
+#   define PGS_LOG_GROUP_UNLOCK()
+#   define PGS_LOG_GROUP_WAIT()
+#   define PGS_LOG_GROUP_WAKE()
+#endif
+
+static void pgs_log_group_commit_flushed(void) {
+    PGS_LOG_GROUP_LOCK();
+    pgs_log_group.flushed = pgs_log_sequence;
+    pgs_log_group.fd_count = 0;
+    for (int i = 0; i < pgs_output_count && pgs_log_group.fd_count < PGS_LOG_MAX_SYNC_FDS; ++i) {
+        Pgs_Log_Output *o = &pgs_outputs[i];
+        // sinks name their file themselves, fdatasync also writes back the dirty pages of an mmap output
+        int fd = o->sink.sync_fd ? o->sink.sync_fd(o->ctx) : o->fd;
+        if (fd < 0 || o->terminal) continue;
+        pgs_log_group.fds[pgs_log_group.fd_count++] = fd;
+    }
+    PGS_LOG_GROUP_UNLOCK();
+}
+
+static bool pgs_log_sync_is_due(void) {
+    if (pgs_log_durability != PGS_LOG_DURABILITY_PERIODIC) return false;
+    return pgs_log_now_ms() - pgs_log_group.last_sync_ms >= PGS_LOG_DURABILITY_INTERVAL_MS;
+}
+
+static int pgs_log_datasync_fd(int fd) {
+#ifdef _WIN32
+    if (_commit(fd) != 0 && errno != EBADF)
+        return errno;
+#else
+    // terminals, pipes and sockets have nothing to sync
+    if (fdatasync(fd) != 0 && errno != EINVAL && errno != EROFS && errno != ENOTSUP && errno != EBADF)
+        return errno;
+#endif
+    return 0;
+}
+
+uint64_t pgs_log_last_sequence(void) {
+    return pgs_log_thread_sequence;
+}
+
+uint64_t pgs_log_truncated_count(void) {
+    return pgs_log_truncated;
+}
+
+uint64_t pgs_log_durable_sequence(void) {
+    PGS_LOG_GROUP_LOCK();
+    uint64_t durable = pgs_log_group.durable;
+    PGS_LOG_GROUP_UNLOCK();
+    return durable;
+}
+
+Pgs_Log_Error pgs_log_wait_durable(uint64_t sequence) {
+    PGS_LOG_GROUP_LOCK();
+    if (sequence > pgs_log_group.flushed) {
+        PGS_LOG_GROUP_UNLOCK();
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Sequence not flushed yet, call pgs_log_flush first", 0);
+    }
+
+    while (pgs_log_group.durable < sequence) {
+        if (pgs_log_group.syncing) {
+            PGS_LOG_GROUP_WAIT();
+            continue;
+        }
+
+        pgs_log_group.syncing = true;
+        uint64_t target = pgs_log_group.flushed;
+        int fds[PGS_LOG_MAX_SYNC_FDS];
+        int fd_count = pgs_log_group.fd_count;
+        memcpy(fds, pgs_log_group.fds, sizeof(int) * (size_t)fd_count);
+        PGS_LOG_GROUP_UNLOCK();
+
+        int err = 0;
+        for (int i = 0; i < fd_count && err == 0; ++i)
+            err = pgs_log_datasync_fd(fds[i]);
+
+        PGS_LOG_GROUP_LOCK();
+        pgs_log_group.syncing = false;
+        if (err == 0) {
+            if (target > pgs_log_group.durable) pgs_log_group.durable = target;
+            pgs_log_group.last_sync_ms = pgs_log_now_ms();
+        }
+        PGS_LOG_GROUP_WAKE();
+
+        if (err != 0) {
+            PGS_LOG_GROUP_UNLOCK();
+            return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to sync outputs to disk", err);
+        }
+    }
+    PGS_LOG_GROUP_UNLOCK();
+
+    return pgs_log_set_last_error(PGS_LOG_OK, "Entries are durable", 0);
+}
+
+Pgs_Log_Error pgs_log_flush(void) {
+    pgs_log_ratelimit_report();
+#if PGS_LOG_TERMINAL_COALESCE
+    PGS_LOG_TERMINAL_LOCK();
+    pgs_log_terminal_pending = 0;
+    PGS_LOG_TERMINAL_UNLOCK();
+#endif
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    pgs_log_loop.due = false;
+#endif
+
+#if PGS_LOG_SWITCHES_LOG_FILE
+    // a failed switch still leaves the current files to flush, it gets reported at the end
+    Pgs_Log_Error switch_err = pgs_log_switch_service();
+#endif
+
+    for (int i = 0; i < pgs_output_count; ++i) {
+            Pgs_Log_Error err = PGS_LOG_OK;
+            PGS_LOG_TERMINAL_LOCK_OUTPUT(&pgs_outputs[i]);
+#if PGS_LOG_ENABLE_BUFFERING
+            err = pgs_log_output_hand_off(&pgs_outputs[i]);
+#endif
+#if PGS_LOG_ENABLE_NONBLOCKING
+            // retry the pending tail even if nothing new got buffered
+            if (err == PGS_LOG_OK && pgs_outputs[i].nonblocking)
+                err = pgs_log_nonblock_drain(&pgs_outputs[i]);
+#endif
+            PGS_LOG_TERMINAL_UNLOCK_OUTPUT(&pgs_outputs[i]);
+            if (err != PGS_LOG_OK)
+                return err;
+    }
+
+#if PGS_LOG_ENABLE_IO_URING
+    // all outputs go out with one io_uring_enter, then wait for every one of them
+    Pgs_Log_Error submit_err = pgs_log_uring_submit();
+    if (submit_err != PGS_LOG_OK)
+        return submit_err;
+#endif
+
+    for (int i = 0; i < pgs_output_count; ++i) {
+        Pgs_Log_Output *o = &pgs_outputs[i];
+#if PGS_LOG_ENABLE_IO_URING
+            if (pgs_log_uring.fd >= 0) {
+                Pgs_Log_Error err = pgs_log_uring_wait(o, 0);
+                if (err != PGS_LOG_OK)
+                    return err;
+            }
+#endif
+#if PGS_LOG_ENABLE_FLUSH_THREAD
+            Pgs_Log_Error err = pgs_log_flusher_wait(o, 0);
+            if (err != PGS_LOG_OK)
+                return err;
+#endif
+#if PGS_LOG_ENABLE_EVENT_LOOP
+            Pgs_Log_Error err = PGS_LOG_OK;
+            pgs_log_loop_write(o, SIZE_MAX, true, &err);
+            if (err != PGS_LOG_OK)
+                return err;
+#endif
+            // fd outputs never go through stdio buffers, only sinks that hold writes back need a flush
+            if (o->sink.flush) {
+                Pgs_Log_Error err = o->sink.flush(o->ctx);
+                if (err != PGS_LOG_OK)
+                    return err;
+            }
+    }
+
+#if PGS_LOG_MAX_BUFFER_AGE_MS > 0
+    pgs_log_buffered_since_ms = 0;
+#endif
+
+    pgs_log_group_commit_flushed();
+    if (pgs_log_durability == PGS_LOG_DURABILITY_GROUP_COMMIT || pgs_log_sync_is_due()) {
+        Pgs_Log_Error err = pgs_log_wait_durable(pgs_log_sequence);
+        if (err != PGS_LOG_OK)
+            return err;
+    }
+
+#if PGS_LOG_SWITCHES_LOG_FILE
+    if (switch_err != PGS_LOG_OK)
+        return pgs_log_set_last_error(switch_err, "Flushed all fd's, but preparing the next log file failed, retried on the next flush", 0);
+#endif
+    return pgs_log_set_last_error(PGS_LOG_OK, "Flushed all fd's", 0);
+}
+
+#if PGS_LOG_ENABLE_EVENT_LOOP
+Pgs_Log_Error pgs_log_service(size_t budget) {
+    if (budget == 0) budget = SIZE_MAX;
+
+    // taken now, raised again below if the budget runs out first
+#if PGS_LOG_TERMINAL_TIMER
+    // the terminal timer signals without touching `signalled`
+    if (pgs_log_loop.fd >= 0) {
+#else
+    if (pgs_log_loop.signalled) {
+#endif
+        uint64_t value;
+        if (read(pgs_log_loop.fd, &value, sizeof(value)) < 0 && errno != EAGAIN)
+            return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to read event fd", errno);
+        pgs_log_loop.signalled = false;
+    }
+#if PGS_LOG_TERMINAL_COALESCE
+    if (pgs_log_terminal_due()) {
+        Pgs_Log_Error terminal_err = pgs_log_flush_terminals();
+        if (terminal_err != PGS_LOG_OK)
+            return terminal_err;
+    }
+#endif
+
+    bool due = pgs_log_loop.due;
+    bool left = false;
+    size_t spent = 0;
+    Pgs_Log_Error err = PGS_LOG_OK;
+    for (int n = 0; n < pgs_output_count; ++n) {
+        Pgs_Log_Output *o = &pgs_outputs[(pgs_log_loop.next + n) % pgs_output_count];
+        if (!PGS_LOG_OUTPUT_ASYNC(o)) continue;
+
+        if (due && o->buf_pos > 0) {
+            if (o->queued < PGS_LOG_OUTPUT_BUFFERS - 1) pgs_log_loop_queue(o);
+            else left = true;
+        }
+        if (spent < budget)
+            spent += pgs_log_loop_write(o, budget - spent, false, &err);
+        if (o->queued > 0) left = true;
+    }
+    if (pgs_output_count > 0)
+        pgs_log_loop.next = (pgs_log_loop.next + 1) % pgs_output_count;
+    if (err != PGS_LOG_OK)
+        return err;
+
+    if (left) {
+        pgs_log_loop_signal();
+        return pgs_log_set_last_error(PGS_LOG_OK, "Serviced outputs, more is left", 0);
+    }
+
+    // everything queued is written, the rest of a flush (sinks, other outputs, durability) is cheap from here
+    if (due) {
+        pgs_log_loop.due = false;
+        return pgs_log_flush();
+    }
+    return pgs_log_set_last_error(PGS_LOG_OK, "Serviced outputs", 0);
+}
+
+bool pgs_log_service_pending(void) {
+    if (pgs_log_loop.due) return true;
+    for (int i = 0; i < pgs_output_count; ++i) {
+        if (pgs_outputs[i].queued > 0) return true;
+    }
+    return false;
+}
+#endif
+
+Pgs_Log_Error pgs_log_sync(void) {
+    Pgs_Log_Error err = pgs_log_flush();
+    if (err != PGS_LOG_OK)
+        return err;
+
+    return pgs_log_wait_durable(pgs_log_sequence);
+}
+
+#if PGS_LOG_TERMINAL_COALESCE
+Pgs_Log_Error pgs_log_flush_terminals(void) {
+    PGS_LOG_TERMINAL_LOCK();
+    Pgs_Log_Error err = pgs_log_terminal_write_locked();
+    PGS_LOG_TERMINAL_UNLOCK();
+    return err;
+}
+#endif
+
+// in event loop mode the loop flushes, everywhere else it happens right here
+static Pgs_Log_Error pgs_log_flush_due(void) {
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    pgs_log_loop_request();
+    return pgs_log_set_last_error(PGS_LOG_OK, "Flush requested from the event loop", 0);
+#else
+    return pgs_log_flush();
+#endif
+}
+
+Pgs_Log_Error pgs_log_flush_if_due(void) {
+    pgs_log_ratelimit_report_due();
+#if PGS_LOG_TERMINAL_COALESCE
+    if (pgs_log_terminal_due()) {
+        Pgs_Log_Error err = pgs_log_flush_terminals();
+        if (err != PGS_LOG_OK)
+            return err;
+    }
+#endif
+#if PGS_LOG_MAX_BUFFER_AGE_MS > 0
+    if (pgs_log_buffered_since_ms != 0 && pgs_log_now_ms() - pgs_log_buffered_since_ms >= PGS_LOG_MAX_BUFFER_AGE_MS)
+        return pgs_log_flush_due();
+#endif
+    if (pgs_log_sync_is_due())
+        return pgs_log_flush_due();
+    return pgs_log_set_last_error(PGS_LOG_OK, "No flush due", 0);
+}
+
+const char *pgs_log_level_to_string(Pgs_Log_Level level) {
+    switch (level) {
+        case PGS_LOG_DEBUG: return "DEBUG";
+        case PGS_LOG_INFO: return "INFO";
+        case PGS_LOG_WARN: return "WARN";
+        case PGS_LOG_ERROR: return "ERROR";
+        case PGS_LOG_FATAL: return "FATAL";
+        default: return "UNKNOWN";
+    }
+}
+
+
+const char *pgs_log_timestamp_string(void) {
+    time_t current_time = time(NULL);
+
+    if (current_time != pgs_log_last_timestamp) {
+        struct tm *tm_info = localtime(&current_time);
+        strftime(pgs_log_cached_timestamp, PGS_LOG_MAX_TIMESTAMP_LEN, PGS_LOG_TIMESTAMP_FORMAT, tm_info);
+        pgs_log_last_timestamp = current_time;
+#if PGS_LOG_DATE_ROLLOVER
+        // the log path can only change when the time fields it uses do, once per second is enough to notice
+        pgs_log_check_rollover(tm_info);
+#endif
+    }
+
+    return pgs_log_cached_timestamp;
+}
+
+static Pgs_Log_Error pgs_log_file_sink_write(void *ctx, const char *data, size_t len) {
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    return pgs_log_loop_write_now(fileno((FILE *)ctx), data, len, "Failed to write to file");
+#else
+    if (pgs_write(fileno((FILE *)ctx), data, len) != (ssize_t)len)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write to file", errno);
+    return PGS_LOG_OK;
+#endif
+}
+
+static void pgs_log_file_sink_close(void *ctx) {
+    FILE *file = (FILE *)ctx;
+    if (file != stdout && file != stderr)
+        fclose(file);
+}
+
+static Pgs_Log_Error pgs_log_fd_sink_write(void *ctx, const char *data, size_t len) {
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    return pgs_log_loop_write_now((int)(intptr_t)ctx, data, len, "Failed to write to fd");
+#else
+    if (pgs_write((int)(intptr_t)ctx, data, len) != (ssize_t)len)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write to fd", errno);
+    return PGS_LOG_OK;
+#endif
+}
+
+static void pgs_log_fd_sink_close(void *ctx) {
+    pgs_close((int)(intptr_t)ctx);
+}
+
+static Pgs_Log_Error pgs_log_memory_sink_write(void *ctx, const char *data, size_t len) {
+    Pgs_Log_Memory_Sink *m = (Pgs_Log_Memory_Sink *)ctx;
+
+    // a batch holds several entries, the ones that still fit are kept
+    size_t fit = len;
+    if (m->len + fit >= m->cap) {
+        fit = m->cap - 1 - m->len;
+        while (fit > 0 && data[fit - 1] != '\n') fit--;
+    }
+    m->dropped += len - fit;
+
+    memcpy(m->data + m->len, data, fit);
+    m->len += fit;
+    m->data[m->len] = '\0';
+    return PGS_LOG_OK;
+}
+
+static Pgs_Log_Error pgs_log_add_output(Pgs_Log_Sink sink, void *ctx, int fd, FILE *file) {
+    if (!sink.write)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Sink has no write function", 0);
+
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+    if (!pgs_outputs) {
+        pgs_outputs = pgs_log_mem_alloc((size_t)pgs_output_capacity * sizeof(Pgs_Log_Output));
+        if (!pgs_outputs)
+            return pgs_log_set_last_error(PGS_LOG_ERR, "Allocator failed to give memory for the outputs", 0);
+    }
+    if (pgs_output_count >= pgs_output_capacity) {
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Reached max output count, can be raised with pgs_log_set_max_outputs() before the first output", 0);
+    }
+#else
+    if (pgs_output_count >= PGS_LOG_MAX_FD) {
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Reached max file descriptor count, you can add `#define PGS_LOG_MAX_FD` and increase the number and recompile", 0);
+    }
+#endif
+
+    Pgs_Log_Output *o = &pgs_outputs[pgs_output_count];
+
+    o->sink = sink;
+    o->ctx = ctx;
+    o->fd = fd;
+    o->file = file;
+    o->terminal = fd >= 0 && (fd == fileno(stdout) || fd == fileno(stderr));
+#if PGS_LOG_ENABLE_OUTPUT_FORMATS
+    o->min_level = PGS_LOG_DEBUG;
+    o->format = 0;
+#endif
+#if PGS_LOG_ENABLE_NONBLOCKING
+    o->nonblocking = false;
+    o->write_fd = fd;
+    o->pending = NULL;
+    o->mid_entry = false;
+    o->pending_off = 0;
+    o->pending_len = 0;
+    o->dropped_entries = 0;
+    o->dropped_bytes = 0;
+    o->stalls = 0;
+#endif
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    pgs_log_loop_set_nonblocking(o);
+#endif
+
+#if PGS_LOG_ENABLE_BUFFERING
+    o->buf_index = 0;
+    o->buf_pos = 0;
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+    for (int i = 0; i < PGS_LOG_OUTPUT_BUFFERS; ++i) o->buffers[i] = NULL;
+    o->buf_size = pgs_log_buffer_size;
+#endif
+#if PGS_LOG_OUTPUT_BUFFERS > 1
+    o->queue_head = 0;
+    o->queued = 0;
+    o->queued_done = 0;
+    o->in_flight = false;
+#endif
+#endif
 
-#define PGS_LOG_WARN(fmt, ...)                                                                  \
-    do {                                                                                        \
-        pgs_log(PGS_LOG_WARN, __FILE__, (size_t)(sizeof(__FILE__) - 1),                         \
-        STRINGIFY(__LINE__), (size_t)(sizeof(STRINGIFY(__LINE__)) - 1), fmt, ##__VA_ARGS__);    \
-    } while(0)
+    PGS_LOG_TERMINAL_LOCK();
+    PGS_LOG_FLUSHER_LOCK();
+    pgs_output_count++;
+    PGS_LOG_FLUSHER_UNLOCK();
+    PGS_LOG_TERMINAL_UNLOCK();
 
-#define PGS_LOG_ERROR(fmt, ...)                                                                 \
-    do {                                                                                        \
-        pgs_log(PGS_LOG_ERROR, __FILE__, (size_t)(sizeof(__FILE__) - 1),                        \
-        STRINGIFY(__LINE__), (size_t)(sizeof(STRINGIFY(__LINE__)) - 1), fmt, ##__VA_ARGS__);    \
-    } while(0)
+    return PGS_LOG_OK;
+}
 
-#define PGS_LOG_FATAL(fmt, ...)                                                                 \
-    do {                                                                                        \
-        pgs_log(PGS_LOG_FATAL, __FILE__, (size_t)(sizeof(__FILE__) - 1),                        \
-        STRINGIFY(__LINE__), (size_t)(sizeof(STRINGIFY(__LINE__)) - 1), fmt, ##__VA_ARGS__);    \
-    } while(0)
+Pgs_Log_Error pgs_log_add_fd_output(FILE *file) {
+    if (!file)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No File passed to add to output", 0);
 
+    // whatever the caller already wrote through stdio goes out before our writes to the fd, never needed again
+    fflush(file);
 
+    Pgs_Log_Sink sink = { .write = pgs_log_file_sink_write, .close = pgs_log_file_sink_close };
+    Pgs_Log_Error err = pgs_log_add_output(sink, file, fileno(file), file);
+    if (err != PGS_LOG_OK)
+        return err;
 
-#endif // PGS_LOG_H
+    return pgs_log_set_last_error(PGS_LOG_OK, "Added fd to output", 0);
+}
 
-#ifdef PGS_LOG_IMPLEMENTATION
+Pgs_Log_Error pgs_log_add_raw_fd_output(int fd, bool owned) {
+    if (fd < 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Invalid fd passed to add to output", 0);
 
-#if defined(_WIN32)
-    #include <io.h>
-    #define pgs_write _write
-#else
-    #include <unistd.h>
-    #define pgs_write write
-#endif
+    Pgs_Log_Sink sink = { .write = pgs_log_fd_sink_write, .close = owned ? pgs_log_fd_sink_close : NULL };
+    Pgs_Log_Error err = pgs_log_add_output(sink, (void *)(intptr_t)fd, fd, NULL);
+    if (err != PGS_LOG_OK)
+        return err;
 
-void sigint_handler(int signo) {
-    pgs_log_cleanup();
-    (void)signo;
-    exit(130);
+    return pgs_log_set_last_error(PGS_LOG_OK, "Added raw fd to output", 0);
 }
 
-Pgs_Log_Level pgs_log_minimal_log_level = PGS_LOG_DEBUG;
+Pgs_Log_Error pgs_log_add_sink_output(Pgs_Log_Sink sink, void *ctx) {
+    Pgs_Log_Error err = pgs_log_add_output(sink, ctx, -1, NULL);
+    if (err != PGS_LOG_OK)
+        return err;
 
-static Pgs_Log_Output pgs_outputs[PGS_LOG_MAX_FD];
-static int pgs_output_count = 0;
-static bool pgs_log_initialized = false;
-static bool pgs_log_is_enabled = PGS_LOG_ENABLED;
+    return pgs_log_set_last_error(PGS_LOG_OK, "Added sink to output", 0);
+}
 
-static char pgs_log_cached_timestamp[PGS_LOG_MAX_TIMESTAMP_LEN];
-static time_t pgs_log_last_timestamp = 0;
+Pgs_Log_Error pgs_log_add_callback_output(Pgs_Log_Sink_Write write, void *ctx) {
+    Pgs_Log_Sink sink = { .write = write };
+    return pgs_log_add_sink_output(sink, ctx);
+}
 
-#if PGS_LOG_USE_DETAIL_ERROR
-static Pgs_Log_Error_Detail pgs_log_last_error = { .type = PGS_LOG_OK, .message = {0}, .errno_value = 0, };
-#else
-static Pgs_Log_Error_Detail pgs_log_last_error = { };
-#endif
+void pgs_log_memory_sink_init(Pgs_Log_Memory_Sink *memory, char *buffer, size_t cap) {
+    memory->data = buffer;
+    memory->len = 0;
+    memory->cap = cap;
+    memory->dropped = 0;
+    if (cap > 0) buffer[0] = '\0';
+}
 
+Pgs_Log_Error pgs_log_add_memory_output(Pgs_Log_Memory_Sink *memory) {
+    if (!memory || !memory->data || memory->cap == 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Memory sink has no buffer", 0);
 
-Pgs_Log_Error_Detail pgs_log_get_last_error(void) {
-    return pgs_log_last_error;
+    Pgs_Log_Sink sink = { .write = pgs_log_memory_sink_write };
+    return pgs_log_add_sink_output(sink, memory);
 }
 
-Pgs_Log_Error pgs_log_set_last_error(Pgs_Log_Error type, const char *msg, int errn) {
-#if PGS_LOG_USE_DETAIL_ERROR
-    pgs_log_last_error.type = type;
-    pgs_log_last_error.errno_value = errn;
-    if (errn != 0) {
-        snprintf(pgs_log_last_error.message, PGS_LOG_ERROR_MESSAGE_SIZE, "%s: %s", msg, strerror(errn));
-    } else {
-        strncpy(pgs_log_last_error.message, msg, PGS_LOG_ERROR_MESSAGE_SIZE - 1);
-        pgs_log_last_error.message[PGS_LOG_ERROR_MESSAGE_SIZE - 1] = '\0';
+#if PGS_LOG_ENABLE_OUTPUT_FORMATS || (PGS_LOG_ENABLE_DYNAMIC_BUFFERS && PGS_LOG_ENABLE_BUFFERING)
+static Pgs_Log_Output *pgs_log_output_by_fd(int fd) {
+    for (int i = 0; i < pgs_output_count; ++i) {
+        if (pgs_outputs[i].fd == fd) return &pgs_outputs[i];
     }
-#endif
-    (void)msg;
-    (void)errn;
-    return type;
+    return NULL;
 }
-
-Pgs_Log_Error pgs_log_init_if_needed() {
-    if (!pgs_log_initialized) {
-        signal(SIGINT, sigint_handler);
-#if PGS_LOG_ENABLE_STDOUT
-        if (pgs_log_add_fd_output(stdout) != PGS_LOG_OK) 
-            return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to add STDOUT as output", 0);
 #endif
-#if PGS_LOG_ENABLE_FILE
-        char filename[PGS_LOG_MAX_PATH_LEN];
-        time_t t = time(NULL);
-        struct tm *tm_info = localtime(&t);
 
-        if (strftime(filename, PGS_LOG_MAX_PATH_LEN, PGS_LOG_PATH, tm_info) == 0) {
-            return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to format log filename", 0);
-        }
+#if PGS_LOG_ENABLE_OUTPUT_FORMATS
+Pgs_Log_Error pgs_log_set_output_level(int fd, Pgs_Log_Level level) {
+    Pgs_Log_Output *o = pgs_log_output_by_fd(fd);
+    if (!o)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "fd does not exist in outputs", 0);
 
-        if (pgs_log_create_dirs_for_path(filename) != PGS_LOG_OK) {
-            return pgs_log_set_last_error(PGS_LOG_ERR_FILE, pgs_log_temp_sprintf("Failed to create dirs for path %s", filename), 0);
-        }
+    o->min_level = level;
+    return pgs_log_set_last_error(PGS_LOG_OK, "Set output level", 0);
+}
 
-        FILE *log_file = NULL;
+Pgs_Log_Error pgs_log_set_output_format(int fd, const char *format) {
+    Pgs_Log_Output *o = pgs_log_output_by_fd(fd);
+    if (!o)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "fd does not exist in outputs", 0);
 
-        if (pgs_log_file_exists(filename)) {
-#if PGS_LOG_APPEND
-            log_file = fopen(filename, "a");
-#elif PGS_LOG_OVERRIDE
-            log_file = fopen(filename, "w");
-#else
-            size_t base_size = PGS_LOG_MAX_PATH_LEN * 2 / 3;
-            size_t ext_size = PGS_LOG_MAX_PATH_LEN / 3;
-            char base[base_size];
-            char ext[ext_size];
-            int file_ending_pos = pgs_log_get_last_occurence_of('.', filename);
-            if (file_ending_pos == -1) {
-                strncpy(base, filename,  base_size - 1);
-                base[base_size - 1] = '\0';
-                ext[0] = '\0';
-            } else {
-                strncpy(base, filename, file_ending_pos);
-                base[file_ending_pos] = '\0';
-                strncpy(ext, filename + file_ending_pos, ext_size - 1);
-                ext[ext_size - 1] = '\0';
-            }
+    if (!format || strcmp(format, PGS_LOG_FORMAT) == 0) {
+        o->format = 0;
+        return pgs_log_set_last_error(PGS_LOG_OK, "Set output format", 0);
+    }
+    if (strlen(format) >= PGS_LOG_MAX_FORMAT_LEN)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Format longer than `PGS_LOG_MAX_FORMAT_LEN`", 0);
+
+    // outputs with the same format share it, so it only gets rendered once per entry
+    int free_slot = -1;
+    for (int f = 0; f < PGS_LOG_MAX_OUTPUT_FORMATS; ++f) {
+        if (strcmp(pgs_log_formats[f], format) == 0) {
+            o->format = f + 1;
+            return pgs_log_set_last_error(PGS_LOG_OK, "Set output format", 0);
+        }
 
-            int number = 0;
+        bool used = false;
+        for (int i = 0; i < pgs_output_count && !used; ++i)
+            used = &pgs_outputs[i] != o && pgs_outputs[i].format == f + 1;
+        if (!used && free_slot < 0) free_slot = f;
+    }
+    if (free_slot < 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Reached max output format count, you can add `#define PGS_LOG_MAX_OUTPUT_FORMATS` and increase the number and recompile", 0);
 
-            while (pgs_log_file_exists(filename)) {
-                number += 1;
-                if (number >= PGS_LOG_MAX_FILENAME_NUMBER)
-                    return pgs_log_set_last_error(PGS_LOG_ERR, "Too many log files with the same name exist, change `PGS_LOG_MAX_FILENAME_NUMBER` or fix ur config", errno);
-                snprintf(filename, PGS_LOG_MAX_PATH_LEN, "%s(%d)%s", base, number, ext);
-            }
-            log_file = fopen(filename, "w");
+    strcpy(pgs_log_formats[free_slot], format);
+    o->format = free_slot + 1;
+    return pgs_log_set_last_error(PGS_LOG_OK, "Set output format", 0);
+}
 #endif
-        } else {
-             log_file = fopen(filename, "w");
-        }
 
-        if (!log_file) {
-            return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Failed to open log file", errno);
-        }
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+Pgs_Log_Error pgs_log_set_allocator(const Pgs_Log_Allocator *allocator) {
+    if (pgs_outputs)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Allocator can only be changed before the first output or after pgs_log_cleanup()", 0);
+    if (allocator && (!allocator->alloc || !allocator->free))
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Allocator needs an alloc and a free function", 0);
 
-        if (pgs_log_add_fd_output(log_file) != PGS_LOG_OK) {
-            fclose(log_file);
-            return pgs_log_set_last_error(PGS_LOG_ERR, "Failed to add log file to file descriptors", 0);
-        }
-#endif
-        pgs_log_initialized = true;
-        atexit(pgs_log_cleanup);
+    if (allocator) {
+        pgs_log_allocator = *allocator;
+    } else {
+        pgs_log_allocator = (Pgs_Log_Allocator){ .alloc = pgs_log_malloc, .free = pgs_log_free };
     }
-
-    return pgs_log_set_last_error(PGS_LOG_OK, "Initialized logging", 0);
+    return pgs_log_set_last_error(PGS_LOG_OK, "Set allocator", 0);
 }
 
-Pgs_Log_Error pgs_log(Pgs_Log_Level level, const char *file, size_t file_len, const char *line, size_t line_len, const char *fmt, ...) {
-
-    if (!pgs_log_is_enabled)
-        return pgs_log_set_last_error(PGS_LOG_OK, "Logging disabled", 0);
+Pgs_Log_Error pgs_log_use_arena(void *memory, size_t size) {
+    if (!memory)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "No memory passed for the arena", 0);
 
-    if (level < pgs_log_minimal_log_level)
-        return pgs_log_set_last_error(PGS_LOG_OK, "Below minimal Log Level", 0);
+    Pgs_Log_Allocator arena = { .alloc = pgs_log_arena_alloc, .free = pgs_log_arena_free };
+    Pgs_Log_Error err = pgs_log_set_allocator(&arena);
+    if (err != PGS_LOG_OK)
+        return err;
 
-    Pgs_Log_Error init_err = pgs_log_init_if_needed();
-    if (init_err != PGS_LOG_OK) {
-        return init_err;
-    }
+    pgs_log_arena.base = memory;
+    pgs_log_arena.size = size;
+    pgs_log_arena.used = 0;
+    return PGS_LOG_OK;
+}
 
-    va_list ap;
-    va_start(ap, fmt);
+Pgs_Log_Error pgs_log_set_max_outputs(int count) {
+    if (pgs_outputs)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Output count can only be changed before the first output or after pgs_log_cleanup()", 0);
+    if (count < 1 || count > PGS_LOG_MAX_FD)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Output count has to be between 1 and `PGS_LOG_MAX_FD`", 0);
 
-    char msg[PGS_LOG_MAX_ENTRY_LEN];
-    int msg_len = vsnprintf(msg, PGS_LOG_MAX_ENTRY_LEN, fmt, ap);
-    va_end(ap);
+    pgs_output_capacity = count;
+    return pgs_log_set_last_error(PGS_LOG_OK, "Set max outputs", 0);
+}
 
-    if (msg_len < 0) {
-        return pgs_log_set_last_error(PGS_LOG_ERR, "vsnprintf failed", 0);
-    }
+size_t pgs_log_allocated_bytes(void) {
+    return pgs_log_allocated;
+}
 
-    const char *format = PGS_LOG_FORMAT;
-    char log_string[PGS_LOG_MAX_ENTRY_LEN];
-    size_t pos = 0;
+#if PGS_LOG_ENABLE_BUFFERING
+Pgs_Log_Error pgs_log_set_buffer_size(size_t size) {
+    if (size < PGS_LOG_MAX_ENTRY_LEN)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Buffer size has to fit at least `PGS_LOG_MAX_ENTRY_LEN`", 0);
 
-    while (*format && pos < PGS_LOG_MAX_ENTRY_LEN - 1) {
-        if (*format == '%' && *(format +1)) {
-            switch (*(format + 1)) {
-                case 'L':
-                    const char *lvl = pgs_log_level_to_string(level);
-                    size_t lvl_length = strlen(lvl);
-                    if (pos + lvl_length >= PGS_LOG_MAX_ENTRY_LEN -1) break;
-                    memcpy(log_string + pos, lvl, lvl_length);
-                    pos += lvl_length;
-                    break;
-                case 'T':
-                    const char *timestamp = pgs_log_timestamp_string();  // If used more than once per log is less efficient but this way we have most improvement if not used
-                    size_t timestamp_length = strlen(timestamp);         // If used more than once per log is less efficient but this way we have most improvement if not used
-                    if (pos + timestamp_length >= PGS_LOG_MAX_ENTRY_LEN -1) break;
-                    memcpy(log_string + pos, timestamp, timestamp_length);
-                    pos += timestamp_length;
-                    break;
-                case 'F':
-                    if (pos + file_len >= PGS_LOG_MAX_ENTRY_LEN -1) break;
-                    memcpy(log_string + pos, file, file_len);
-                    pos += file_len;
-                    break;
-                case 'l':
-                    if (pos + line_len >= PGS_LOG_MAX_ENTRY_LEN -1) break;
-                    memcpy(log_string + pos, line, line_len);
-                    pos += line_len;
-                    break;
-                case 'M':
-                    if (pos + msg_len >= PGS_LOG_MAX_ENTRY_LEN -1) break;
-                    memcpy(log_string + pos, msg, msg_len);
-                    pos += msg_len;
-                    break;
-                default:
-                    if (pos < PGS_LOG_MAX_ENTRY_LEN - 1) log_string[pos++] = format[0];
-                    if (pos < PGS_LOG_MAX_ENTRY_LEN - 1) log_string[pos++] = format[1];
-                    break;
-            }
-            format += 2;
-        } else {
-            log_string[pos++] = *format++;
-        }
-    }
+    pgs_log_buffer_size = size;
+    return pgs_log_set_last_error(PGS_LOG_OK, "Set buffer size", 0);
+}
 
-    log_string[pos++] = '\n';
-    log_string[pos] = '\0';
+Pgs_Log_Error pgs_log_set_output_buffer_size(int fd, size_t size) {
+    Pgs_Log_Output *o = pgs_log_output_by_fd(fd);
+    if (!o)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "fd does not exist in outputs", 0);
+    if (size < PGS_LOG_MAX_ENTRY_LEN)
+        return pgs_log_set_last_error(PGS_LOG_ERR, "Buffer size has to fit at least `PGS_LOG_MAX_ENTRY_LEN`", 0);
 
-    Pgs_Log_Error err = pgs_log_write_output((const char *)&log_string, pos);
+    // the old buffers go out and back to the allocator, the new size gets allocated on the next entry
+    Pgs_Log_Error err = pgs_log_output_drain(o);
     if (err != PGS_LOG_OK)
         return err;
-
-    return pgs_log_set_last_error(PGS_LOG_OK, "Log entry written", 0);
+    pgs_log_output_buffers_free(o);
+    o->buf_size = size;
+    return pgs_log_set_last_error(PGS_LOG_OK, "Set output buffer size", 0);
 }
+#endif
+#endif // PGS_LOG_ENABLE_DYNAMIC_BUFFERS
 
-Pgs_Log_Error pgs_log_write_output(const char *str, size_t len) {
-    if (!PGS_LOG_ENABLED)
-        return pgs_log_set_last_error(PGS_LOG_OK, "Logging disabled", 0);
+static Pgs_Log_Error pgs_log_remove_output(int index) {
+    Pgs_Log_Output *out = &pgs_outputs[index];
+    Pgs_Log_Error err = PGS_LOG_OK;
 
-    for (int i = 0; i < pgs_output_count; ++i) {
-        Pgs_Log_Output *o = &pgs_outputs[i];
 #if PGS_LOG_ENABLE_BUFFERING
-#if PGS_LOG_BUFFER_INSTA_WRITE_TERMINAL
-        if (o->fd == stderr || o->fd == stdout) {
-            if (pgs_write(fileno(o->fd), str, len) != (ssize_t)len)
-                return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write msg to file", errno);
-            continue;
-        }
+    PGS_LOG_TERMINAL_LOCK_OUTPUT(out);
+    err = pgs_log_output_drain(out);
+    PGS_LOG_TERMINAL_UNLOCK_OUTPUT(out);
+    if (err != PGS_LOG_OK)
+        return err;
 #endif
-        if (o->buf_pos + len > PGS_LOG_MAX_OUTPUT_BUFFER_SIZE) {
-            if (pgs_write(fileno(o->fd), o->buffer, o->buf_pos) != (ssize_t)o->buf_pos)
-                return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write buffer to file", errno);
 
-            o->buf_pos = 0;
+    // what the sink held back still goes out, close cannot report errors
+    if (out->sink.flush) {
+        err = out->sink.flush(out->ctx);
+        if (err != PGS_LOG_OK)
+            return err;
+    }
 
-            if (o->buf_pos + len > PGS_LOG_MAX_OUTPUT_BUFFER_SIZE) {
-#if PGS_LOG_BUFFER_INSTA_WRITE_IF_TOO_LARGE
-                if (pgs_write(fileno(o->fd), str, len) != (ssize_t)len)
-                    return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write msg to file", errno);
+#if PGS_LOG_ENABLE_FILE
+    if (out->file && out->file == pgs_log_file)
+        pgs_log_file = NULL;
 #endif
-                return pgs_log_set_last_error(PGS_LOG_ERR, "Log file to big for buffering, insta writing, can be disabled with `PGS_LOG_BUFFER_INSTA_WRITE_IF_TOO_LARGE false`", 0);
-            }
-        }
 
-        memcpy(o->buffer + o->buf_pos, str, len);
-        o->buf_pos += len;
-#else
-        if (pgs_write(fileno(o->fd), str, len) != len)
-            return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write msg to file", errno);
+#if PGS_LOG_ENABLE_NONBLOCKING
+    pgs_log_nonblock_release(out, PGS_LOG_NONBLOCK_CLOSE_TIMEOUT_MS);
+#endif
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    pgs_log_loop_restore_blocking(out);
 #endif
-    }
-
-    return pgs_log_set_last_error(PGS_LOG_OK, "Wrote/Buffered msg to all outputs", 0);
-}
 
-Pgs_Log_Error pgs_log_flush(void) {
-    for (int i = 0; i < pgs_output_count; ++i) {
-        Pgs_Log_Output *o = &pgs_outputs[i];
-#if PGS_LOG_ENABLE_BUFFERING
-            if (pgs_write(fileno(o->fd), o->buffer, o->buf_pos) != (ssize_t)o->buf_pos)
-                return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to write buffer to file", errno);
+    if (out->sink.close)
+        out->sink.close(out->ctx);
 
-            o->buf_pos = 0;
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS && PGS_LOG_ENABLE_BUFFERING
+    pgs_log_output_buffers_free(out);
 #endif
-            if (fflush(o->fd) != 0)
-                return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to Flush buffer", errno);
+
+#if PGS_LOG_ENABLE_IO_URING
+    // in flight writes refer to their output by index, the last output is about to move
+    if (pgs_log_uring.fd >= 0) {
+        err = pgs_log_uring_wait(&pgs_outputs[pgs_output_count - 1], 0);
+        if (err != PGS_LOG_OK)
+            return err;
     }
+#endif
+#if PGS_LOG_ENABLE_FLUSH_THREAD
+    // the flusher picks outputs by index, the last output is about to move
+    err = pgs_log_flusher_wait(&pgs_outputs[pgs_output_count - 1], 0);
+    if (err != PGS_LOG_OK)
+        return err;
+#endif
 
-    return pgs_log_set_last_error(PGS_LOG_OK, "Flushed all fd's", 0);
+    PGS_LOG_TERMINAL_LOCK();
+    PGS_LOG_FLUSHER_LOCK();
+    pgs_outputs[index] = pgs_outputs[--pgs_output_count];
+    PGS_LOG_FLUSHER_UNLOCK();
+    PGS_LOG_TERMINAL_UNLOCK();
+
+    return err;
 }
 
-const char *pgs_log_level_to_string(Pgs_Log_Level level) {
-    switch (level) {
-        case PGS_LOG_DEBUG: return "DEBUG";
-        case PGS_LOG_INFO: return "INFO";
-        case PGS_LOG_WARN: return "WARN";
-        case PGS_LOG_ERROR: return "ERROR";
-        case PGS_LOG_FATAL: return "FATAL";
-        default: return "UNKNOWN";
+Pgs_Log_Error pgs_log_remove_fd_output(FILE *file) {
+    if (!file) 
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No file passed", 0);
+
+    for (int i = 0; i < pgs_output_count; ++i) {
+        if (pgs_outputs[i].file != file) continue;
+
+        Pgs_Log_Error err = pgs_log_remove_output(i);
+        if (err != PGS_LOG_OK)
+            return err;
+        return pgs_log_set_last_error(PGS_LOG_OK, "Removed File from output", 0);
     }
-}
 
+    return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "file does not exist in output", 0);
+}
 
-const char *pgs_log_timestamp_string(void) {
-    time_t current_time = time(NULL);
+Pgs_Log_Error pgs_log_remove_raw_fd_output(int fd) {
+    for (int i = 0; i < pgs_output_count; ++i) {
+        if (pgs_outputs[i].file || pgs_outputs[i].fd != fd) continue;
 
-    if (current_time != pgs_log_last_timestamp) {
-        struct tm *tm_info = localtime(&current_time);
-        strftime(pgs_log_cached_timestamp, PGS_LOG_MAX_TIMESTAMP_LEN, PGS_LOG_TIMESTAMP_FORMAT, tm_info);
-        pgs_log_last_timestamp = current_time;
+        Pgs_Log_Error err = pgs_log_remove_output(i);
+        if (err != PGS_LOG_OK)
+            return err;
+        return pgs_log_set_last_error(PGS_LOG_OK, "Removed raw fd from output", 0);
     }
 
-    return pgs_log_cached_timestamp;
+    return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "fd does not exist in output", 0);
 }
 
-Pgs_Log_Error pgs_log_add_fd_output(FILE *file) {
-    if (!file)
-        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No File passed to add to output", 0);
+Pgs_Log_Error pgs_log_remove_sink_output(void *ctx) {
+    for (int i = 0; i < pgs_output_count; ++i) {
+        if (pgs_outputs[i].fd >= 0 || pgs_outputs[i].ctx != ctx) continue;
 
-    if (pgs_output_count >= PGS_LOG_MAX_FD) {
-        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "Reached max file descriptor count, you can add `#define PGS_LOG_MAX_FD` and increase the number and recompile", 0);
+        Pgs_Log_Error err = pgs_log_remove_output(i);
+        if (err != PGS_LOG_OK)
+            return err;
+        return pgs_log_set_last_error(PGS_LOG_OK, "Removed sink from output", 0);
     }
 
-    Pgs_Log_Output *o = &pgs_outputs[pgs_output_count++];
+    return pgs_log_set_last_error(PGS_LOG_ERR, "sink does not exist in output", 0);
+}
 
-    o->fd = file;
+#if PGS_LOG_ENABLE_NONBLOCKING
+Pgs_Log_Error pgs_log_set_output_nonblocking(int fd, Pgs_Log_Overflow_Policy policy) {
+    Pgs_Log_Output *o = pgs_log_find_fd_output(fd);
+    if (!o)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "fd does not exist in output", 0);
 
+    if (!o->nonblocking) {
 #if PGS_LOG_ENABLE_BUFFERING
-    o->buf_pos = 0;
+        // nothing may still be queued for io_uring/the flush thread once the output leaves them
+        Pgs_Log_Error err = pgs_log_output_drain(o);
+        if (err != PGS_LOG_OK)
+            return err;
 #endif
+        // only outputs that actually go non-blocking pay for a pending tail
+        o->pending = pgs_log_nonblock_pending_alloc();
+        if (!o->pending)
+            return pgs_log_set_last_error(PGS_LOG_ERR, "Failed to allocate pending output", 0);
+        int flags = fcntl(fd, F_GETFL);
+        int write_fd = flags < 0 ? -1 : pgs_log_nonblock_open(fd, flags);
+        if (write_fd < 0) {
+            int open_err = errno;
+            pgs_log_nonblock_pending_free(o);
+            return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to set O_NONBLOCK", open_err);
+        }
+        o->fd_flags = flags;
+        o->write_fd = write_fd;
+    }
 
-    return pgs_log_set_last_error(PGS_LOG_OK, "Added fd to output", 0);
+    PGS_LOG_FLUSHER_LOCK();
+    o->nonblocking = true;
+    PGS_LOG_FLUSHER_UNLOCK();
+    o->overflow = policy;
+    return pgs_log_set_last_error(PGS_LOG_OK, "Output is non-blocking", 0);
 }
 
+Pgs_Log_Error pgs_log_set_output_blocking(int fd) {
+    Pgs_Log_Output *o = pgs_log_find_fd_output(fd);
+    if (!o)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "fd does not exist in output", 0);
+    if (!o->nonblocking)
+        return pgs_log_set_last_error(PGS_LOG_OK, "Output already blocking", 0);
+
+    // blocking again, the pending tail simply gets written
+    if (fcntl(o->write_fd, F_SETFL, o->fd_flags) != 0)
+        return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to restore fd flags", errno);
+    Pgs_Log_Error err = pgs_log_nonblock_drain(o);
+    if (err != PGS_LOG_OK)
+        return err;
 
-Pgs_Log_Error pgs_log_remove_fd_output(FILE *file) {
-    if (!file) 
-        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "No file passed", 0);
-
-    int fd_index = -1;
+    PGS_LOG_FLUSHER_LOCK();
+    o->nonblocking = false;
+    PGS_LOG_FLUSHER_UNLOCK();
+    pgs_log_nonblock_put_back(o);
+    return pgs_log_set_last_error(PGS_LOG_OK, "Output is blocking", 0);
+}
 
-    for (int i = 0; i < pgs_output_count; ++i) {
-        Pgs_Log_Output *out = &pgs_outputs[i];
-        if (out->fd == file) {
-            fd_index = i;
-            break;
-        };
-    }
+Pgs_Log_Error pgs_log_poll_outputs(int timeout_ms) {
+    uint64_t deadline = pgs_log_now_ms() + (uint64_t)(timeout_ms > 0 ? timeout_ms : 0);
+
+    for (;;) {
+        struct pollfd fds[PGS_LOG_MAX_FD];
+        Pgs_Log_Output *polled[PGS_LOG_MAX_FD];
+        int count = 0;
+        for (int i = 0; i < pgs_output_count; ++i) {
+            Pgs_Log_Output *o = &pgs_outputs[i];
+            if (!o->nonblocking || o->pending_len == 0) continue;
+            fds[count] = (struct pollfd){ .fd = o->write_fd, .events = POLLOUT };
+            polled[count++] = o;
+        }
+        if (count == 0)
+            return pgs_log_set_last_error(PGS_LOG_OK, "No pending output", 0);
 
-    if (fd_index == -1) 
-        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "file does not exist in output", 0);
+        int wait_ms = -1;
+        if (timeout_ms >= 0) {
+            uint64_t now = pgs_log_now_ms();
+            wait_ms = now >= deadline ? 0 : (int)(deadline - now);
+        }
 
-    Pgs_Log_Output *out = &pgs_outputs[fd_index];
+        int ready = poll(fds, (nfds_t)count, wait_ms);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return pgs_log_set_last_error(PGS_LOG_ERR_IO, "Failed to poll outputs", errno);
+        }
+        if (ready == 0)
+            return pgs_log_set_last_error(PGS_LOG_OK, "Output still pending after timeout", 0);
+
+        for (int i = 0; i < count; ++i) {
+            Pgs_Log_Output *o = polled[i];
+            if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                // the reader is gone, nothing will ever take the tail
+                pgs_log_nonblock_count_drop(o, o->pending + o->pending_off, o->pending_len);
+                o->pending_len = 0;
+                o->pending_off = 0;
+            } else if (fds[i].revents & POLLOUT) {
+                Pgs_Log_Error err = pgs_log_nonblock_drain(o);
+                if (err != PGS_LOG_OK)
+                    return err;
+            }
+        }
 
-    if (out->fd != stdout && out->fd != stderr)
-        fclose(out->fd);
+        if (timeout_ms == 0)
+            return pgs_log_set_last_error(PGS_LOG_OK, "Polled outputs once", 0);
+    }
+}
 
-    pgs_outputs[fd_index] = pgs_outputs[--pgs_output_count];
+Pgs_Log_Error pgs_log_get_output_stats(int fd, Pgs_Log_Output_Stats *stats) {
+    Pgs_Log_Output *o = pgs_log_find_fd_output(fd);
+    if (!o || !stats)
+        return pgs_log_set_last_error(PGS_LOG_ERR_FILE, "fd does not exist in output", 0);
 
-    return pgs_log_set_last_error(PGS_LOG_OK, "Removed File from output", 0);
+    stats->pending = o->pending_len;
+    stats->dropped_entries = o->dropped_entries;
+    stats->dropped_bytes = o->dropped_bytes;
+    stats->stalls = o->stalls;
+    return pgs_log_set_last_error(PGS_LOG_OK, "Got output stats", 0);
 }
+#endif
 
 Pgs_Log_Error pgs_log_mkdir_if_not_exists(const char *path) {
 #ifdef _WIN32
@@ -621,15 +6226,53 @@ void pgs_log_cleanup(void) {
     if (pgs_log_flush() != PGS_LOG_OK)
         pgs_log_print_error_detail();
 
+#if PGS_LOG_ENABLE_FLUSH_THREAD
+    pgs_log_flusher_stop();
+#endif
+#if PGS_LOG_TERMINAL_TIMER
+    pgs_log_terminal_timer_stop();
+#endif
+
     for (int i = 0; i < pgs_output_count; ++i) {
         Pgs_Log_Output *out = &pgs_outputs[i];
-        if (!out->fd) continue;
-        if (out->fd == stdout || out->fd == stderr) continue;
-
-        fclose(out->fd);
-        out->fd = NULL;
+#if PGS_LOG_ENABLE_NONBLOCKING
+        pgs_log_nonblock_release(out, PGS_LOG_NONBLOCK_CLOSE_TIMEOUT_MS);
+#endif
+#if PGS_LOG_ENABLE_EVENT_LOOP
+        pgs_log_loop_restore_blocking(out);
+#endif
+        if (out->sink.close)
+            out->sink.close(out->ctx);
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS && PGS_LOG_ENABLE_BUFFERING
+        pgs_log_output_buffers_free(out);
+#endif
     }
     pgs_output_count = 0;
+#if PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+    pgs_log_mem_free(pgs_outputs, (size_t)pgs_output_capacity * sizeof(Pgs_Log_Output));
+    pgs_outputs = NULL;
+    if (pgs_log_allocator.alloc == pgs_log_arena_alloc) pgs_log_arena.used = 0;
+#endif
+
+#if PGS_LOG_SWITCHES_LOG_FILE
+    // every queue is empty by now
+    for (int i = 0; i < PGS_LOG_OUTPUT_BUFFERS + 1; ++i) {
+        if (pgs_log_retired_files[i]) fclose(pgs_log_retired_files[i]);
+        pgs_log_retired_files[i] = NULL;
+    }
+#if PGS_LOG_ENABLE_ROTATION
+    pgs_log_discard_standby();
+#endif
+#endif
+#if PGS_LOG_ENABLE_FILE
+    pgs_log_file = NULL;
+#endif
+
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    if (pgs_log_loop.fd >= 0) close(pgs_log_loop.fd);
+    pgs_log_loop.fd = -1;
+    pgs_log_loop.signalled = false;
+#endif
     pgs_log_initialized = false;
 }
 
@@ -685,10 +6328,57 @@ char *pgs_log_temp_sprintf(const char *format, ...) {
     #ifdef PGS_LOG_STRIP_PREFIX
 
         #define log pgs_log
+        #define log_module pgs_log_module
+        #define log_modulev pgs_log_modulev
+        #define set_module_level pgs_log_set_module_level
+        #define reset_module_level pgs_log_reset_module_level
+        #define get_module_level pgs_log_get_module_level
+        #define module_name pgs_log_module_name
+        #define ratelimit_site pgs_log_ratelimit_site
+        #define ratelimit_allow pgs_log_ratelimit_allow
+        #define sample_allow pgs_log_sample_allow
+        #define ratelimit_report pgs_log_ratelimit_report
+        #define io_uring_active pgs_log_io_uring_active
+        #define flush_thread_active pgs_log_flush_thread_active
+        #define add_mmap_output pgs_log_add_mmap_output
+        #define remove_mmap_output pgs_log_remove_mmap_output
+        #define add_direct_output pgs_log_add_direct_output
+        #define remove_direct_output pgs_log_remove_direct_output
+        #define direct_output_is_direct pgs_log_direct_output_is_direct
+        #define add_segment_output pgs_log_add_segment_output
+        #define remove_segment_output pgs_log_remove_segment_output
+        #define segments_dump pgs_log_segments_dump
+        #define add_syslog_output pgs_log_add_syslog_output
+        #define remove_syslog_output pgs_log_remove_syslog_output
         #define level_to_string pgs_log_level_to_string
         #define timestamp_string pgs_log_timestamp_string
         #define add_fd_output pgs_log_add_fd_output
         #define remove_fd_output pgs_log_remove_fd_output
+        #define add_raw_fd_output pgs_log_add_raw_fd_output
+        #define remove_raw_fd_output pgs_log_remove_raw_fd_output
+        #define add_sink_output pgs_log_add_sink_output
+        #define add_callback_output pgs_log_add_callback_output
+        #define remove_sink_output pgs_log_remove_sink_output
+        #define memory_sink_init pgs_log_memory_sink_init
+        #define add_memory_output pgs_log_add_memory_output
+        #define set_output_level pgs_log_set_output_level
+        #define set_allocator pgs_log_set_allocator
+        #define use_arena pgs_log_use_arena
+        #define set_max_outputs pgs_log_set_max_outputs
+        #define set_buffer_size pgs_log_set_buffer_size
+        #define set_output_buffer_size pgs_log_set_output_buffer_size
+        #define allocated_bytes pgs_log_allocated_bytes
+        #define set_output_format pgs_log_set_output_format
+        #define add_compressed_output pgs_log_add_compressed_output
+        #define remove_compressed_output pgs_log_remove_compressed_output
+        #define compressed_dump pgs_log_compressed_dump
+        #define add_pipe_output pgs_log_add_pipe_output
+        #define remove_pipe_output pgs_log_remove_pipe_output
+        #define pipe_output_is_spliced pgs_log_pipe_output_is_spliced
+        #define set_output_nonblocking pgs_log_set_output_nonblocking
+        #define set_output_blocking pgs_log_set_output_blocking
+        #define poll_outputs pgs_log_poll_outputs
+        #define get_output_stats pgs_log_get_output_stats
         #define mkdir_if_not_exists pgs_log_mkdir_if_not_exists
         #define create_dirs_for_path pgs_log_create_dirs_for_path
         #define file_exists pgs_log_file_exists
@@ -701,6 +6391,14 @@ char *pgs_log_temp_sprintf(const char *format, ...) {
         #define cleanup pgs_log_cleanup
         #define write_output pgs_log_write_output
         #define flush pgs_log_flush
+        #define backlog_flush pgs_log_backlog_flush
+        #define backlog_clear pgs_log_backlog_clear
+        #define flight_recorder_init pgs_log_flight_recorder_init
+        #define flight_recorder_write pgs_log_flight_recorder_write
+        #define flight_recorder_dump pgs_log_flight_recorder_dump
+        #define flight_recorder_read pgs_log_flight_recorder_read
+        #define flight_recorder_install_signal pgs_log_flight_recorder_install_signal
+        #define flight_recorder_install_crash_handler pgs_log_flight_recorder_install_crash_handler
 
 
         #define LOG_DEBUG PGS_LOG_DEBUG
@@ -708,13 +6406,55 @@ char *pgs_log_temp_sprintf(const char *format, ...) {
         #define LOG_WARN PGS_LOG_WARN
         #define LOG_ERROR PGS_LOG_ERROR
         #define LOG_FATAL PGS_LOG_FATAL
+        #define LOG_DEBUG_RATELIMITED PGS_LOG_DEBUG_RATELIMITED
+        #define LOG_INFO_RATELIMITED PGS_LOG_INFO_RATELIMITED
+        #define LOG_WARN_RATELIMITED PGS_LOG_WARN_RATELIMITED
+        #define LOG_ERROR_RATELIMITED PGS_LOG_ERROR_RATELIMITED
+        #define LOG_FATAL_RATELIMITED PGS_LOG_FATAL_RATELIMITED
+        #define LOG_DEBUG_SAMPLED PGS_LOG_DEBUG_SAMPLED
+        #define LOG_INFO_SAMPLED PGS_LOG_INFO_SAMPLED
+        #define LOG_WARN_SAMPLED PGS_LOG_WARN_SAMPLED
+        #define LOG_ERROR_SAMPLED PGS_LOG_ERROR_SAMPLED
+        #define LOG_FATAL_SAMPLED PGS_LOG_FATAL_SAMPLED
 
         #define Log_Level Pgs_Log_Level
         #define Log_Error Pgs_Log_Error
         #define Log_Error_Detail Pgs_Log_Error_Detail
         #define Log_Output Pgs_Log_Output
+        #define Log_Sink Pgs_Log_Sink
+        #define Log_Sink_Write Pgs_Log_Sink_Write
+        #define Log_Memory_Sink Pgs_Log_Memory_Sink
+        #define Log_Pipe_Output Pgs_Log_Pipe_Output
+        #define Log_Compressed_Output Pgs_Log_Compressed_Output
+        #define Log_Codec Pgs_Log_Codec
+        #define Log_Overflow_Policy Pgs_Log_Overflow_Policy
+        #define Log_Output_Stats Pgs_Log_Output_Stats
+        #define Log_Module Pgs_Log_Module
+        #define Log_Ratelimit Pgs_Log_Ratelimit
+        #define Log_Mmap_Output Pgs_Log_Mmap_Output
+        #define Log_Durability Pgs_Log_Durability
+        #define Log_Direct_Output Pgs_Log_Direct_Output
+        #define Log_Segment_Output Pgs_Log_Segment_Output
+        #define Log_Syslog_Output Pgs_Log_Syslog_Output
+        #define Log_Syslog_Format Pgs_Log_Syslog_Format
+        #define Log_Allocator Pgs_Log_Allocator
 
         #define minimal_log_level pgs_log_minimal_log_level
+        #define flush_level pgs_log_flush_level
+        #define log_sync pgs_log_sync
+        #define flush_if_due pgs_log_flush_if_due
+        #define event_fd pgs_log_event_fd
+        #define service pgs_log_service
+        #define service_pending pgs_log_service_pending
+        #define flush_terminals pgs_log_flush_terminals
+        #define reopen pgs_log_reopen
+        #define install_reopen_signal pgs_log_install_reopen_signal
+        #define durability pgs_log_durability
+        #define last_sequence pgs_log_last_sequence
+        #define truncated_count pgs_log_truncated_count
+        #define durable_sequence pgs_log_durable_sequence
+        #define wait_durable pgs_log_wait_durable
+        #define flight_recorder_level pgs_log_flight_recorder_level
 
     #endif // PGS_LOG_STRIP_PREFIX
 
@@ -723,6 +6463,122 @@ char *pgs_log_temp_sprintf(const char *format, ...) {
 /* 
     Revision History:
 
+        0.29.0 (2026-10-19) Large entries
+                            - messages past `PGS_LOG_MAX_ENTRY_LEN` get cut instead of left out, pgs_log_truncated_count()
+                            - `PGS_LOG_ENABLE_LARGE_ENTRIES` writes them whole, in one write if larger than the output buffer
+
+        0.28.0 (2026-10-19) Runtime sized output buffers
+                            - `PGS_LOG_ENABLE_DYNAMIC_BUFFERS` (default) allocates the outputs with the first one and buffers on first use
+                            - pgs_log_set_allocator()/pgs_log_use_arena() for the memory, pgs_log_set_max_outputs()
+                            - pgs_log_set_buffer_size() and pgs_log_set_output_buffer_size() pick buffer sizes at runtime
+
+        0.27.0 (2026-10-19) Compressed file outputs
+                            - pgs_log_add_compressed_output(), one independent frame per written buffer plus a seek index
+
+        0.26.0 (2026-10-19) Event loop mode
+                            - log calls only queue buffers and signal an eventfd, pgs_log_service(budget) writes them
+
+        0.25.0 (2026-10-19) Per output level and format
+                            - pgs_log_set_output_level/format, formats rendered lazily once per entry, %C/%R colour placeholders
+
+        0.24.0 (2026-10-19) Adaptive terminal writes
+                            - `PGS_LOG_TERMINAL_COALESCE_US` coalesces stdout/stderr writes within a latency budget
+
+        0.23.0 (2026-10-19) Zero copy pipe output
+                            - vmsplice(SPLICE_F_GIFT) pipe outputs from page aligned buffers, stdout uses it when it is a pipe
+
+        0.22.0 (2026-10-19) Non-blocking outputs
+                            - `PGS_LOG_ENABLE_NONBLOCKING` adds pgs_log_set_output_nonblocking(), EAGAIN keeps the unwritten
+                              tail up to `PGS_LOG_NONBLOCK_PENDING_SIZE`, drop newest/oldest or block once full
+                            - pgs_log_poll_outputs() and pgs_log_get_output_stats()
+
+        0.21.0 (2026-10-19) Syslog/journald output
+                            - `PGS_LOG_ENABLE_SYSLOG_OUTPUT` adds pgs_log_add_syslog_output(), RFC 5424 or journald native
+                              datagrams on a unix socket, batched with sendmmsg() on flush, reconnects once per batch
+
+        0.20.0 (2026-10-19) Pluggable sinks
+                            - outputs write through a `Pgs_Log_Sink` (write/flush/close), pgs_log_add_sink_output()
+                            - built in raw fd (optional ownership), callback and memory sinks
+                            - FILE outputs are written through their fd only, no more fflush() in pgs_log_flush()
+
+        0.19.0 (2026-10-19) Circular log segments
+                            - `PGS_LOG_ENABLE_SEGMENTS` adds pgs_log_add_segment_output(), a fixed set of preallocated
+                              segment files reused oldest first with a generation header, pgs_log_segments_dump()
+                            - `PGS_LOG_FILE_SEGMENTS` uses it for the default log file
+
+        0.18.0 (2026-10-19) Reopen the log file
+                            - pgs_log_reopen() drains buffered entries into the old file and opens the path again
+                            - pgs_log_install_reopen_signal(signo) only sets a flag, the next log call or flush reopens
+
+        0.17.0 (2026-10-19) Date rollover
+                            - `PGS_LOG_PATH` is formatted again when the cached timestamp changes, the log file follows it
+                            - the new file is picked with the same append/override/numbered logic as at startup
+
+        0.16.0 (2026-10-19) Log rotation
+                            - `PGS_LOG_ROTATE_SIZE`/`PGS_LOG_ROTATE_INTERVAL_S` continue in the next free `name(N).ext`
+                            - the next file is opened ahead, the rotating log call only swaps the output's file
+                            - closing, preparing the next file and `PGS_LOG_ROTATE_KEEP` retention run in pgs_log_flush()
+
+        0.15.0 (2026-10-19) Durability modes
+                            - entries get sequence numbers, pgs_log_last_sequence()/pgs_log_durable_sequence()
+                            - pgs_log_durability: none, periodic (`PGS_LOG_DURABILITY_INTERVAL_MS`) or group commit on flush
+                            - pgs_log_wait_durable(seq) lets concurrent callers share one fdatasync
+                            - last error is kept per thread
+
+        0.14.0 (2026-10-19) Flush policy
+                            - entries >= pgs_log_flush_level (`PGS_LOG_FLUSH_LEVEL`) flush all outputs, `PGS_LOG_FLUSH_SYNC` also fdatasyncs
+                            - `PGS_LOG_MAX_BUFFER_AGE_MS` flushes buffers once their oldest entry is that old
+                            - pgs_log_flush_if_due() for timers, pgs_log_sync() to flush and fdatasync
+
+        0.13.0 (2026-10-19) O_DIRECT file outputs
+                            - pgs_log_add_direct_output/pgs_log_remove_direct_output write aligned blocks with O_DIRECT
+                            - the last partial block is padded and the file cut to its real length on flush and cleanup
+                            - falls back to posix_fadvise(DONTNEED) after each write if O_DIRECT is rejected
+                            - `PGS_LOG_FILE_DIRECT` opens the default log file as direct output
+
+        0.12.0 (2026-10-19) Background flush thread
+                            - `PGS_LOG_ENABLE_FLUSH_THREAD` hands full buffers to a flusher thread instead of write()ing on the caller
+                            - the caller only stalls if all `PGS_LOG_OUTPUT_BUFFERS` of an output are still being written
+                            - pgs_log_flush_thread_active()
+
+        0.11.0 (2026-10-19) mmap file outputs
+                            - pgs_log_add_mmap_output/pgs_log_remove_mmap_output write entries into a sliding mapped window
+                            - files grow in preallocated window chunks and are cut to their real length on flush and cleanup
+                            - `PGS_LOG_FILE_MMAP` opens the default log file as mmap output
+
+        0.10.0 (2026-10-19) io_uring output backend
+                            - `PGS_LOG_ENABLE_IO_URING` submits full buffers as io_uring writes, the logger continues in the next buffer
+                            - `PGS_LOG_OUTPUT_BUFFERS` buffers per output, the caller only stalls if all of them are in flight
+                            - pgs_log_flush submits every output with one io_uring_enter, falls back to write() without io_uring
+                            - removing an output writes its buffered entries before closing it
+
+        0.9.0 (2026-10-19) Rate limiting and sampling
+                            - PGS_LOG_*_RATELIMITED(n_per_sec, ...) and PGS_LOG_*_SAMPLED(one_in_n, ...) expressions with lock free
+                              static state per callsite (a `PGS_LOG_MAX_RATELIMIT_SITES` table without statement expressions)
+                            - suppressed calls return PGS_LOG_OK before their arguments are evaluated
+                            - "suppressed N messages from file:line" summary once the window is over, with the next entry through,
+                              from pgs_log_flush_if_due() and on pgs_log_flush()
+
+        0.8.0 (2026-10-19) Per module log levels
+                            - `PGS_LOG_MODULES(X)` declares modules, `PGS_LOG_MODULE` selects the module of a translation unit
+                            - levels are inherited by dotted children and resolved when set, log path only does one array lookup
+                            - added pgs_log_module/pgs_log_modulev, pgs_log keeps logging to the root module
+
+        0.7.0 (2026-10-19) USDT probes
+                            - `PGS_LOG_ENABLE_USDT` emits pgs_log:callsite at every macro callsite and pgs_log:message with the formatted message
+                            - message probe also fires for filtered entries while a tracer is attached (semaphore)
+                            - no systemtap headers needed, linux x86_64 only
+
+        0.6.0 (2026-10-19) Flight recorder
+                            - `PGS_LOG_ENABLE_FLIGHT_RECORDER` in memory ring sink with its own level, never does io
+                            - can be backed by a file via mmap so it survives crashes, `pgs_log_flight_recorder_read` to recover
+                            - dump on demand, on a signal or from a crash handler
+
+        0.5.0 (2026-10-19) Deferred debug backlog
+                            - `PGS_LOG_ENABLE_BACKLOG` keeps entries below the minimal level unformatted in a per thread ring
+                            - ring gets rendered and written once an entry >= `PGS_LOG_BACKLOG_TRIGGER_LEVEL` is logged
+                            - level macros are expressions again so their return value can be checked
+
         0.4.4 (2025-09-29) Bug fixes + SigInt handler
 
         0.4.3 (2025-09-27) Performance Improvements
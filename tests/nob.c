@@ -7,11 +7,28 @@
 typedef struct {
     const char *name;
     const char **defines;
+    const char **libs;              // optional, after the test file
 } Test_Config;
 
+// `./nob bench` builds and runs the benchmarks instead of the tests
+static int run_bench(void) {
+    if (!mkdir_if_not_exists(BUILD_FOLDER)) return 1;
+
+    Nob_Cmd cmd = {0};
+    cmd_append(&cmd, "cc", "-O2", "-Wall", "-Wextra", "-I..");
+    cmd_append(&cmd, "-o", BUILD_FOLDER"pgs_log_bench", "pgs_log_bench.c", "-lpthread");
+    if (!cmd_run(&cmd)) return 1;
+
+    cmd.count = 0;
+    cmd_append(&cmd, "./"BUILD_FOLDER"pgs_log_bench");
+    return cmd_run(&cmd) ? 0 : 1;
+}
+
 int main(int argc, char **argv) {
     NOB_GO_REBUILD_URSELF(argc, argv);
 
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) return run_bench();
+
     Test_Config configs[] = {
         {
             .name = "default",
@@ -78,6 +95,258 @@ int main(int argc, char **argv) {
                 NULL
             }
         },
+        {
+            .name = "backlog",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_BACKLOG=1",
+                "PGS_LOG_BACKLOG_ENTRIES=4",
+                NULL
+            }
+        },
+        {
+            .name = "flight_recorder",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_FLIGHT_RECORDER=1",
+                "PGS_LOG_FLIGHT_RECORDER_SIZE=4096",
+                "PGS_LOG_FLIGHT_RECORDER_DUMP_PATH=\"flight_signal.log\"",
+                NULL
+            }
+        },
+        {
+            .name = "modules",
+            .defines = (const char *[]) {
+                "PGS_LOG_MODULES(X)=X(NET, \"net\") X(NET_TLS, \"net.tls\") X(DB, \"db\")",
+                "PGS_LOG_TEST_MODULES",
+                NULL
+            }
+        },
+        {
+            .name = "io_uring",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_IO_URING=1",
+                "PGS_LOG_OUTPUT_BUFFERS=3",
+                "PGS_LOG_MAX_OUTPUT_BUFFER_SIZE=4096",
+                NULL
+            }
+        },
+        {
+            .name = "flush_thread",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_FLUSH_THREAD=1",
+                "PGS_LOG_OUTPUT_BUFFERS=3",
+                "PGS_LOG_MAX_OUTPUT_BUFFER_SIZE=4096",
+                NULL
+            }
+        },
+        {
+            .name = "mmap_output",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_MMAP_OUTPUT=1",
+                "PGS_LOG_FILE_MMAP=1",
+                "PGS_LOG_MMAP_WINDOW_SIZE=8192",
+                "PGS_LOG_MMAP_GROW_SIZE=65536",
+                NULL
+            }
+        },
+        {
+            .name = "direct_output",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_DIRECT_OUTPUT=1",
+                "PGS_LOG_FILE_DIRECT=1",
+                "PGS_LOG_DIRECT_BUFFER_SIZE=8192",
+                NULL
+            }
+        },
+        {
+            .name = "segments",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_SEGMENTS=1",
+                "PGS_LOG_FILE_SEGMENTS=1",
+                "PGS_LOG_SEGMENT_COUNT=4",
+                "PGS_LOG_SEGMENT_SIZE=8192",
+                "PGS_LOG_SEGMENT_BUFFER_SIZE=1024",
+                NULL
+            }
+        },
+        {
+            .name = "syslog_output",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_SYSLOG_OUTPUT=1",
+                "PGS_LOG_SYSLOG_BATCH=4",
+                NULL
+            }
+        },
+        {
+            .name = "syslog_send",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_SYSLOG_OUTPUT=1",
+                "PGS_LOG_SYSLOG_SENDMMSG=0",
+                NULL
+            }
+        },
+        {
+            .name = "nonblocking",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_NONBLOCKING=1",
+                "PGS_LOG_NONBLOCK_PENDING_SIZE=16384",
+                NULL
+            }
+        },
+        {
+            .name = "vmsplice",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_VMSPLICE=1",
+                "PGS_LOG_VMSPLICE_BUFFER_SIZE=65536",
+                "PGS_LOG_VMSPLICE_MIN_GIFT=8192",
+                NULL
+            }
+        },
+        {
+            .name = "terminal_coalesce",
+            .defines = (const char *[]) {
+                "PGS_LOG_TERMINAL_COALESCE_US=200000",
+                "PGS_LOG_TERMINAL_COALESCE_ENTRIES=8",
+                NULL
+            }
+        },
+        {
+            .name = "output_formats",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_OUTPUT_FORMATS=1",
+                "PGS_LOG_MAX_OUTPUT_FORMATS=2",
+                NULL
+            }
+        },
+        {
+            .name = "event_loop",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_EVENT_LOOP=1",
+                "PGS_LOG_MAX_OUTPUT_BUFFER_SIZE=4096",
+                NULL
+            }
+        },
+        {
+            .name = "compression",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_COMPRESSION=1",
+                "PGS_LOG_COMPRESS_FRAME_SIZE=16384",
+                NULL
+            }
+        },
+        {
+            .name = "compression_zlib",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_COMPRESSION=1",
+                "PGS_LOG_COMPRESS_ZLIB=1",
+                NULL
+            },
+            .libs = (const char *[]) {
+                "-lz",
+                NULL
+            }
+        },
+        {
+            .name = "static_buffers",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_DYNAMIC_BUFFERS=0",
+                "PGS_LOG_ENABLE_STDOUT=1",
+                NULL
+            }
+        },
+        {
+            .name = "static_buffers_threaded",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_DYNAMIC_BUFFERS=0",
+                "PGS_LOG_ENABLE_FLUSH_THREAD=1",
+                NULL
+            }
+        },
+        {
+            .name = "large_entries",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_LARGE_ENTRIES=1",
+                NULL
+            }
+        },
+        {
+            .name = "large_entries_threaded",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_LARGE_ENTRIES=1",
+                "PGS_LOG_ENABLE_FLUSH_THREAD=1",
+                NULL
+            }
+        },
+        {
+            .name = "flush_policy",
+            .defines = (const char *[]) {
+                "PGS_LOG_FLUSH_SYNC=1",
+                "PGS_LOG_MAX_BUFFER_AGE_MS=50",
+                NULL
+            }
+        },
+        {
+            .name = "group_commit",
+            .defines = (const char *[]) {
+                "PGS_LOG_DURABILITY=PGS_LOG_DURABILITY_GROUP_COMMIT",
+                NULL
+            }
+        },
+        {
+            .name = "periodic_sync",
+            .defines = (const char *[]) {
+                "PGS_LOG_DURABILITY=PGS_LOG_DURABILITY_PERIODIC",
+                "PGS_LOG_DURABILITY_INTERVAL_MS=30",
+                NULL
+            }
+        },
+        {
+            .name = "rotation",
+            .defines = (const char *[]) {
+                "PGS_LOG_PATH=\"logs/rotation.log\"",
+                "PGS_LOG_ROTATE_SIZE=4096",
+                "PGS_LOG_ROTATE_KEEP=3",
+                "PGS_LOG_ENABLE_STDOUT=0",
+                "PGS_LOG_ENABLE_OUTPUT_FORMATS=1",
+                NULL
+            }
+        },
+        {
+            .name = "rotation_threaded",
+            .defines = (const char *[]) {
+                "PGS_LOG_PATH=\"logs/rotation_threaded.log\"",
+                "PGS_LOG_ROTATE_SIZE=4096",
+                "PGS_LOG_ROTATE_KEEP=3",
+                "PGS_LOG_ENABLE_STDOUT=0",
+                "PGS_LOG_ENABLE_FLUSH_THREAD=1",
+                "PGS_LOG_OUTPUT_BUFFERS=3",
+                "PGS_LOG_MAX_OUTPUT_BUFFER_SIZE=4096",
+                NULL
+            }
+        },
+        {
+            .name = "rotation_keep_all",
+            .defines = (const char *[]) {
+                "PGS_LOG_PATH=\"logs/rotation_all.log\"",
+                "PGS_LOG_ROTATE_SIZE=4096",
+                "PGS_LOG_ENABLE_STDOUT=0",
+                NULL
+            }
+        },
+        {
+            .name = "date_rollover",
+            .defines = (const char *[]) {
+                "PGS_LOG_PATH=\"logs/rollover-%H%M%S.log\"",
+                "PGS_LOG_TEST_ROLLOVER",
+                NULL
+            }
+        },
+        {
+            .name = "usdt",
+            .defines = (const char *[]) {
+                "PGS_LOG_ENABLE_USDT=1",
+                NULL
+            }
+        },
     };
 
     if (!mkdir_if_not_exists(BUILD_FOLDER)) {
@@ -99,6 +368,9 @@ int main(int argc, char **argv) {
             cmd_append(&cmd, "-D", config->defines[j]);
         }
         cmd_append(&cmd, test_file);
+        for (size_t j = 0; config->libs && config->libs[j] != NULL; ++j) {
+            cmd_append(&cmd, config->libs[j]);
+        }
 
         if (!cmd_run(&cmd)) {
             fprintf(stderr, "Failed to compile %s with config %s\n", test_file, config->name);
@@ -0,0 +1,81 @@
+// throughput of the library's own output paths, built and run with `./nob bench`
+#define PGS_LOG_ENABLE_FILE false
+#define PGS_LOG_ENABLE_STDOUT false
+#ifdef __linux__
+#   define PGS_LOG_ENABLE_VMSPLICE true
+#endif
+#define PGS_LOG_IMPLEMENTATION
+#include "pgs_log.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    int fd;
+    size_t bytes;
+} Reader;
+
+static void *reader_thread(void *arg) {
+    Reader *r = arg;
+    static char chunk[64 * 1024];
+    for (;;) {
+        ssize_t n = read(r->fd, chunk, sizeof(chunk));
+        if (n <= 0) return NULL;
+        r->bytes += (size_t)n;
+    }
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// logs `total` bytes of entries into a pipe through a raw fd output (write()) or a pipe output (vmsplice)
+static double bench_pipe(bool spliced, size_t total) {
+    int fds[2];
+    if (pipe(fds) != 0) return 0;
+    Reader reader = { .fd = fds[0] };
+    pthread_t thread;
+    pthread_create(&thread, NULL, reader_thread, &reader);
+
+    char payload[200];
+    memset(payload, 'x', sizeof(payload) - 1);
+    payload[sizeof(payload) - 1] = '\0';
+
+    Pgs_Log_Error err = PGS_LOG_ERR;
+#if PGS_LOG_ENABLE_VMSPLICE
+    if (spliced) err = pgs_log_add_pipe_output(fds[1], true);
+#endif
+    if (!spliced) err = pgs_log_add_raw_fd_output(fds[1], true);
+    if (err != PGS_LOG_OK) {
+        pgs_log_print_error_detail();
+        return 0;
+    }
+
+    double start = now_seconds();
+    size_t entries = total / 256;
+    for (size_t i = 0; i < entries; ++i)
+        PGS_LOG_INFO("%s", payload);
+    pgs_log_flush();
+
+#if PGS_LOG_ENABLE_VMSPLICE
+    if (spliced) pgs_log_remove_pipe_output(fds[1]);
+#endif
+    if (!spliced) pgs_log_remove_raw_fd_output(fds[1]);
+    pthread_join(thread, NULL);
+    double seconds = now_seconds() - start;
+    close(fds[0]);
+    return seconds > 0 ? (double)reader.bytes / seconds / (1024 * 1024) : 0;
+}
+
+int main(void) {
+    const size_t total = 256 * 1024 * 1024;
+    printf("pipe, raw fd output (write):   %.0f MiB/s\n", bench_pipe(false, total));
+#if PGS_LOG_ENABLE_VMSPLICE
+    printf("pipe, pipe output (vmsplice):  %.0f MiB/s\n", bench_pipe(true, total));
+#endif
+    pgs_log_cleanup();
+    return 0;
+}
@@ -4,6 +4,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
 
 #define ASSERT(cond, msg) do { \
     if (!(cond)) { \
@@ -104,6 +109,18 @@ static FILE *find_log_file(char *fname, int check_incremented) {
     return rf;
 }
 
+// bytes of entries in the log file, a direct log file keeps its last block zero padded until cleanup
+static long log_file_size(FILE *rf) {
+#if (PGS_LOG_ENABLE_DIRECT_OUTPUT && PGS_LOG_FILE_DIRECT) || (PGS_LOG_ENABLE_MMAP_OUTPUT && PGS_LOG_FILE_MMAP)
+    long size = 0;
+    for (int c; (c = fgetc(rf)) != EOF && c != '\0';) size++;
+    return size;
+#else
+    fseek(rf, 0, SEEK_END);
+    return ftell(rf);
+#endif
+}
+
 static int test_file_creation_and_flush() {
     ASSERT(PGS_LOG_INFO("File creation test") == PGS_LOG_OK, "Initial file log failed");
     ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
@@ -113,6 +130,14 @@ static int test_file_creation_and_flush() {
 static int test_file_modes() {
 #if !PGS_LOG_ENABLED
     return 0;
+#endif
+#ifdef PGS_LOG_TEST_ROLLOVER
+    // the per second test path would switch files under the test
+    return 0;
+#endif
+#if PGS_LOG_FILE_SEGMENTS
+    // the log file is a set of reused segments, append/override/numbering do not apply
+    return 0;
 #endif
     time_t t = time(NULL);
     struct tm *ti = localtime(&t);
@@ -120,6 +145,7 @@ static int test_file_modes() {
     strftime(fname, sizeof(fname), PGS_LOG_PATH, ti);
 
     remove(fname);
+    pgs_log_cleanup();
 
     ASSERT(PGS_LOG_INFO("first entry") == PGS_LOG_OK, "First entry failed");
     ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush after first entry failed");
@@ -133,8 +159,7 @@ static int test_file_modes() {
 #endif
                              );
     ASSERT(rf, "File not created");
-    fseek(rf, 0, SEEK_END);
-    size_after_first = ftell(rf);
+    size_after_first = log_file_size(rf);
     fclose(rf);
     ASSERT(size_after_first > 0, "File empty after first write");
 
@@ -144,8 +169,7 @@ static int test_file_modes() {
     long size_after_second = 0;
     rf = fopen(fname, "rb");
     ASSERT(rf, "File vanished");
-    fseek(rf, 0, SEEK_END);
-    size_after_second = ftell(rf);
+    size_after_second = log_file_size(rf);
     fclose(rf);
     ASSERT(size_after_second > size_after_first, "Append mode did not increase size");
 #elif !PGS_LOG_APPEND && PGS_LOG_OVERRIDE
@@ -154,8 +178,7 @@ static int test_file_modes() {
     long size_after_second = 0;
     rf = fopen(fname, "rb");
     ASSERT(rf, "File missing override");
-    fseek(rf, 0, SEEK_END);
-    size_after_second = ftell(rf);
+    size_after_second = log_file_size(rf);
     fclose(rf);
     ASSERT(size_after_second >= size_after_first, "Override size logic unexpected (should not shrink under initial due to new content)");
 #elif !PGS_LOG_APPEND && !PGS_LOG_OVERRIDE
@@ -196,7 +219,1598 @@ static int test_buffering_behavior() {
     }
     ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush after buffered writes failed");
     ASSERT(pgs_log_remove_fd_output(f) == PGS_LOG_OK, "Remove buffer file failed");
+#endif
+    return 0;
+}
+
+static inline long read_file(const char *path, char *out, size_t cap) {
+    FILE *rf = fopen(path, "rb");
+    if (!rf) return -1;
+    size_t n = fread(out, 1, cap - 1, rf);
+    out[n] = '\0';
+    fclose(rf);
+    return (long)n;
+}
+
+static int test_backlog() {
+#if PGS_LOG_ENABLE_BACKLOG && PGS_LOG_ENABLED
+    const char *path = "backlog_test.log";
+    FILE *f = fopen(path, "w+");
+    ASSERT(f != NULL, "Failed to open backlog test file");
+    ASSERT(pgs_log_add_fd_output(f) == PGS_LOG_OK, "Add backlog file output failed");
+
+    pgs_log_minimal_log_level = PGS_LOG_WARN;
+    pgs_log_backlog_clear();
+
+    char name[16] = "worker";
+    ASSERT(PGS_LOG_DEBUG("dropped %d", 0) == PGS_LOG_OK, "Backlog debug failed");
+    ASSERT(PGS_LOG_DEBUG("trail %d %s %.2f", 42, name, 1.5) == PGS_LOG_OK, "Backlog debug failed");
+    strcpy(name, "changed");
+    ASSERT(PGS_LOG_INFO("[%*d|%-4s|%lu|%zu|%c%%]", 5, 7, "ab", 123456789UL, (size_t)9, 'x') == PGS_LOG_OK, "Backlog info failed");
+    ASSERT(PGS_LOG_DEBUG("long %lld %x %Lf", -5LL, 255u, 2.5L) == PGS_LOG_OK, "Backlog debug failed");
+    ASSERT(PGS_LOG_DEBUG("last %s", "one") == PGS_LOG_OK, "Backlog debug failed");
+
+    char buf[8192];
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+    ASSERT(read_file(path, buf, sizeof(buf)) >= 0, "Read backlog file failed");
+    ASSERT(strstr(buf, "trail") == NULL, "Backlog written before trigger");
+
+    ASSERT(PGS_LOG_ERROR("boom") == PGS_LOG_OK, "Error entry failed");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+    ASSERT(read_file(path, buf, sizeof(buf)) > 0, "Read backlog file failed");
+
+    ASSERT(strstr(buf, "dropped 0") == NULL, "Oldest entry should have been overwritten");
+    char *trail = strstr(buf, "trail 42 worker 1.50");
+    char *info = strstr(buf, "[    7|ab  |123456789|9|x%]");
+    char *lng = strstr(buf, "long -5 ff 2.500000");
+    char *last = strstr(buf, "last one");
+    char *boom = strstr(buf, "boom");
+    ASSERT(trail && info && lng && last && boom, "Backlog entries missing");
+    ASSERT(trail < info && info < lng && lng < last && last < boom, "Backlog entries out of order");
+
+    ASSERT(PGS_LOG_ERROR("second boom") == PGS_LOG_OK, "Error entry failed");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+    ASSERT(read_file(path, buf, sizeof(buf)) > 0, "Read backlog file failed");
+    ASSERT(strstr(last + 1, "last one") == NULL, "Backlog replayed twice");
+
+#ifndef _WIN32
+    // strings with a precision need no NUL, this one ends right before an unmapped page
+    long page = sysconf(_SC_PAGESIZE);
+    char *pages = mmap(NULL, (size_t)page * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT(pages != MAP_FAILED && mprotect(pages + page, (size_t)page, PROT_NONE) == 0, "Failed to map guard page");
+    char *raw = pages + page - 4;
+    memcpy(raw, "abcd", 4);
+    ASSERT(PGS_LOG_DEBUG("raw [%.*s|%.2s|%.*s]", 4, raw, raw + 2, -1, "neg") == PGS_LOG_OK, "Backlog precision debug failed");
+    ASSERT(PGS_LOG_ERROR("third boom") == PGS_LOG_OK, "Error entry failed");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+    ASSERT(read_file(path, buf, sizeof(buf)) > 0, "Read backlog file failed");
+    ASSERT(strstr(buf, "raw [abcd|cd|neg]") != NULL, "Backlog string precision not applied");
+    munmap(pages, (size_t)page * 2);
+#endif
+
+    pgs_log_minimal_log_level = PGS_LOG_DEBUG;
+    ASSERT(pgs_log_remove_fd_output(f) == PGS_LOG_OK, "Remove backlog file failed");
+#endif
+    return 0;
+}
+
+static int test_flight_recorder() {
+#if PGS_LOG_ENABLE_FLIGHT_RECORDER && PGS_LOG_ENABLED
+    char buf[16384];
+    ASSERT(PGS_LOG_DEBUG("before init") == PGS_LOG_OK, "Log before recorder init failed");
+#ifdef _WIN32
+    ASSERT(pgs_log_flight_recorder_init(NULL) == PGS_LOG_OK, "Recorder init failed");
+#else
+    ASSERT(pgs_log_flight_recorder_init("flight_recorder.bin") == PGS_LOG_OK, "Recorder init failed");
+#endif
+
+    pgs_log_minimal_log_level = PGS_LOG_ERROR;
+    pgs_log_flight_recorder_level = PGS_LOG_DEBUG;
+    ASSERT(PGS_LOG_DEBUG("recorded %d", 1) == PGS_LOG_OK, "Recorder debug failed");
+    ASSERT(strcmp(pgs_log_get_last_error().message, "Below minimal Log Level") == 0, "Recorder entry should not reach outputs");
+
+    ASSERT(pgs_log_flight_recorder_dump("flight_dump.log") == PGS_LOG_OK, "Recorder dump failed");
+    ASSERT(read_file("flight_dump.log", buf, sizeof(buf)) > 0, "Read dump failed");
+    ASSERT(strstr(buf, "recorded 1") != NULL, "Recorded entry missing from dump");
+    ASSERT(strstr(buf, "before init") == NULL, "Entry before init should not be recorded");
+
+    for (int i = 0; i < 200; ++i) {
+        ASSERT(PGS_LOG_DEBUG("wrap line %d", i) == PGS_LOG_OK, "Recorder wrap debug failed");
+    }
+    ASSERT(pgs_log_flight_recorder_dump("flight_dump.log") == PGS_LOG_OK, "Recorder dump failed");
+    long n = read_file("flight_dump.log", buf, sizeof(buf));
+    ASSERT(n > 0 && n <= PGS_LOG_FLIGHT_RECORDER_SIZE, "Wrapped dump has wrong size");
+    ASSERT(strstr(buf, "recorded 1") == NULL, "Oldest entry should be overwritten");
+    ASSERT(strstr(buf, "\"wrap line 199\"") != NULL, "Newest entry missing");
+    ASSERT(buf[0] == '[', "Wrapped dump should start at an entry boundary");
+
+#ifndef _WIN32
+    char recovered[16384];
+    ASSERT(pgs_log_flight_recorder_read("flight_recorder.bin", "flight_recovered.log") == PGS_LOG_OK, "Read mmap recorder failed");
+    ASSERT(read_file("flight_recovered.log", recovered, sizeof(recovered)) == n, "Recovered size differs from dump");
+    ASSERT(strcmp(recovered, buf) == 0, "Recovered contents differ from dump");
+#endif
+
+    ASSERT(pgs_log_flight_recorder_install_signal(SIGUSR2) == PGS_LOG_OK, "Install signal failed");
+    remove("flight_signal.log");
+    raise(SIGUSR2);
+    ASSERT(read_file("flight_signal.log", buf, sizeof(buf)) > 0, "Signal dump missing");
+    ASSERT(strstr(buf, "\"wrap line 199\"") != NULL, "Signal dump incomplete");
+    signal(SIGUSR2, SIG_DFL);
+
+    pgs_log_minimal_log_level = PGS_LOG_DEBUG;
+#endif
+    return 0;
+}
+
+static int test_flight_recorder_mmap() {
+#if PGS_LOG_ENABLE_FLIGHT_RECORDER && PGS_LOG_ENABLED && !defined(_WIN32)
+    // wrapped recorder, oldest entry is cut and has to be skipped
+    unsigned char raw[sizeof(Pgs_Log_Flight_Recorder_Header) + 16];
+    Pgs_Log_Flight_Recorder_Header *h = (Pgs_Log_Flight_Recorder_Header *)raw;
+    memcpy(h->magic, PGS_LOG_FLIGHT_RECORDER_MAGIC, sizeof(h->magic));
+    h->size = 16;
+    h->written = 20;
+    memcpy(raw + sizeof(*h), "ne4\nine3\nxxxx\nli", 16);
+    FILE *f = fopen("flight_raw.bin", "wb");
+    ASSERT(f != NULL, "Open raw recorder failed");
+    fwrite(raw, 1, sizeof(raw), f);
+    fclose(f);
+
+    char buf[256];
+    ASSERT(pgs_log_flight_recorder_read("flight_raw.bin", "flight_raw.log") == PGS_LOG_OK, "Read recorder file failed");
+    ASSERT(read_file("flight_raw.log", buf, sizeof(buf)) >= 0, "Read recovered file failed");
+    ASSERT(strcmp(buf, "xxxx\nline4\n") == 0, "Recovered recorder contents wrong");
+    ASSERT(pgs_log_flight_recorder_read("flight_raw.log", "flight_raw2.log") != PGS_LOG_OK, "Reading garbage should fail");
+
+    // a crashed run leaves its ring behind, the restarted process appends to it instead of wiping it
+    const char *path = "flight_crash.bin";
+    char prev[64];
+    snprintf(prev, sizeof(prev), "%s.prev", path);
+    remove(path);
+    remove(prev);
+    for (int run = 0; run < 2; ++run) {
+        pid_t pid = fork();
+        ASSERT(pid >= 0, "Fork failed");
+        if (pid == 0) {
+            if (pgs_log_flight_recorder_init(path) != PGS_LOG_OK) _exit(1);
+            pgs_log_flight_recorder_write(run == 0 ? "before crash\n" : "after restart\n", run == 0 ? 13 : 14);
+            if (run == 0) abort();
+            _exit(0);
+        }
+        int status;
+        ASSERT(waitpid(pid, &status, 0) == pid, "Wait for recorder child failed");
+        ASSERT(run == 0 ? WIFSIGNALED(status) : WIFEXITED(status) && WEXITSTATUS(status) == 0, "Recorder child failed");
+    }
+    ASSERT(pgs_log_flight_recorder_read(path, "flight_raw.log") == PGS_LOG_OK, "Read crashed recorder failed");
+    ASSERT(read_file("flight_raw.log", buf, sizeof(buf)) >= 0, "Read recovered file failed");
+    ASSERT(strcmp(buf, "before crash\nafter restart\n") == 0, "Re-init wiped the crashed recorder");
+
+    // something that is no recorder of this size is moved aside, not overwritten
+    f = fopen(path, "wb");
+    ASSERT(f != NULL && fputs("not a recorder", f) >= 0, "Failed to write foreign file");
+    fclose(f);
+    pid_t pid = fork();
+    ASSERT(pid >= 0, "Fork failed");
+    if (pid == 0) _exit(pgs_log_flight_recorder_init(path) == PGS_LOG_OK ? 0 : 1);
+    int status;
+    ASSERT(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0, "Init over foreign file failed");
+    ASSERT(read_file(prev, buf, sizeof(buf)) > 0 && strcmp(buf, "not a recorder") == 0, "Foreign file not moved aside");
+    remove(path);
+    remove(prev);
+#endif
+    return 0;
+}
+
+#if PGS_LOG_USDT_ACTIVE
+static bool contains_bytes(const char *hay, size_t hay_len, const char *needle, size_t needle_len) {
+    for (size_t i = 0; i + needle_len <= hay_len; ++i) {
+        if (memcmp(hay + i, needle, needle_len) == 0) return true;
+    }
+    return false;
+}
+#endif
+
+static int test_usdt_probes() {
+#if PGS_LOG_USDT_ACTIVE
+    static char exe[4 * 1024 * 1024];
+    FILE *f = fopen("/proc/self/exe", "rb");
+    ASSERT(f != NULL, "Failed to open own binary");
+    size_t n = fread(exe, 1, sizeof(exe), f);
+    fclose(f);
+    ASSERT(n > 0 && n < sizeof(exe), "Failed to read own binary");
+
+    // provider and probe name are stored back to back in the note descriptor
+    ASSERT(contains_bytes(exe, n, "stapsdt", sizeof("stapsdt")), "No stapsdt note in binary");
+    ASSERT(contains_bytes(exe, n, "pgs_log\0callsite\0", sizeof("pgs_log\0callsite\0") - 1), "callsite probe note missing");
+    ASSERT(contains_bytes(exe, n, "pgs_log\0message\0", sizeof("pgs_log\0message\0") - 1), "message probe note missing");
+
+    // pretend a tracer is attached, filtered entries still have to be handled without reaching outputs
+    pgs_log_usdt_message_semaphore = 1;
+    pgs_log_minimal_log_level = PGS_LOG_ERROR;
+    ASSERT(PGS_LOG_DEBUG("traced %d", 1) == PGS_LOG_OK, "Traced debug failed");
+    ASSERT(strcmp(pgs_log_get_last_error().message, "Below minimal Log Level") == 0, "Traced entry should not reach outputs");
+    pgs_log_minimal_log_level = PGS_LOG_DEBUG;
+    pgs_log_usdt_message_semaphore = 0;
+#endif
+    return 0;
+}
+
+#ifdef PGS_LOG_TEST_MODULES
+static const char *module_log_result(Pgs_Log_Module module) {
+    pgs_log_module(module, PGS_LOG_DEBUG, __FILE__, sizeof(__FILE__) - 1, "0", 1, "module entry");
+    return pgs_log_get_last_error().message;
+}
+#endif
+
+static int test_module_levels() {
+#if defined(PGS_LOG_TEST_MODULES) && PGS_LOG_ENABLED
+    const char *written = "Log entry written";
+    pgs_log_minimal_log_level = PGS_LOG_WARN;
+
+    ASSERT(strcmp(pgs_log_module_name(PGS_LOG_MODULE_NET_TLS), "net.tls") == 0, "Module name mismatch");
+    ASSERT(pgs_log_set_module_level("nope", PGS_LOG_DEBUG) != PGS_LOG_OK, "Unknown module should fail");
+
+    ASSERT(pgs_log_set_module_level("net", PGS_LOG_DEBUG) == PGS_LOG_OK, "Set net level failed");
+    ASSERT(strcmp(module_log_result(PGS_LOG_MODULE_NET), written) == 0, "net debug filtered");
+    ASSERT(strcmp(module_log_result(PGS_LOG_MODULE_NET_TLS), written) == 0, "net.tls should inherit net");
+    ASSERT(strcmp(module_log_result(PGS_LOG_MODULE_DB), written) != 0, "db debug should be filtered");
+    ASSERT(strcmp(module_log_result(PGS_LOG_MODULE_ROOT), written) != 0, "root debug should be filtered");
+
+    ASSERT(pgs_log_set_module_level("net.tls", PGS_LOG_ERROR) == PGS_LOG_OK, "Set net.tls level failed");
+    ASSERT(strcmp(module_log_result(PGS_LOG_MODULE_NET_TLS), written) != 0, "net.tls override ignored");
+    ASSERT(strcmp(module_log_result(PGS_LOG_MODULE_NET), written) == 0, "child level leaked into parent");
+
+    ASSERT(pgs_log_reset_module_level("net.tls") == PGS_LOG_OK, "Reset net.tls failed");
+    ASSERT(pgs_log_get_module_level(PGS_LOG_MODULE_NET_TLS) == PGS_LOG_DEBUG, "net.tls should inherit after reset");
+    ASSERT(pgs_log_reset_module_level("net") == PGS_LOG_OK, "Reset net failed");
+    ASSERT(pgs_log_get_module_level(PGS_LOG_MODULE_NET_TLS) == PGS_LOG_WARN, "net.tls should follow global level");
+
+#undef PGS_LOG_MODULE
+#define PGS_LOG_MODULE PGS_LOG_MODULE_DB
+    ASSERT(pgs_log_set_module_level("db", PGS_LOG_DEBUG) == PGS_LOG_OK, "Set db level failed");
+    ASSERT(PGS_LOG_DEBUG("db macro entry") == PGS_LOG_OK, "db macro failed");
+    ASSERT(strcmp(pgs_log_get_last_error().message, written) == 0, "Macro did not use PGS_LOG_MODULE");
+    ASSERT(pgs_log_reset_module_level("db") == PGS_LOG_OK, "Reset db failed");
+#undef PGS_LOG_MODULE
+#define PGS_LOG_MODULE PGS_LOG_MODULE_ROOT
+
+    pgs_log_minimal_log_level = PGS_LOG_DEBUG;
+#endif
+    return 0;
+}
+
+static inline int count_occurrences(const char *hay, const char *needle) {
+    int n = 0;
+    for (const char *p = strstr(hay, needle); p; p = strstr(p + 1, needle)) n++;
+    return n;
+}
+
+static int test_ratelimit_and_sampling() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_BUFFERING
+    const char *path = "ratelimit_test.log";
+    FILE *f = fopen(path, "w+");
+    ASSERT(f != NULL, "Failed to open ratelimit test file");
+    ASSERT(pgs_log_add_fd_output(f) == PGS_LOG_OK, "Add ratelimit file output failed");
+
+    int evaluated = 0;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT(PGS_LOG_WARN_RATELIMITED(5, "storm %d", evaluated++) == PGS_LOG_OK, "Rate limited write failed");
+    }
+    ASSERT(evaluated >= 5 && evaluated <= 10, "Rate limited arguments evaluated for suppressed calls");
+
+    evaluated = 0;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT(PGS_LOG_INFO_SAMPLED(10, "sampled %d", evaluated++) == PGS_LOG_OK, "Sampled write failed");
+    }
+    ASSERT(evaluated == 10, "Sampling let the wrong amount through");
+
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+    char buf[16384];
+    ASSERT(read_file(path, buf, sizeof(buf)) > 0, "Read ratelimit file failed");
+    int storms = count_occurrences(buf, "\"storm ");
+    ASSERT(storms >= 5 && storms <= 10, "Wrong number of rate limited entries");
+    ASSERT(count_occurrences(buf, "\"sampled ") == 10, "Wrong number of sampled entries");
+    ASSERT(strstr(buf, "suppressed ") != NULL && strstr(buf, " messages from pgs_log_test.c:") != NULL, "Suppression summary missing");
+
+    // a callsite that storms and goes quiet gets its summary from pgs_log_flush_if_due() once its window is over
+    struct timespec tick = { .tv_sec = 0, .tv_nsec = 10 * 1000000L };
+    time_t second = time(NULL);
+    while (time(NULL) == second) nanosleep(&tick, NULL);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT(PGS_LOG_WARN_RATELIMITED(3, "quiet storm") == PGS_LOG_OK, "Rate limited write failed");
+    }
+    second = time(NULL);
+    while (time(NULL) == second) nanosleep(&tick, NULL);
+    ASSERT(pgs_log_flush_if_due() == PGS_LOG_OK, "Flush if due failed");
+    ASSERT(PGS_LOG_WARN("after quiet storm") == PGS_LOG_OK, "Write after storm failed");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+    ASSERT(read_file(path, buf, sizeof(buf)) > 0, "Read ratelimit file failed");
+    const char *quiet = strstr(buf, "\"quiet storm\"");
+    ASSERT(quiet != NULL && count_occurrences(quiet, "\"quiet storm\"") <= 6, "Wrong number of quiet storm entries");
+    const char *summary = strstr(quiet, "suppressed ");
+    const char *after = strstr(quiet, "after quiet storm");
+    ASSERT(summary != NULL && after != NULL && summary < after, "Summary of a quiet callsite not written before the next flush");
+
+    ASSERT(pgs_log_remove_fd_output(f) == PGS_LOG_OK, "Remove ratelimit file failed");
+#endif
+    return 0;
+}
+
+static int test_many_buffers_in_order() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_BUFFERING
+    const char *path = "order_test.log";
+    FILE *f = fopen(path, "w+");
+    ASSERT(f != NULL, "Failed to open order test file");
+    ASSERT(pgs_log_add_fd_output(f) == PGS_LOG_OK, "Add order file output failed");
+
+    // enough to cycle through the output buffers a couple of times
+    int lines = (int)(PGS_LOG_MAX_OUTPUT_BUFFER_SIZE * PGS_LOG_OUTPUT_BUFFERS * 3 / 40) + 10;
+    for (int i = 0; i < lines; ++i) {
+        ASSERT(PGS_LOG_INFO("order %d", i) == PGS_LOG_OK, "Order write failed");
+    }
+    ASSERT(pgs_log_remove_fd_output(f) == PGS_LOG_OK, "Remove order file failed");
+
+    static char buf[4 * 1024 * 1024];
+    ASSERT(read_file(path, buf, sizeof(buf)) > 0, "Read order file failed");
+    const char *p = buf;
+    for (int i = 0; i < lines; ++i) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "\"order %d\"", i);
+        p = strstr(p, expected);
+        ASSERT(p != NULL, "Entry missing or out of order");
+    }
+#if PGS_LOG_ENABLE_IO_URING
+    printf("io_uring %s\n", pgs_log_io_uring_active() ? "active" : "not available, used write() fallback");
+#endif
+#if PGS_LOG_ENABLE_FLUSH_THREAD
+    ASSERT(pgs_log_flush_thread_active(), "Flush thread did not start");
+#endif
+#endif
+    return 0;
+}
+
+static int test_mmap_output() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_MMAP_OUTPUT
+    const char *path = "mmap_test.log";
+    ASSERT(pgs_log_add_mmap_output(path, false) == PGS_LOG_OK, "Add mmap output failed");
+
+    // enough to move the mapped window a couple of times
+    int lines = (int)(PGS_LOG_MMAP_WINDOW_SIZE * 3 / 40) + 10;
+    for (int i = 0; i < lines; ++i) {
+        ASSERT(PGS_LOG_INFO("mmap %d", i) == PGS_LOG_OK, "Mmap write failed");
+    }
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush mmap output failed");
+
+    // a flush keeps the preallocated tail, the file only grows in whole steps
+    static char buf[4 * 1024 * 1024];
+    long allocated = read_file(path, buf, sizeof(buf));
+    ASSERT(allocated > 0 && allocated % (2 * PGS_LOG_MMAP_WINDOW_SIZE) == 0, "Mmap file did not grow in whole steps");
+    ASSERT(buf[allocated - 1] == '\0', "Flush cut the preallocated tail of the mmap file");
+    long len = (long)strlen(buf);
+    ASSERT(len > 0, "Read mmap file failed");
+    const char *p = buf;
+    for (int i = 0; i < lines; ++i) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "\"mmap %d\"", i);
+        p = strstr(p, expected);
+        ASSERT(p != NULL, "Mmap entry missing or out of order");
+    }
+
+    // appending continues at the end of the file, even in the middle of a window
+    ASSERT(PGS_LOG_INFO("before reopen") == PGS_LOG_OK, "Mmap write failed");
+    ASSERT(pgs_log_remove_mmap_output(path) == PGS_LOG_OK, "Remove mmap output failed");
+    ASSERT(pgs_log_add_mmap_output(path, true) == PGS_LOG_OK, "Re-add mmap output failed");
+    ASSERT(PGS_LOG_INFO("after reopen") == PGS_LOG_OK, "Mmap write failed");
+    ASSERT(pgs_log_remove_mmap_output(path) == PGS_LOG_OK, "Remove mmap output failed");
+    ASSERT(pgs_log_remove_mmap_output(path) != PGS_LOG_OK, "Removing twice should error");
+
+    long len2 = read_file(path, buf, sizeof(buf));
+    ASSERT(len2 > len, "Append did not grow mmap file");
+    ASSERT(memchr(buf, '\0', (size_t)len2) == NULL, "Hole in appended mmap file or tail left after remove");
+    p = strstr(buf, "\"before reopen\"");
+    ASSERT(p != NULL && strstr(p, "\"after reopen\"") != NULL, "Appended entries missing");
+
+    // a file that was never closed keeps its zero filled tail, appending continues in front of it
+    FILE *f = fopen(path, "ab");
+    ASSERT(f, "Open mmap file failed");
+    static const char zeros[10000];
+    ASSERT(fwrite(zeros, 1, sizeof(zeros), f) == sizeof(zeros), "Write zero tail failed");
     fclose(f);
+    ASSERT(pgs_log_add_mmap_output(path, true) == PGS_LOG_OK, "Re-add mmap output failed");
+    ASSERT(PGS_LOG_INFO("after crash") == PGS_LOG_OK, "Mmap write failed");
+    ASSERT(pgs_log_remove_mmap_output(path) == PGS_LOG_OK, "Remove mmap output failed");
+    long len3 = read_file(path, buf, sizeof(buf));
+    ASSERT(len3 > len2 && memchr(buf, '\0', (size_t)len3) == NULL, "Zero filled tail kept when appending");
+    ASSERT(strstr(buf, "\"after crash\"") != NULL, "Entry after crash missing");
+    remove(path);
+#endif
+    return 0;
+}
+
+static int test_direct_output() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_DIRECT_OUTPUT
+    const char *path = "direct_test.log";
+    ASSERT(pgs_log_add_direct_output(path, false) == PGS_LOG_OK, "Add direct output failed");
+    printf("direct output %s\n", pgs_log_direct_output_is_direct(path) ? "uses O_DIRECT" : "fell back to posix_fadvise");
+
+    // a couple of full blocks and a partial one
+    int lines = (int)(PGS_LOG_DIRECT_BUFFER_SIZE * 3 / 40) + 7;
+    for (int i = 0; i < lines; ++i) {
+        ASSERT(PGS_LOG_INFO("direct %d", i) == PGS_LOG_OK, "Direct write failed");
+    }
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush direct output failed");
+
+    static char buf[4 * 1024 * 1024];
+    long len = read_file(path, buf, sizeof(buf));
+    ASSERT(len > 0, "Read direct file failed");
+    // the partial block is padded until the output goes away, nothing is truncated per flush
+    ASSERT(len % PGS_LOG_DIRECT_ALIGNMENT == 0, "Direct file cut to its length on flush");
+    char *padding = memchr(buf, '\0', (size_t)len);
+    ASSERT(padding != NULL, "Partial direct block not padded");
+    for (char *c = padding; c < buf + len; ++c)
+        ASSERT(*c == '\0', "Entries after the padding of the direct file");
+    len = (long)(padding - buf);
+    const char *p = buf;
+    for (int i = 0; i < lines; ++i) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "\"direct %d\"", i);
+        p = strstr(p, expected);
+        ASSERT(p != NULL, "Direct entry missing or out of order");
+    }
+
+    // the partial block written on flush gets completed, reopening appends behind an unaligned end
+    ASSERT(PGS_LOG_INFO("before reopen") == PGS_LOG_OK, "Direct write failed");
+    ASSERT(pgs_log_remove_direct_output(path) == PGS_LOG_OK, "Remove direct output failed");
+    ASSERT(pgs_log_add_direct_output(path, true) == PGS_LOG_OK, "Re-add direct output failed");
+    ASSERT(PGS_LOG_INFO("after reopen") == PGS_LOG_OK, "Direct write failed");
+    ASSERT(pgs_log_remove_direct_output(path) == PGS_LOG_OK, "Remove direct output failed");
+    ASSERT(pgs_log_remove_direct_output(path) != PGS_LOG_OK, "Removing twice should error");
+
+    long len2 = read_file(path, buf, sizeof(buf));
+    ASSERT(len2 > len, "Append did not grow direct file");
+    ASSERT(memchr(buf, '\0', (size_t)len2) == NULL, "Hole in appended direct file");
+    ASSERT(strstr(buf, "\"direct 0\"") != NULL, "Append lost the start of the file");
+    p = strstr(buf, "\"before reopen\"");
+    ASSERT(p != NULL && strstr(p, "\"after reopen\"") != NULL, "Appended entries missing");
+    remove(path);
+#endif
+    return 0;
+}
+
+static int test_flush_policy() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_BUFFERING
+    const char *path = "flush_policy_test.log";
+    FILE *f = fopen(path, "w+");
+    ASSERT(f != NULL, "Failed to open flush policy test file");
+    ASSERT(pgs_log_add_fd_output(f) == PGS_LOG_OK, "Add flush policy output failed");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+
+    static char buf[8192];
+    pgs_log_flush_level = PGS_LOG_ERROR;
+    ASSERT(PGS_LOG_WARN("policy buffered") == PGS_LOG_OK, "Warn failed");
+    ASSERT(read_file(path, buf, sizeof(buf)) == 0, "Entry below flush level was not buffered");
+    ASSERT(PGS_LOG_ERROR("policy error") == PGS_LOG_OK, "Error failed");
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    // the error only woke the loop
+    ASSERT(pgs_log_service(0) == PGS_LOG_OK, "Service failed");
+#endif
+    ASSERT(read_file(path, buf, sizeof(buf)) > 0, "Read flush policy file failed");
+    ASSERT(strstr(buf, "\"policy buffered\"") && strstr(buf, "\"policy error\""), "Error did not flush the buffer");
+    pgs_log_flush_level = PGS_LOG_FLUSH_LEVEL;
+
+#if PGS_LOG_MAX_BUFFER_AGE_MS > 0
+    ASSERT(PGS_LOG_INFO("policy aged") == PGS_LOG_OK, "Info failed");
+    ASSERT(pgs_log_flush_if_due() == PGS_LOG_OK, "Flush if due failed");
+    read_file(path, buf, sizeof(buf));
+    ASSERT(strstr(buf, "\"policy aged\"") == NULL, "Young entry was flushed");
+
+    struct timespec ts = { 0, (PGS_LOG_MAX_BUFFER_AGE_MS + 20) * 1000000L };
+    nanosleep(&ts, NULL);
+    ASSERT(pgs_log_flush_if_due() == PGS_LOG_OK, "Flush if due failed");
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    ASSERT(pgs_log_service(0) == PGS_LOG_OK, "Service failed");
+#endif
+    read_file(path, buf, sizeof(buf));
+    ASSERT(strstr(buf, "\"policy aged\"") != NULL, "Old entry was not flushed by timer");
+
+    // checked on the logging path too
+    ASSERT(PGS_LOG_INFO("policy first") == PGS_LOG_OK, "Info failed");
+    nanosleep(&ts, NULL);
+    ASSERT(PGS_LOG_INFO("policy second") == PGS_LOG_OK, "Info failed");
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    ASSERT(pgs_log_service(0) == PGS_LOG_OK, "Service failed");
+#endif
+    read_file(path, buf, sizeof(buf));
+    ASSERT(strstr(buf, "\"policy second\"") != NULL, "Old entry was not flushed on log call");
+#endif
+
+    ASSERT(pgs_log_sync() == PGS_LOG_OK, "Sync failed");
+    ASSERT(pgs_log_remove_fd_output(f) == PGS_LOG_OK, "Remove flush policy file failed");
+    remove(path);
+#endif
+    return 0;
+}
+
+#if PGS_LOG_ENABLED && !defined(_WIN32)
+#include <pthread.h>
+
+static void *wait_durable_thread(void *arg) {
+    return (void *)(uintptr_t)(pgs_log_wait_durable(*(uint64_t *)arg) == PGS_LOG_OK);
+}
+#endif
+
+static int test_durability() {
+#if PGS_LOG_ENABLED && !defined(_WIN32)
+    const char *path = "durability_test.log";
+    FILE *f = fopen(path, "w+");
+    ASSERT(f != NULL, "Failed to open durability test file");
+    ASSERT(pgs_log_add_fd_output(f) == PGS_LOG_OK, "Add durability output failed");
+
+    ASSERT(PGS_LOG_INFO("durable entry") == PGS_LOG_OK, "Info failed");
+    uint64_t seq = pgs_log_last_sequence();
+    ASSERT(seq > 0, "Entry got no sequence number");
+    ASSERT(pgs_log_durable_sequence() < seq, "Entry durable before flush");
+    ASSERT(pgs_log_wait_durable(seq) != PGS_LOG_OK, "Waiting for an unflushed entry should error");
+
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+    if (pgs_log_durability == PGS_LOG_DURABILITY_GROUP_COMMIT) {
+        ASSERT(pgs_log_durable_sequence() >= seq, "Group commit flush did not make the entry durable");
+    } else {
+        // a few callers waiting at once all get covered
+        pthread_t threads[4];
+        for (int i = 0; i < 4; ++i)
+            ASSERT(pthread_create(&threads[i], NULL, wait_durable_thread, &seq) == 0, "Failed to start waiter");
+        for (int i = 0; i < 4; ++i) {
+            void *ok = NULL;
+            pthread_join(threads[i], &ok);
+            ASSERT(ok, "Waiter failed");
+        }
+        ASSERT(pgs_log_durable_sequence() >= seq, "Waiters did not make the entry durable");
+    }
+
+    if (pgs_log_durability == PGS_LOG_DURABILITY_PERIODIC) {
+        ASSERT(PGS_LOG_INFO("periodic entry") == PGS_LOG_OK, "Info failed");
+        seq = pgs_log_last_sequence();
+        struct timespec ts = { 0, (PGS_LOG_DURABILITY_INTERVAL_MS + 20) * 1000000L };
+        nanosleep(&ts, NULL);
+        ASSERT(PGS_LOG_INFO("periodic trigger") == PGS_LOG_OK, "Info failed");
+        ASSERT(pgs_log_durable_sequence() >= seq, "Interval passed without a sync");
+    }
+
+    ASSERT(pgs_log_remove_fd_output(f) == PGS_LOG_OK, "Remove durability file failed");
+    remove(path);
+#endif
+    return 0;
+}
+
+static int test_rotation() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_FILE && PGS_LOG_ROTATE_SIZE > 0
+    time_t t = time(NULL);
+    char name[PGS_LOG_MAX_PATH_LEN];
+    char filename[PGS_LOG_MAX_PATH_LEN];
+    strftime(name, sizeof(name), PGS_LOG_PATH, localtime(&t));
+
+    pgs_log_cleanup();
+    for (int n = 0; n < PGS_LOG_MAX_FILENAME_NUMBER; ++n) {
+        pgs_log_numbered_filename(filename, name, n);
+        remove(filename);
+    }
+
+    // the first standby is opened with the log file, the log call crossing the limit only swaps
+    ASSERT(PGS_LOG_INFO("rotation start") == PGS_LOG_OK, "Rotation write failed");
+    ASSERT(pgs_log_standby_file != NULL, "No standby file before the first flush");
+
+    // about 8 files worth of entries
+    int lines = PGS_LOG_ROTATE_SIZE * 8 / 60;
+    for (int i = 0; i < lines; ++i) {
+        ASSERT(PGS_LOG_INFO("rotation %d", i) == PGS_LOG_OK, "Rotation write failed");
+    }
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush after rotation failed");
+
+    static char buf[PGS_LOG_ROTATE_SIZE * 2];
+    char last[32];
+    snprintf(last, sizeof(last), "\"rotation %d\"", lines - 1);
+    int files = 0, empty = 0, newest = -1;
+    for (int n = 0; n < PGS_LOG_MAX_FILENAME_NUMBER; ++n) {
+        pgs_log_numbered_filename(filename, name, n);
+        long len = read_file(filename, buf, sizeof(buf));
+        if (len < 0) continue;
+        files++;
+        ASSERT(len <= PGS_LOG_ROTATE_SIZE, "Rotated file exceeds the size limit");
+        if (len == 0) empty++;
+        else newest = n;
+    }
+    ASSERT(newest >= 7, "Log file did not rotate");
+    ASSERT(empty == 1, "Expected exactly one prepared standby file");
+#if PGS_LOG_ROTATE_KEEP > 0
+    ASSERT(files == PGS_LOG_ROTATE_KEEP + 1, "Retention did not delete old files");
+#endif
+
+    pgs_log_numbered_filename(filename, name, newest);
+    read_file(filename, buf, sizeof(buf));
+    ASSERT(strstr(buf, last) != NULL, "Newest entry not in the newest file");
+
+    // more rotations than there are numbers, they wrap around instead of running out
+    lines = PGS_LOG_ROTATE_SIZE * (PGS_LOG_MAX_FILENAME_NUMBER + 20) / 60;
+    for (int i = 0; i < lines; ++i) {
+        ASSERT(PGS_LOG_INFO("wrapped %d", i) == PGS_LOG_OK, "Rotation write past the number cap failed");
+        if (i % 100 == 0) ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush past the number cap failed");
+    }
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush after wrapping failed");
+
+    snprintf(last, sizeof(last), "\"wrapped %d\"", lines - 1);
+    bool found = false;
+    files = 0;
+    for (int n = 0; n < PGS_LOG_MAX_FILENAME_NUMBER; ++n) {
+        pgs_log_numbered_filename(filename, name, n);
+        long len = read_file(filename, buf, sizeof(buf));
+        if (len < 0) continue;
+        files++;
+        ASSERT(len <= PGS_LOG_ROTATE_SIZE, "Wrapped file exceeds the size limit");
+        found = found || strstr(buf, last) != NULL;
+    }
+    ASSERT(found, "Newest entry missing after wrapping");
+#if PGS_LOG_ROTATE_KEEP > 0
+    ASSERT(files == PGS_LOG_ROTATE_KEEP + 1, "Retention did not delete old files after wrapping");
+#else
+    ASSERT(files == PGS_LOG_MAX_FILENAME_NUMBER, "Keeping all files did not use every number");
+#endif
+
+#if PGS_LOG_ENABLE_OUTPUT_FORMATS
+    // the size limit counts what the log file gets, skipped levels and its own format included
+    ASSERT(pgs_log_set_output_level(fileno(pgs_log_file), PGS_LOG_WARN) == PGS_LOG_OK, "Set log file level failed");
+    ASSERT(pgs_log_set_output_format(fileno(pgs_log_file), "%M") == PGS_LOG_OK, "Set log file format failed");
+    int number = pgs_log_file_number;
+    for (int i = 0; i < lines; ++i) {
+        ASSERT(PGS_LOG_INFO("skipped %d", i) == PGS_LOG_OK, "Skipped write failed");
+    }
+    ASSERT(pgs_log_file_number == number, "Entries the log file skips made it rotate");
+
+    // fill the current file until the next one starts, that one then takes a whole limit of short entries
+    while (pgs_log_file_number == number) {
+        ASSERT(PGS_LOG_WARN("w%04d", 0) == PGS_LOG_OK, "Short write failed");
+    }
+    number = pgs_log_file_number;
+    for (int i = 1; i < PGS_LOG_ROTATE_SIZE / 6; ++i) {
+        ASSERT(PGS_LOG_WARN("w%04d", i) == PGS_LOG_OK, "Short write failed");
+    }
+    ASSERT(pgs_log_file_number == number, "Log file rotated before its own entries reached the limit");
+    ASSERT(pgs_log_set_output_level(fileno(pgs_log_file), PGS_LOG_DEBUG) == PGS_LOG_OK, "Reset log file level failed");
+    ASSERT(pgs_log_set_output_format(fileno(pgs_log_file), NULL) == PGS_LOG_OK, "Reset log file format failed");
+#endif
+
+    pgs_log_cleanup();
+#if PGS_LOG_ROTATE_KEEP > 0
+    files = 0;
+    for (int n = 0; n < PGS_LOG_MAX_FILENAME_NUMBER; ++n) {
+        pgs_log_numbered_filename(filename, name, n);
+        if (pgs_log_file_exists(filename)) files++;
+    }
+    ASSERT(files == PGS_LOG_ROTATE_KEEP, "Cleanup left the standby file behind");
+#endif
+#endif
+    return 0;
+}
+
+static int test_date_rollover() {
+#if PGS_LOG_ENABLED && PGS_LOG_DATE_ROLLOVER && defined(PGS_LOG_TEST_ROLLOVER)
+    char first[PGS_LOG_MAX_PATH_LEN];
+    char second[PGS_LOG_MAX_PATH_LEN];
+
+    ASSERT(PGS_LOG_INFO("before rollover") == PGS_LOG_OK, "Log before rollover failed");
+    time_t t = time(NULL);
+    strftime(first, sizeof(first), PGS_LOG_PATH, localtime(&t));
+
+    // the test path changes every second
+    while (time(NULL) == t) {
+        struct timespec ts = { 0, 10 * 1000000L };
+        nanosleep(&ts, NULL);
+    }
+    ASSERT(PGS_LOG_INFO("after rollover") == PGS_LOG_OK, "Log after rollover failed");
+    t = time(NULL);
+    strftime(second, sizeof(second), PGS_LOG_PATH, localtime(&t));
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush after rollover failed");
+    ASSERT(strcmp(first, second) != 0, "Test path did not change");
+
+    static char buf[4 * 1024 * 1024];
+    ASSERT(read_file(first, buf, sizeof(buf)) > 0, "First file missing");
+    ASSERT(strstr(buf, "\"before rollover\"") && !strstr(buf, "\"after rollover\""), "Entries in the wrong file before rollover");
+    ASSERT(read_file(second, buf, sizeof(buf)) > 0, "Rollover file missing");
+    ASSERT(strstr(buf, "\"after rollover\"") && !strstr(buf, "\"before rollover\""), "Entries in the wrong file after rollover");
+
+    pgs_log_cleanup();
+    remove(first);
+    remove(second);
+#endif
+    return 0;
+}
+
+static int test_reopen() {
+#if PGS_LOG_ENABLED && PGS_LOG_SWITCHES_LOG_FILE && (PGS_LOG_APPEND || PGS_LOG_OVERRIDE) && !PGS_LOG_ENABLE_ROTATION && !defined(PGS_LOG_TEST_ROLLOVER)
+    char path[PGS_LOG_MAX_PATH_LEN];
+    char rotated[PGS_LOG_MAX_PATH_LEN + 8];
+    time_t t = time(NULL);
+    strftime(path, sizeof(path), PGS_LOG_PATH, localtime(&t));
+    snprintf(rotated, sizeof(rotated), "%s.1", path);
+
+    ASSERT(PGS_LOG_INFO("reopen before rename") == PGS_LOG_OK, "Log before rename failed");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+    ASSERT(PGS_LOG_INFO("reopen still buffered") == PGS_LOG_OK, "Buffered log failed");
+
+    // what logrotate does, then signals the process
+    ASSERT(rename(path, rotated) == 0, "Failed to rename log file");
+    ASSERT(pgs_log_install_reopen_signal(SIGHUP) == PGS_LOG_OK, "Installing reopen signal failed");
+    raise(SIGHUP);
+    ASSERT(PGS_LOG_INFO("reopen after signal") == PGS_LOG_OK, "Log after signal failed");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush after reopen failed");
+    signal(SIGHUP, SIG_DFL);
+
+    static char buf[4 * 1024 * 1024];
+    ASSERT(read_file(rotated, buf, sizeof(buf)) > 0, "Rotated file missing");
+    // the appended file may still hold entries of an earlier aborted run, only look behind this run's marker
+    const char *run = NULL;
+    for (const char *p = buf; (p = strstr(p, "\"reopen before rename\"")) != NULL; ++p) run = p;
+    ASSERT(run && strstr(run, "\"reopen still buffered\""), "Buffered entries did not reach the old file");
+    ASSERT(!strstr(run, "\"reopen after signal\""), "Entry after reopen went to the old file");
+    ASSERT(read_file(path, buf, sizeof(buf)) > 0, "Reopened file missing");
+    ASSERT(strstr(buf, "\"reopen after signal\"") && !strstr(buf, "\"reopen still buffered\""), "Reopened file has the wrong entries");
+    remove(rotated);
+
+    ASSERT(pgs_log_reopen() == PGS_LOG_OK, "Explicit reopen failed");
+    ASSERT(PGS_LOG_INFO("reopen explicit") == PGS_LOG_OK, "Log after explicit reopen failed");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush after explicit reopen failed");
+    ASSERT(read_file(path, buf, sizeof(buf)) > 0, "Reopened file missing");
+    ASSERT(strstr(buf, "\"reopen after signal\"") && strstr(buf, "\"reopen explicit\""), "Explicit reopen lost entries");
+#endif
+    return 0;
+}
+
+static int test_segments() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_SEGMENTS
+    const char *path = "segment_test.log";
+    char filename[64];
+    for (int i = 0; i < PGS_LOG_SEGMENT_COUNT; ++i) {
+        snprintf(filename, sizeof(filename), "%s.%d", path, i);
+        remove(filename);
+    }
+    ASSERT(pgs_log_add_segment_output(path) == PGS_LOG_OK, "Add segment output failed");
+
+    // about twice the whole budget, the oldest segments get reused
+    int lines = (int)(PGS_LOG_SEGMENT_COUNT * PGS_LOG_SEGMENT_SIZE / 40);
+    for (int i = 0; i < lines; ++i) {
+        ASSERT(PGS_LOG_INFO("segment %d", i) == PGS_LOG_OK, "Segment write failed");
+    }
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush segment output failed");
+
+    static char buf[4 * 1024 * 1024];
+    for (int i = 0; i < PGS_LOG_SEGMENT_COUNT; ++i) {
+        snprintf(filename, sizeof(filename), "%s.%d", path, i);
+        ASSERT(read_file(filename, buf, sizeof(buf)) == PGS_LOG_SEGMENT_SIZE, "Segment size changed");
+        ASSERT(strncmp(buf, "PGSSEG v1 gen ", 14) == 0, "Segment header missing");
+    }
+    snprintf(filename, sizeof(filename), "%s.%d", path, PGS_LOG_SEGMENT_COUNT);
+    ASSERT(read_file(filename, buf, sizeof(buf)) < 0, "Segment created beyond the count");
+
+    const char *dump = "segment_dump.log";
+    ASSERT(pgs_log_segments_dump(path, dump) == PGS_LOG_OK, "Segment dump failed");
+    long len = read_file(dump, buf, sizeof(buf));
+    ASSERT(len > 0 && len < PGS_LOG_SEGMENT_COUNT * PGS_LOG_SEGMENT_SIZE, "Segment dump size wrong");
+    ASSERT(memchr(buf, '\0', (size_t)len) == NULL, "Unwritten segment space in dump");
+    ASSERT(strstr(buf, "\"segment 0\"") == NULL, "Oldest entries were not overwritten");
+    int first;
+    const char *p = strstr(buf, "\"segment ");
+    ASSERT(p != NULL && sscanf(p, "\"segment %d\"", &first) == 1, "Dump holds no entries");
+    for (int i = first; i < lines; ++i) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "\"segment %d\"", i);
+        p = strstr(p, expected);
+        ASSERT(p != NULL, "Segment entry missing or out of order");
+    }
+
+    // a restart continues behind the newest segment instead of overwriting it
+    ASSERT(pgs_log_remove_segment_output(path) == PGS_LOG_OK, "Remove segment output failed");
+    ASSERT(pgs_log_remove_segment_output(path) != PGS_LOG_OK, "Removing twice should error");
+    ASSERT(pgs_log_add_segment_output(path) == PGS_LOG_OK, "Re-add segment output failed");
+    ASSERT(PGS_LOG_INFO("after restart") == PGS_LOG_OK, "Segment write failed");
+    ASSERT(pgs_log_remove_segment_output(path) == PGS_LOG_OK, "Remove segment output failed");
+
+    ASSERT(pgs_log_segments_dump(path, dump) == PGS_LOG_OK, "Segment dump failed");
+    len = read_file(dump, buf, sizeof(buf));
+    snprintf(filename, sizeof(filename), "\"segment %d\"", lines - 1);
+    p = strstr(buf, filename);
+    ASSERT(p != NULL && strstr(p, "\"after restart\"") != NULL, "Restart lost or reordered entries");
+
+    remove(dump);
+    for (int i = 0; i < PGS_LOG_SEGMENT_COUNT; ++i) {
+        snprintf(filename, sizeof(filename), "%s.%d", path, i);
+        remove(filename);
+    }
+#endif
+    return 0;
+}
+
+#if PGS_LOG_ENABLED
+typedef struct {
+    int calls;
+    size_t bytes;
+} Batch_Counter;
+
+static Pgs_Log_Error count_batch(void *ctx, const char *data, size_t len) {
+    (void)data;
+    Batch_Counter *c = (Batch_Counter *)ctx;
+    c->calls++;
+    c->bytes += len;
+    return PGS_LOG_OK;
+}
+#endif
+
+static int test_sinks() {
+#if PGS_LOG_ENABLED
+    static char memory_buffer[4096];
+    Pgs_Log_Memory_Sink memory;
+    pgs_log_memory_sink_init(&memory, memory_buffer, sizeof(memory_buffer));
+    ASSERT(pgs_log_add_memory_output(&memory) == PGS_LOG_OK, "Add memory output failed");
+    Batch_Counter counter = { 0 };
+    ASSERT(pgs_log_add_callback_output(count_batch, &counter) == PGS_LOG_OK, "Add callback output failed");
+
+    for (int i = 0; i < 10; ++i) {
+        ASSERT(PGS_LOG_INFO("sink %d", i) == PGS_LOG_OK, "Sink write failed");
+    }
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush sinks failed");
+
+    const char *p = memory.data;
+    for (int i = 0; i < 10; ++i) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "\"sink %d\"", i);
+        p = strstr(p, expected);
+        ASSERT(p != NULL, "Memory sink entry missing or out of order");
+    }
+    ASSERT(counter.bytes == memory.len, "Callback and memory sink got different bytes");
+#if PGS_LOG_ENABLE_BUFFERING
+    ASSERT(counter.calls == 1, "Buffered entries did not reach the callback as one batch");
+#else
+    ASSERT(counter.calls == 10, "Unbuffered entries should reach the callback one by one");
+#endif
+
+    // entries that do not fit get dropped whole
+    while (memory.dropped == 0) {
+        ASSERT(PGS_LOG_INFO("filling the memory sink") == PGS_LOG_OK, "Sink write failed");
+        ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush sinks failed");
+    }
+    ASSERT(memory.len < memory.cap && memory.data[memory.len] == '\0', "Memory sink overran its buffer");
+    ASSERT(memory.data[memory.len - 1] == '\n', "Memory sink kept a partial entry");
+    ASSERT(pgs_log_remove_sink_output(&memory) == PGS_LOG_OK, "Remove memory output failed");
+
+    // a batch that only fits in part keeps its leading entries, room for two and a half of them
+    size_t entry_len = (size_t)(strchr(memory_buffer, '\n') - memory_buffer) + 1;
+    static char small_buffer[1024];
+    Pgs_Log_Memory_Sink small;
+    pgs_log_memory_sink_init(&small, small_buffer, 2 * entry_len + entry_len / 2);
+    ASSERT(small.cap <= sizeof(small_buffer), "Memory sink test entry too long");
+    ASSERT(pgs_log_add_memory_output(&small) == PGS_LOG_OK, "Add memory output failed");
+    size_t sent = counter.bytes;
+    for (int i = 0; i < 3; ++i) {
+        ASSERT(PGS_LOG_INFO("sink %d", i) == PGS_LOG_OK, "Sink write failed");
+    }
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush sinks failed");
+    sent = counter.bytes - sent;
+    ASSERT(small.dropped > 0 && small.dropped < sent / 2, "Memory sink dropped more than the entry that did not fit");
+    ASSERT(small.len + small.dropped == sent, "Memory sink lost track of dropped bytes");
+    ASSERT(small.data[small.len - 1] == '\n', "Memory sink kept a partial entry");
+    ASSERT(strstr(small.data, "\"sink 1\"") != NULL, "Memory sink lost an entry that fit");
+    ASSERT(pgs_log_remove_sink_output(&small) == PGS_LOG_OK, "Remove memory output failed");
+
+    ASSERT(pgs_log_remove_sink_output(&counter) == PGS_LOG_OK, "Remove callback output failed");
+    ASSERT(pgs_log_remove_sink_output(&counter) != PGS_LOG_OK, "Removing twice should error");
+
+#ifndef _WIN32
+    // raw fds are only closed when the output owns them
+    const char *path = "raw_fd_test.log";
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT(fd >= 0, "Failed to open raw fd test file");
+    ASSERT(pgs_log_add_raw_fd_output(fd, false) == PGS_LOG_OK, "Add raw fd output failed");
+    ASSERT(PGS_LOG_INFO("borrowed fd") == PGS_LOG_OK, "Raw fd write failed");
+    ASSERT(pgs_log_remove_raw_fd_output(fd) == PGS_LOG_OK, "Remove raw fd output failed");
+    ASSERT(fcntl(fd, F_GETFD) != -1, "Borrowed fd was closed");
+
+    ASSERT(pgs_log_add_raw_fd_output(fd, true) == PGS_LOG_OK, "Add owned raw fd output failed");
+    ASSERT(PGS_LOG_INFO("owned fd") == PGS_LOG_OK, "Raw fd write failed");
+    ASSERT(pgs_log_remove_raw_fd_output(fd) == PGS_LOG_OK, "Remove raw fd output failed");
+    ASSERT(fcntl(fd, F_GETFD) == -1, "Owned fd was not closed");
+
+    static char buf[4096];
+    ASSERT(read_file(path, buf, sizeof(buf)) > 0, "Read raw fd file failed");
+    p = strstr(buf, "\"borrowed fd\"");
+    ASSERT(p != NULL && strstr(p, "\"owned fd\"") != NULL, "Raw fd entries missing");
+    remove(path);
+#endif
+#endif
+    return 0;
+}
+
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_SYSLOG_OUTPUT
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// stands in for /dev/log or the journald socket
+static int bind_datagram_socket(const char *path) {
+    unlink(path);
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static long receive_datagram(int fd, char *out, size_t cap) {
+    long n = (long)recv(fd, out, cap - 1, MSG_DONTWAIT);
+    if (n >= 0) out[n] = '\0';
+    return n;
+}
+#endif
+
+static int test_syslog_output() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_SYSLOG_OUTPUT
+    const char *path = "syslog_test.sock";
+    int server = bind_datagram_socket(path);
+    ASSERT(server >= 0, "Failed to bind syslog stand-in socket");
+    ASSERT(pgs_log_add_syslog_output(path, PGS_LOG_SYSLOG_RFC5424, "pgs_test") == PGS_LOG_OK, "Add syslog output failed");
+
+    for (int i = 0; i < 5; ++i) {
+        ASSERT(PGS_LOG_INFO("syslog %d", i) == PGS_LOG_OK, "Syslog write failed");
+    }
+    ASSERT(PGS_LOG_WARN("syslog warn") == PGS_LOG_OK, "Syslog write failed");
+
+    char datagram[4096];
+#if PGS_LOG_SYSLOG_BATCH > 6
+    ASSERT(receive_datagram(server, datagram, sizeof(datagram)) < 0, "Syslog entries sent before flush");
+#endif
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush syslog output failed");
+
+    for (int i = 0; i < 5; ++i) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), " - - syslog %d", i);
+        long n = receive_datagram(server, datagram, sizeof(datagram));
+        ASSERT(n > 0, "Syslog datagram missing");
+        ASSERT(strncmp(datagram, "<14>1 ", 6) == 0, "Wrong RFC 5424 priority/version for info");
+        ASSERT(strstr(datagram, " pgs_test ") != NULL, "Ident missing in syslog frame");
+        ASSERT((size_t)n > strlen(expected) && strcmp(datagram + n - strlen(expected), expected) == 0, "Syslog message wrong or out of order");
+    }
+    ASSERT(receive_datagram(server, datagram, sizeof(datagram)) > 0 && strncmp(datagram, "<12>1 ", 6) == 0, "Wrong priority for warn");
+
+    // the daemon goes away and comes back on the same path
+    close(server);
+    server = bind_datagram_socket(path);
+    ASSERT(server >= 0, "Failed to rebind syslog stand-in socket");
+    ASSERT(PGS_LOG_INFO("after restart") == PGS_LOG_OK, "Syslog write failed");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Syslog output did not reconnect");
+    ASSERT(receive_datagram(server, datagram, sizeof(datagram)) > 0 && strstr(datagram, " - - after restart") != NULL, "Entry after reconnect missing");
+    ASSERT(pgs_log_remove_syslog_output(path) == PGS_LOG_OK, "Remove syslog output failed");
+    ASSERT(pgs_log_remove_syslog_output(path) != PGS_LOG_OK, "Removing twice should error");
+
+    // journald native, multi line messages use the binary field form
+    ASSERT(pgs_log_add_syslog_output(path, PGS_LOG_SYSLOG_JOURNALD, "pgs_test") == PGS_LOG_OK, "Add journald output failed");
+    ASSERT(PGS_LOG_ERROR("journal entry") == PGS_LOG_OK, "Journald write failed");
+    ASSERT(PGS_LOG_INFO("two\nlines") == PGS_LOG_OK, "Journald write failed");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush journald output failed");
+
+    ASSERT(receive_datagram(server, datagram, sizeof(datagram)) > 0, "Journald datagram missing");
+    ASSERT(strncmp(datagram, "PRIORITY=3\n", 11) == 0, "Wrong journald priority");
+    ASSERT(strstr(datagram, "\nSYSLOG_IDENTIFIER=pgs_test\n") != NULL, "Journald identifier missing");
+    ASSERT(strstr(datagram, "\nCODE_FILE=") != NULL && strstr(datagram, "\nMESSAGE=journal entry\n") != NULL, "Journald fields missing");
+
+    long n = receive_datagram(server, datagram, sizeof(datagram));
+    ASSERT(n > 0, "Journald datagram missing");
+    const char binary[] = "\nMESSAGE\n\x09\0\0\0\0\0\0\0two\nlines\n";
+    ASSERT(n >= (long)sizeof(binary) - 1 && memcmp(datagram + n - (sizeof(binary) - 1), binary, sizeof(binary) - 1) == 0, "Journald binary message field wrong");
+    ASSERT(pgs_log_remove_syslog_output(path) == PGS_LOG_OK, "Remove journald output failed");
+
+    // nobody listens anymore, the full batch and the entry that wanted its room are both dropped
+    ASSERT(pgs_log_add_syslog_output(path, PGS_LOG_SYSLOG_RFC5424, "pgs_test") == PGS_LOG_OK, "Add syslog output failed");
+    close(server);
+    unlink(path);
+    for (int i = 0; i < PGS_LOG_SYSLOG_BATCH; ++i)
+        ASSERT(PGS_LOG_INFO("unsent %d", i) == PGS_LOG_OK, "Syslog write failed");
+    ASSERT(PGS_LOG_INFO("one too many") != PGS_LOG_OK, "Failed batch should be reported");
+    ASSERT(pgs_syslog_outputs[0].dropped == PGS_LOG_SYSLOG_BATCH + 1, "Entry after a failed batch not counted as dropped");
+    pgs_log_remove_syslog_output(path);
+#endif
+    return 0;
+}
+
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_NONBLOCKING
+// reads everything the pipe has, checks it is whole entries in logging order, returns how many
+static int drain_pipe(int fd, int *last, char *line, size_t *line_len) {
+    char chunk[4096];
+    int entries = 0;
+    for (;;) {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n <= 0) return entries;
+        for (ssize_t i = 0; i < n; ++i) {
+            if (chunk[i] != '\n') {
+                if (*line_len < 255) line[(*line_len)++] = chunk[i];
+                continue;
+            }
+            line[*line_len] = '\0';
+            *line_len = 0;
+            const char *p = strstr(line, "\"nonblock ");
+            int number;
+            if (!p || sscanf(p, "\"nonblock %d\"", &number) != 1 || number <= *last) return -1;
+            *last = number;
+            entries++;
+        }
+    }
+}
+#endif
+
+static int test_nonblocking_output() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_NONBLOCKING
+    Pgs_Log_Overflow_Policy policies[] = { PGS_LOG_OVERFLOW_DROP_NEWEST, PGS_LOG_OVERFLOW_DROP_OLDEST };
+    for (int k = 0; k < 2; ++k) {
+        int fds[2];
+        ASSERT(pipe(fds) == 0, "Failed to create pipe");
+        ASSERT(fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0, "Failed to make read end non-blocking");
+        ASSERT(pgs_log_add_raw_fd_output(fds[1], true) == PGS_LOG_OK, "Add pipe output failed");
+        ASSERT(pgs_log_set_output_nonblocking(fds[1], policies[k]) == PGS_LOG_OK, "Set non-blocking failed");
+#ifdef __linux__
+        // the pipe got its own description, whoever else shares fds[1] keeps blocking writes
+        ASSERT((fcntl(fds[1], F_GETFL) & O_NONBLOCK) == 0, "Shared description turned non-blocking");
+#endif
+
+        // nobody reads, a blocking write would hang here once the pipe is full
+        const int total = 20000;
+        for (int i = 0; i < total; ++i) {
+            ASSERT(PGS_LOG_INFO("nonblock %d", i) == PGS_LOG_OK, "Non-blocking write failed");
+        }
+        ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush non-blocking output failed");
+
+        Pgs_Log_Output_Stats stats;
+        ASSERT(pgs_log_get_output_stats(fds[1], &stats) == PGS_LOG_OK, "Get output stats failed");
+        ASSERT(stats.stalls > 0 && stats.dropped_entries > 0, "Full pipe did not stall/drop");
+        ASSERT(stats.pending > 0 && stats.pending <= PGS_LOG_NONBLOCK_PENDING_SIZE, "Pending tail not kept within the cap");
+
+        // the reader catches up, the pending tail drains
+        char line[256];
+        size_t line_len = 0;
+        int last = -1;
+        int received = 0;
+        for (int round = 0; round < 1000; ++round) {
+            int n = drain_pipe(fds[0], &last, line, &line_len);
+            ASSERT(n >= 0, "Pipe got partial or reordered entries");
+            received += n;
+            ASSERT(pgs_log_get_output_stats(fds[1], &stats) == PGS_LOG_OK, "Get output stats failed");
+            if (stats.pending == 0 && n == 0) break;
+            ASSERT(pgs_log_poll_outputs(10) == PGS_LOG_OK, "Poll outputs failed");
+        }
+        ASSERT(stats.pending == 0 && line_len == 0, "Pending tail never drained");
+        ASSERT((uint64_t)received + stats.dropped_entries == (uint64_t)total, "Entries lost without being counted");
+        if (policies[k] == PGS_LOG_OVERFLOW_DROP_OLDEST)
+            ASSERT(last == total - 1, "Drop oldest lost the newest entry");
+        else
+            ASSERT(last < total - 1, "Drop newest kept the newest entry");
+
+        ASSERT(pgs_log_set_output_blocking(fds[1]) == PGS_LOG_OK, "Set blocking failed");
+        ASSERT((fcntl(fds[1], F_GETFL) & O_NONBLOCK) == 0, "Fd flags not restored");
+        ASSERT(pgs_log_remove_raw_fd_output(fds[1]) == PGS_LOG_OK, "Remove pipe output failed");
+        close(fds[0]);
+    }
+#endif
+    return 0;
+}
+
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_VMSPLICE
+typedef struct {
+    int fd;
+    int entries;                    // -1 once an entry came out of order
+} Pipe_Reader;
+
+static void *pipe_reader_thread(void *arg) {
+    Pipe_Reader *r = arg;
+    static char chunk[64 * 1024];
+    char line[256];
+    size_t line_len = 0;
+    for (;;) {
+        ssize_t n = read(r->fd, chunk, sizeof(chunk));
+        if (n <= 0) return NULL;
+        if (r->entries < 0) continue;
+        for (ssize_t i = 0; i < n; ++i) {
+            if (chunk[i] != '\n') {
+                if (line_len < 255) line[line_len++] = chunk[i];
+                continue;
+            }
+            line[line_len] = '\0';
+            line_len = 0;
+            const char *p = strstr(line, "\"pipe ");
+            int number;
+            if (!p) continue;
+            if (sscanf(p, "\"pipe %d\"", &number) != 1 || number != r->entries) {
+                r->entries = -1;
+                break;
+            }
+            r->entries++;
+        }
+    }
+}
+#endif
+
+static int test_pipe_output() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_VMSPLICE
+    int fds[2];
+    ASSERT(pipe(fds) == 0, "Failed to create pipe");
+    ASSERT(pgs_log_add_pipe_output(-1, false) != PGS_LOG_OK, "Adding a bad fd should error");
+    Pipe_Reader reader = { .fd = fds[0] };
+    pthread_t thread;
+    ASSERT(pthread_create(&thread, NULL, pipe_reader_thread, &reader) == 0, "Failed to start pipe reader");
+    ASSERT(pgs_log_add_pipe_output(fds[1], true) == PGS_LOG_OK, "Add pipe output failed");
+
+    // enough to fill the buffer a few times, every full one gets gifted
+    const int total = 3 * PGS_LOG_VMSPLICE_BUFFER_SIZE / 64;
+    for (int i = 0; i < total; ++i) {
+        ASSERT(PGS_LOG_INFO("pipe %d", i) == PGS_LOG_OK, "Pipe write failed");
+    }
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush pipe output failed");
+
+    // remove closes the owned write end, the reader sees EOF
+    ASSERT(pgs_log_remove_pipe_output(fds[1]) == PGS_LOG_OK, "Remove pipe output failed");
+    ASSERT(pgs_log_remove_pipe_output(fds[1]) != PGS_LOG_OK, "Removing twice should error");
+    pthread_join(thread, NULL);
+    close(fds[0]);
+    ASSERT(reader.entries == total, "Pipe got lost or reordered entries");
+#endif
+    return 0;
+}
+
+#if PGS_LOG_ENABLED && PGS_LOG_TERMINAL_COALESCE && !defined(_WIN32)
+// how many "coalesce" entries the pipe behind stdout got so far
+static int read_coalesced(int fd) {
+    static int count = 0;
+    char chunk[4096];
+    ssize_t n;
+#if PGS_LOG_ENABLE_EVENT_LOOP
+    pgs_log_service(0);
+#endif
+    while ((n = read(fd, chunk, sizeof(chunk) - 1)) > 0) {
+        chunk[n] = '\0';
+        for (const char *p = chunk; (p = strstr(p, "coalesce ")) != NULL; p++) count++;
+    }
+    return count;
+}
+#endif
+
+static int test_terminal_coalescing() {
+#if PGS_LOG_ENABLED && PGS_LOG_TERMINAL_COALESCE && !defined(_WIN32)
+    int fds[2];
+    ASSERT(pipe(fds) == 0, "Failed to create pipe");
+    ASSERT(fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0, "Failed to make read end non-blocking");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush before redirect failed");
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    ASSERT(saved >= 0 && dup2(fds[1], STDOUT_FILENO) == STDOUT_FILENO, "Failed to redirect stdout");
+
+    // the stdout output (added by an earlier test) writes to fd 1, nothing may be asserted until it is restored
+    struct timespec quiet = { .tv_sec = 0, .tv_nsec = (PGS_LOG_TERMINAL_COALESCE_US + 50000) * 1000L };
+    nanosleep(&quiet, NULL);
+    PGS_LOG_INFO("coalesce after quiet");
+    int after_quiet = read_coalesced(fds[0]);
+    PGS_LOG_INFO("coalesce burst");
+    int in_burst = read_coalesced(fds[0]);
+    PGS_LOG_ERROR("coalesce error");
+    int after_error = read_coalesced(fds[0]);
+    for (int i = 0; i < PGS_LOG_TERMINAL_COALESCE_ENTRIES - 1; ++i)
+        PGS_LOG_INFO("coalesce filling");
+    int before_full = read_coalesced(fds[0]);
+    PGS_LOG_INFO("coalesce full");
+    int full = read_coalesced(fds[0]);
+    PGS_LOG_INFO("coalesce tail");
+    int tail = read_coalesced(fds[0]);
+    // no further log call, the timer still keeps the budget
+    nanosleep(&quiet, NULL);
+    int after_due = read_coalesced(fds[0]);
+    Pgs_Log_Error due_err = pgs_log_flush_if_due();
+
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    close(fds[1]);
+    close(fds[0]);
+
+    ASSERT(after_quiet == 1, "Entry after a quiet period was not written right away");
+    ASSERT(in_burst == 1, "Entry in a burst was not coalesced");
+    ASSERT(after_error == 3, "Error entry was not written right away");
+    ASSERT(before_full == 3, "Entries below the count limit were not coalesced");
+    ASSERT(full == 3 + PGS_LOG_TERMINAL_COALESCE_ENTRIES, "Reaching the entry limit did not write");
+    ASSERT(tail == full, "Tail entry was not coalesced");
+    ASSERT(after_due == full + 1, "Tail was not written once its budget ran out");
+    ASSERT(due_err == PGS_LOG_OK, "Flush if due failed");
+#endif
+    return 0;
+}
+
+static int test_output_formats() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_OUTPUT_FORMATS
+    const char *short_path = "format_short_test.log";
+    const char *full_path = "format_full_test.log";
+    FILE *short_file = fopen(short_path, "w+");
+    FILE *full_file = fopen(full_path, "w+");
+    ASSERT(short_file && full_file, "Failed to open output format test files");
+    ASSERT(pgs_log_add_fd_output(short_file) == PGS_LOG_OK, "Add short output failed");
+    ASSERT(pgs_log_add_fd_output(full_file) == PGS_LOG_OK, "Add full output failed");
+
+    ASSERT(pgs_log_set_output_level(fileno(short_file), PGS_LOG_WARN) == PGS_LOG_OK, "Set output level failed");
+    ASSERT(pgs_log_set_output_format(fileno(short_file), "%C%L%R %M") == PGS_LOG_OK, "Set output format failed");
+    ASSERT(pgs_log_set_output_format(-1, "%M") != PGS_LOG_OK, "Setting the format of an unknown fd should error");
+
+    ASSERT(PGS_LOG_INFO("format info") == PGS_LOG_OK, "Info failed");
+    ASSERT(PGS_LOG_WARN("format warn") == PGS_LOG_OK, "Warn failed");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+
+    char buf[4096];
+    read_file(short_path, buf, sizeof(buf));
+    ASSERT(strcmp(buf, "\x1b[33mWARN\x1b[0m format warn\n") == 0, "Short output got the wrong entries or format");
+    read_file(full_path, buf, sizeof(buf));
+    ASSERT(strstr(buf, "[INFO]") && strstr(buf, "\"format info\""), "Full output missed the info entry");
+    ASSERT(strstr(buf, "[WARN]") && strstr(buf, "\"format warn\""), "Full output missed the warn entry");
+
+    // NULL goes back to the default format
+    ASSERT(pgs_log_set_output_format(fileno(short_file), NULL) == PGS_LOG_OK, "Reset output format failed");
+    ASSERT(PGS_LOG_ERROR("format error") == PGS_LOG_OK, "Error failed");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+    read_file(short_path, buf, sizeof(buf));
+    ASSERT(strstr(buf, "[ERROR]") && strstr(buf, "\"format error\""), "Default format not restored");
+
+    ASSERT(pgs_log_remove_fd_output(short_file) == PGS_LOG_OK, "Remove short output failed");
+    ASSERT(pgs_log_remove_fd_output(full_file) == PGS_LOG_OK, "Remove full output failed");
+    remove(short_path);
+    remove(full_path);
+#endif
+    return 0;
+}
+
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_EVENT_LOOP
+#include <poll.h>
+#include <sys/stat.h>
+
+static bool event_fd_readable(void) {
+    struct pollfd p = { .fd = pgs_log_event_fd(), .events = POLLIN };
+    return poll(&p, 1, 0) == 1 && (p.revents & POLLIN);
+}
+
+static long fd_size(int fd) {
+    struct stat st;
+    return fstat(fd, &st) == 0 ? (long)st.st_size : -1;
+}
+#endif
+
+static int test_event_loop() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_EVENT_LOOP
+    ASSERT(pgs_log_event_fd() >= 0, "No event fd");
+    ASSERT(pgs_log_service(0) == PGS_LOG_OK, "Service failed");
+    ASSERT(!event_fd_readable() && !pgs_log_service_pending(), "Event fd readable without work");
+
+    const char *path = "event_loop_test.log";
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT(fd >= 0, "Failed to open event loop test file");
+    ASSERT(pgs_log_add_raw_fd_output(fd, false) == PGS_LOG_OK, "Add event loop output failed");
+
+    // more than a buffer, the full one is queued instead of written
+    for (int i = 0; i < PGS_LOG_MAX_OUTPUT_BUFFER_SIZE && !pgs_log_service_pending(); ++i)
+        ASSERT(PGS_LOG_INFO("loop %d", i) == PGS_LOG_OK, "Info failed");
+    ASSERT(fd_size(fd) == 0, "Log call wrote to the fd");
+    ASSERT(event_fd_readable() && pgs_log_service_pending(), "Full buffer did not signal the loop");
+
+    // bounded, the eventfd stays readable while work is left
+    const size_t budget = 100;
+    ASSERT(pgs_log_service(budget) == PGS_LOG_OK, "Service failed");
+    // the budget is shared with the other outputs, this one may not even have had its turn
+    ASSERT(fd_size(fd) <= (long)budget, "Service did not stay within its budget");
+    ASSERT(event_fd_readable() == pgs_log_service_pending(), "Event fd not readable with work left");
+    for (int round = 0; round < 10000 && pgs_log_service_pending(); ++round)
+        ASSERT(pgs_log_service(budget) == PGS_LOG_OK, "Service failed");
+    ASSERT(!pgs_log_service_pending() && !event_fd_readable(), "Service never finished");
+    long queued_size = fd_size(fd);
+
+    // entries at the flush level only wake the loop, the loop writes them
+    Pgs_Log_Level flush_level = pgs_log_flush_level;
+    pgs_log_flush_level = PGS_LOG_ERROR;
+    ASSERT(PGS_LOG_ERROR("loop error") == PGS_LOG_OK, "Error failed");
+    ASSERT(fd_size(fd) == queued_size, "Flush level entry was written by the log call");
+    ASSERT(event_fd_readable() && pgs_log_service_pending(), "Flush level entry did not signal the loop");
+    ASSERT(pgs_log_service(0) == PGS_LOG_OK, "Service failed");
+    ASSERT(!pgs_log_service_pending(), "Unbounded service left work");
+    pgs_log_flush_level = flush_level;
+
+    // the loop may never run again after a FATAL entry, it is written by the log call
+    queued_size = fd_size(fd);
+    ASSERT(PGS_LOG_FATAL("loop fatal") == PGS_LOG_OK, "Fatal failed");
+    ASSERT(fd_size(fd) > queued_size, "Fatal entry was left to the loop");
+
+    char buf[PGS_LOG_MAX_OUTPUT_BUFFER_SIZE * 2 + 4096];
+    read_file(path, buf, sizeof(buf));
+    ASSERT(strstr(buf, "\"loop 0\"") && strstr(buf, "\"loop error\"") && strstr(buf, "\"loop fatal\""), "Serviced file misses entries");
+
+    ASSERT(pgs_log_remove_raw_fd_output(fd) == PGS_LOG_OK, "Remove event loop output failed");
+    close(fd);
+    remove(path);
+
+    // terminal entries are queued for the loop, the fd is non-blocking while it is an output
+    int fds[2];
+    ASSERT(pipe(fds) == 0, "Pipe failed");
+    int saved_stderr = dup(STDERR_FILENO);
+    ASSERT(saved_stderr >= 0 && dup2(fds[1], STDERR_FILENO) == STDERR_FILENO, "Redirect stderr failed");
+    close(fds[1]);
+    ASSERT(pgs_log_add_fd_output(stderr) == PGS_LOG_OK, "Add stderr output failed");
+    ASSERT(fcntl(STDERR_FILENO, F_GETFL) & O_NONBLOCK, "Output fd is not non-blocking");
+
+    ASSERT(PGS_LOG_INFO("loop terminal") == PGS_LOG_OK, "Info failed");
+    struct pollfd p = { .fd = fds[0], .events = POLLIN };
+    ASSERT(poll(&p, 1, 0) == 0, "Log call wrote to the terminal");
+    ASSERT(event_fd_readable() && pgs_log_service_pending(), "Terminal entry did not signal the loop");
+    ASSERT(pgs_log_service(0) == PGS_LOG_OK, "Service failed");
+    ssize_t n = read(fds[0], buf, sizeof(buf) - 1);
+    ASSERT(n > 0, "Service did not write the terminal entry");
+    buf[n] = '\0';
+    ASSERT(strstr(buf, "\"loop terminal\"") != NULL, "Terminal entry missing");
+
+    ASSERT(pgs_log_remove_fd_output(stderr) == PGS_LOG_OK, "Remove stderr output failed");
+    ASSERT(!(fcntl(STDERR_FILENO, F_GETFL) & O_NONBLOCK), "Output fd flags not restored");
+    dup2(saved_stderr, STDERR_FILENO);
+    close(saved_stderr);
+    close(fds[0]);
+#endif
+    return 0;
+}
+
+static int test_compressed_output() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_COMPRESSION
+    // codec round trip on overlapping matches, long literal runs and incompressible bytes
+    static unsigned char raw[8192], packed[PGS_LOG_COMPRESS_BOUND(8192)], back[8192];
+    unsigned int seed = 1;
+    for (size_t i = 0; i < sizeof(raw); ++i) {
+        seed = seed * 1103515245u + 12345u;
+        raw[i] = i < 3000 ? (unsigned char)("aaaab"[i % 5]) : (unsigned char)(seed >> 16);
+    }
+    size_t packed_len = pgs_log_lz_compress(raw, sizeof(raw), packed);
+    ASSERT(pgs_log_lz_decompress(packed, packed_len, back, sizeof(back)) == (long)sizeof(raw), "LZ round trip length");
+    ASSERT(memcmp(raw, back, sizeof(raw)) == 0, "LZ round trip data");
+    ASSERT(pgs_log_lz_decompress(packed, packed_len / 2, back, sizeof(back)) != (long)sizeof(raw), "Cut LZ frame decoded whole");
+
+    const char *path = "logs/compressed_test.log.pgz";
+    const char *dump = "compressed_dump.log";
+    ASSERT(pgs_log_add_compressed_output(path, false) == PGS_LOG_OK, "Add compressed output failed");
+    ASSERT(pgs_log_add_compressed_output(path, false) != PGS_LOG_OK, "Adding twice should error");
+
+    const int total = 4000;
+    for (int i = 0; i < total; ++i) {
+        ASSERT(PGS_LOG_INFO("compress %d", i) == PGS_LOG_OK, "Compressed write failed");
+        if (i == total / 2) ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+    }
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+
+    // readable up to the last flush while still open
+    static char buf[1024 * 1024];
+    ASSERT(pgs_log_compressed_dump(path, 0, dump) == PGS_LOG_OK, "Dump compressed file failed");
+    long raw_len = read_file(dump, buf, sizeof(buf));
+    const char *p = buf;
+    for (int i = 0; i < total; i += 97) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "\"compress %d\"", i);
+        p = strstr(p, expected);
+        ASSERT(p != NULL, "Compressed entry missing or out of order");
+    }
+    struct stat st;
+    ASSERT(stat(path, &st) == 0 && st.st_size * 3 < raw_len, "Log lines did not compress");
+
+    // seeking through the index gives exactly the tail
+    ASSERT(pgs_log_compressed_dump(path, (uint64_t)raw_len - 100, dump) == PGS_LOG_OK, "Dump from offset failed");
+    static char tail[256];
+    ASSERT(read_file(dump, tail, sizeof(tail)) == 100 && memcmp(tail, buf + raw_len - 100, 100) == 0, "Seek dump wrong");
+    ASSERT(pgs_log_remove_compressed_output(path) == PGS_LOG_OK, "Remove compressed output failed");
+
+    // a torn frame at the end gets cut when appending
+    FILE *f = fopen(path, "ab");
+    ASSERT(f && fwrite(PGS_LOG_COMPRESS_MAGIC "\x01\0\0\0\xff\0\0\0\xff\0\0\0abc", 1, 19, f) == 19, "Failed to tear file");
+    fclose(f);
+    ASSERT(pgs_log_add_compressed_output(path, true) == PGS_LOG_OK, "Append compressed output failed");
+    ASSERT(PGS_LOG_INFO("compress appended") == PGS_LOG_OK, "Compressed write failed");
+    ASSERT(pgs_log_remove_compressed_output(path) == PGS_LOG_OK, "Remove compressed output failed");
+    ASSERT(pgs_log_compressed_dump(path, 0, dump) == PGS_LOG_OK, "Dump appended file failed");
+    ASSERT(read_file(dump, buf, sizeof(buf)) > raw_len && strstr(buf, "\"compress appended\""), "Append lost entries");
+
+    remove(path);
+    remove(dump);
+#endif
+    return 0;
+}
+
+static int test_dynamic_buffers() {
+#if PGS_LOG_ENABLED && PGS_LOG_ENABLE_DYNAMIC_BUFFERS && PGS_LOG_ENABLE_BUFFERING
+    pgs_log_cleanup();
+    ASSERT(pgs_log_allocated_bytes() == 0, "Cleanup kept memory");
+
+    static char arena[256 * 1024];
+    ASSERT(pgs_log_use_arena(arena, sizeof(arena)) == PGS_LOG_OK, "Use arena failed");
+    ASSERT(pgs_log_set_max_outputs(PGS_LOG_MAX_FD + 1) != PGS_LOG_OK, "Output count above PGS_LOG_MAX_FD accepted");
+    ASSERT(pgs_log_set_max_outputs(4) == PGS_LOG_OK, "Set max outputs failed");
+    ASSERT(pgs_log_set_buffer_size(16) != PGS_LOG_OK, "Buffer smaller than an entry accepted");
+    ASSERT(pgs_log_set_buffer_size(4096) == PGS_LOG_OK, "Set buffer size failed");
+
+    // only the table of outputs until an entry comes in
+    const char *path = "dynamic_test.log";
+    FILE *f = fopen(path, "w+");
+    ASSERT(f != NULL, "Failed to open dynamic test file");
+    ASSERT(pgs_log_add_fd_output(f) == PGS_LOG_OK, "Add dynamic file output failed");
+    size_t table = pgs_log_allocated_bytes();
+    ASSERT(table == 4 * sizeof(Pgs_Log_Output), "Outputs table not sized at runtime");
+    ASSERT(pgs_log_set_allocator(NULL) != PGS_LOG_OK, "Allocator changed under live outputs");
+    ASSERT(pgs_log_set_output_buffer_size(fileno(f), 64 * 1024) == PGS_LOG_OK, "Set output buffer size failed");
+
+    const int total = 3000;
+    for (int i = 0; i < total / 2; ++i) {
+        ASSERT(PGS_LOG_INFO("dynamic %d", i) == PGS_LOG_OK, "Dynamic write failed");
+    }
+    ASSERT(pgs_log_allocated_bytes() >= table + 64 * 1024, "Buffers not allocated on first use");
+    ASSERT(pgs_log_allocated_bytes() <= sizeof(arena), "Allocated past the arena");
+
+    // the arena can not fit 1 MiB, entries go out unbuffered in order
+    ASSERT(pgs_log_set_output_buffer_size(fileno(f), 1024 * 1024) == PGS_LOG_OK, "Set output buffer size failed");
+    for (int i = total / 2; i < total; ++i) {
+        ASSERT(PGS_LOG_INFO("dynamic %d", i) == PGS_LOG_OK, "Unbuffered dynamic write failed");
+    }
+
+    // the table stays at the count it was allocated with
+    static Pgs_Log_Memory_Sink memories[PGS_LOG_MAX_FD];
+    static char memory_buf[PGS_LOG_MAX_FD][256];
+    int added = 0;
+    while (added < PGS_LOG_MAX_FD) {
+        pgs_log_memory_sink_init(&memories[added], memory_buf[added], sizeof(memory_buf[added]));
+        if (pgs_log_add_memory_output(&memories[added]) != PGS_LOG_OK) break;
+        added++;
+    }
+    ASSERT(added < 4, "Added more outputs than set");
+    for (int i = 0; i < added; ++i)
+        ASSERT(pgs_log_remove_sink_output(&memories[i]) == PGS_LOG_OK, "Remove memory output failed");
+
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+    static char buf[256 * 1024];
+    ASSERT(read_file(path, buf, sizeof(buf)) > 0, "Dynamic test file empty");
+    const char *p = buf;
+    for (int i = 0; i < total; ++i) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "\"dynamic %d\"", i);
+        p = strstr(p, expected);
+        ASSERT(p != NULL, "Dynamic entry missing or out of order");
+    }
+    ASSERT(pgs_log_remove_fd_output(f) == PGS_LOG_OK, "Remove dynamic file output failed");
+    remove(path);
+
+    pgs_log_cleanup();
+    ASSERT(pgs_log_allocated_bytes() == 0, "Cleanup kept memory");
+    ASSERT(pgs_log_set_allocator(NULL) == PGS_LOG_OK, "Back to malloc failed");
+    ASSERT(pgs_log_set_max_outputs(PGS_LOG_MAX_FD) == PGS_LOG_OK, "Reset max outputs failed");
+    ASSERT(pgs_log_set_buffer_size(PGS_LOG_MAX_OUTPUT_BUFFER_SIZE) == PGS_LOG_OK, "Reset buffer size failed");
+#endif
+    return 0;
+}
+
+#if PGS_LOG_ENABLE_LARGE_ENTRIES && PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+static size_t largest_alloc = 0;
+
+static void *track_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    if (size > largest_alloc) largest_alloc = size;
+    return malloc(size);
+}
+
+static void track_free(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    (void)size;
+    free(ptr);
+}
+#endif
+
+static int test_large_entries() {
+#if PGS_LOG_ENABLED
+#if PGS_LOG_FILE_SEGMENTS
+    // the log file segments of the test config are smaller than an entry
+    return 0;
+#endif
+#if PGS_LOG_ENABLE_LARGE_ENTRIES && PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+    // the whole entry goes through the allocator hooks
+    pgs_log_cleanup();
+    ASSERT(pgs_log_set_allocator(&(Pgs_Log_Allocator){ track_alloc, track_free, NULL }) == PGS_LOG_OK, "Set allocator failed");
+#endif
+    const char *path = "large_test.log";
+    FILE *f = fopen(path, "w+");
+    ASSERT(f != NULL, "Failed to open large test file");
+    ASSERT(pgs_log_add_fd_output(f) == PGS_LOG_OK, "Add large file output failed");
+
+    // larger than an entry and than the output buffer
+    static char big[PGS_LOG_MAX_OUTPUT_BUFFER_SIZE + 4096];
+    memset(big, 'x', sizeof(big) - 1);
+    memcpy(big, "large-begin", 11);
+    memcpy(big + sizeof(big) - 10, "large-end", 9);
+    big[sizeof(big) - 1] = '\0';
+
+    uint64_t truncated = pgs_log_truncated_count();
+    ASSERT(PGS_LOG_INFO("large before") == PGS_LOG_OK, "Write before large entry failed");
+#if PGS_LOG_ENABLE_LARGE_ENTRIES && PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+    size_t held = pgs_log_allocated_bytes();
+#endif
+    ASSERT(PGS_LOG_INFO("%s", big) == PGS_LOG_OK, "Large write failed");
+#if PGS_LOG_ENABLE_LARGE_ENTRIES && PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+    ASSERT(largest_alloc > sizeof(big), "Large entry not allocated through the allocator hooks");
+    ASSERT(pgs_log_allocated_bytes() == held, "Large entry not given back to the allocator");
+#endif
+    ASSERT(PGS_LOG_INFO("large after") == PGS_LOG_OK, "Write after large entry failed");
+    ASSERT(pgs_log_flush() == PGS_LOG_OK, "Flush failed");
+
+    static char buf[2 * sizeof(big)];
+    ASSERT(read_file(path, buf, sizeof(buf)) > 0, "Large test file empty");
+    const char *before = strstr(buf, "\"large before\"");
+    const char *begin = strstr(buf, "\"large-begin");
+    const char *after = strstr(buf, "\"large after\"");
+    ASSERT(before && begin && after && before < begin && begin < after, "Large entry missing or out of order");
+#if PGS_LOG_ENABLE_LARGE_ENTRIES
+    const char *end = strstr(begin, "large-end\"\n");
+    ASSERT(end && end < after && (size_t)(end - begin) == sizeof(big) - 9, "Large entry not written whole");
+    ASSERT(pgs_log_truncated_count() == truncated, "Whole entry counted as truncated");
+#else
+    ASSERT(strstr(buf, "large-end") == NULL, "Entry not cut at PGS_LOG_MAX_ENTRY_LEN");
+    ASSERT(strchr(begin, '\n') - begin < PGS_LOG_MAX_ENTRY_LEN, "Cut entry longer than PGS_LOG_MAX_ENTRY_LEN");
+    ASSERT(pgs_log_truncated_count() == truncated + 1, "Cut entry not counted");
+#endif
+    ASSERT(pgs_log_remove_fd_output(f) == PGS_LOG_OK, "Remove large file output failed");
+    remove(path);
+#if PGS_LOG_ENABLE_LARGE_ENTRIES && PGS_LOG_ENABLE_DYNAMIC_BUFFERS
+    pgs_log_cleanup();
+    ASSERT(pgs_log_set_allocator(NULL) == PGS_LOG_OK, "Back to malloc failed");
+#endif
+#endif
+    return 0;
+}
+
+static int test_interrupt() {
+#if PGS_LOG_ENABLED && !defined(_WIN32)
+    // SIGINT flushes what is buffered and exits with 130 right away, even if the program never logs again
+    int fds[2], idle[2];
+    ASSERT(pipe(fds) == 0 && pipe(idle) == 0, "Pipe failed");
+    pid_t pid = fork();
+    ASSERT(pid >= 0, "Fork failed");
+    if (pid == 0) {
+        close(fds[0]);
+        if (pgs_log_add_raw_fd_output(fds[1], true) != PGS_LOG_OK) _exit(1);
+        // with the flush thread the flush starts it, the interrupt then goes through its helper
+        PGS_LOG_INFO("started");
+        if (pgs_log_flush() != PGS_LOG_OK) _exit(1);
+        PGS_LOG_INFO("before interrupt");
+        alarm(10);
+        raise(SIGINT);
+        char c;
+        while (read(idle[0], &c, 1) != 0) {}
+        _exit(0);
+    }
+    close(fds[1]);
+    close(idle[0]);
+
+    char buf[4096];
+    size_t n = 0;
+    ssize_t r;
+    while (n < sizeof(buf) - 1 && (r = read(fds[0], buf + n, sizeof(buf) - 1 - n)) > 0)
+        n += (size_t)r;
+    buf[n] = '\0';
+    close(fds[0]);
+
+    int status;
+    ASSERT(waitpid(pid, &status, 0) == pid, "Wait for interrupted child failed");
+    close(idle[1]);
+    ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 130, "Interrupted child should exit with 130");
+    ASSERT(strstr(buf, "before interrupt") != NULL, "Buffered entry lost on interrupt");
 #endif
     return 0;
 }
@@ -213,12 +1827,40 @@ static int test_error_detail() {
 }
 
 int main() {
+    // forks a child that initializes and cleans up on its own, has to run before this process has outputs
+    if (test_interrupt()) return 1;
     if (test_level_filtering()) return 1;
     if (test_toggle_disable()) return 1;
     if (test_level_strings()) return 1;
     if (test_temp_sprintf_ring()) return 1;
     if (test_add_remove_stdout_duplicate_protection()) return 1;
     if (test_buffering_behavior()) return 1;
+    if (test_backlog()) return 1;
+    // forks fresh recorders, has to run before test_flight_recorder() initializes the one of this process
+    if (test_flight_recorder_mmap()) return 1;
+    if (test_flight_recorder()) return 1;
+    if (test_usdt_probes()) return 1;
+    if (test_module_levels()) return 1;
+    if (test_ratelimit_and_sampling()) return 1;
+    if (test_many_buffers_in_order()) return 1;
+    if (test_mmap_output()) return 1;
+    if (test_direct_output()) return 1;
+    if (test_flush_policy()) return 1;
+    if (test_durability()) return 1;
+    if (test_rotation()) return 1;
+    if (test_date_rollover()) return 1;
+    if (test_reopen()) return 1;
+    if (test_segments()) return 1;
+    if (test_sinks()) return 1;
+    if (test_syslog_output()) return 1;
+    if (test_nonblocking_output()) return 1;
+    if (test_pipe_output()) return 1;
+    if (test_terminal_coalescing()) return 1;
+    if (test_output_formats()) return 1;
+    if (test_event_loop()) return 1;
+    if (test_compressed_output()) return 1;
+    if (test_dynamic_buffers()) return 1;
+    if (test_large_entries()) return 1;
     if (test_error_detail()) return 1;
 #if PGS_LOG_ENABLE_FILE
     if (test_file_creation_and_flush()) return 1;